@@ -0,0 +1,185 @@
+#!/bin/sh
+#
+# bench.sh -- time MKMSGF/MKMSGD on generated message catalogs
+#
+#   bench.sh mkmsgf mkmsgd msggen [baseline]
+#
+# For each catalog size the best of BENCH_RUNS runs is taken for:
+#
+#   compile     mkmsgf source.txt -> .msg
+#   decompile   mkmsgd .msg -> source
+#   asm         mkmsgf -a with BASEMID.INC/UTILMD1.INC
+#   roundtrip   decompile + compile again, output must be identical
+#   verify      mkmsgf -T, the same round trip in memory
+#
+# and reported as messages/s and MB/s (of the source for compile, asm,
+# verify and roundtrip, of the MSG file for decompile). Results are compared to
+# the baseline file: any case more than BENCH_TOLERANCE percent slower
+# in messages/s fails the run. BENCH_UPDATE=1 rewrites the baseline
+# from this run instead. Baselines are machine specific.
+#
+# Environment:
+#   BENCH_SIZES      catalog sizes (default "2000 5000 9999", message IDs
+#                    have 4 digits so larger catalogs do not round trip,
+#                    MKMSGF compiles 16376 messages at most)
+#   BENCH_RUNS       runs per case (default 10)
+#   BENCH_TOLERANCE  allowed slowdown in percent (default 25)
+#   BENCH_UPDATE     1 = write the baseline
+#   BENCH_DIR        work directory (default: temporary, removed)
+
+if [ $# -lt 3 ]; then
+    echo "Usage: bench.sh mkmsgf mkmsgd msggen [baseline]" >&2
+    exit 1
+fi
+
+# tools run from inside the work directory
+abspath() {
+    case "$1" in
+    /*) echo "$1" ;;
+    *) echo "$(pwd)/$1" ;;
+    esac
+}
+
+MKMSGF=$(abspath "$1")
+MKMSGD=$(abspath "$2")
+MSGGEN=$(abspath "$3")
+BASELINE=${4:+$(abspath "$4")}
+
+SIZES=${BENCH_SIZES:-"2000 5000 9999"}
+RUNS=${BENCH_RUNS:-10}
+TOLERANCE=${BENCH_TOLERANCE:-25}
+
+if [ -n "$BENCH_DIR" ]; then
+    WORK=$BENCH_DIR
+    mkdir -p "$WORK" || exit 1
+else
+    WORK=$(mktemp -d "${TMPDIR:-/tmp}/mkmsgbench.XXXXXX") || exit 1
+    trap 'rm -rf "$WORK"' EXIT
+fi
+
+RESULTS="$WORK/results.txt"
+: > "$RESULTS"
+
+# nanosecond clock, GNU date or anything else with %N
+now() {
+    date +%s%N
+}
+
+# best() <command...> - run the command BENCH_RUNS times, print the
+# fastest wall time in nanoseconds, fail if the command fails
+best() {
+    fastest=
+    run=0
+    while [ $run -lt "$RUNS" ]; do
+        start=$(now)
+        "$@" > /dev/null 2>&1 || return 1
+        end=$(now)
+        elapsed=$((end - start))
+        if [ -z "$fastest" ] || [ $elapsed -lt $fastest ]; then
+            fastest=$elapsed
+        fi
+        run=$((run + 1))
+    done
+    echo $fastest
+}
+
+# report <case> <messages> <bytes> <ns>
+report() {
+    awk -v name="$1" -v msgs="$2" -v bytes="$3" -v ns="$4" 'BEGIN {
+        if (ns < 1) ns = 1
+        s = ns / 1e9
+        printf "%-18s %9.3f ms %12.0f msgs/s %9.2f MB/s\n",
+               name, s * 1000, msgs / s, bytes / s / 1048576
+    }'
+    awk -v name="$1" -v msgs="$2" -v ns="$4" 'BEGIN {
+        if (ns < 1) ns = 1
+        printf "%s %.0f\n", name, msgs / (ns / 1e9)
+    }' >> "$RESULTS"
+}
+
+roundtrip() {
+    "$MKMSGD" ../gen.msg gen.txt && "$MKMSGF" gen.txt gen.msg && cmp -s gen.msg ../gen.msg
+}
+
+fail=0
+
+for size in $SIZES; do
+    dir="$WORK/n$size"
+    mkdir -p "$dir/rt" || exit 1
+    cd "$dir" || exit 1
+
+    if ! "$MSGGEN" -n "$size" gen.txt; then
+        echo "msggen failed for $size messages" >&2
+        exit 1
+    fi
+    "$MKMSGF" gen.txt gen.msg > /dev/null 2>&1
+
+    srcbytes=$(wc -c < gen.txt)
+    msgbytes=$(wc -c < gen.msg)
+
+    echo "== $size messages, source $srcbytes bytes, MSG $msgbytes bytes"
+
+    if ns=$(best "$MKMSGF" gen.txt gen.msg); then
+        report "compile.$size" "$size" "$srcbytes" "$ns"
+    else
+        echo "compile.$size FAILED"; fail=1
+    fi
+
+    if ns=$(best "$MKMSGD" gen.msg dec.txt); then
+        report "decompile.$size" "$size" "$msgbytes" "$ns"
+    else
+        echo "decompile.$size FAILED"; fail=1
+    fi
+
+    if ns=$(best "$MKMSGF" -a -I . gen.txt gen.asm); then
+        report "asm.$size" "$size" "$srcbytes" "$ns"
+    else
+        echo "asm.$size FAILED"; fail=1
+    fi
+
+    if ns=$(best "$MKMSGF" -T gen.txt); then
+        report "verify.$size" "$size" "$srcbytes" "$ns"
+    else
+        echo "verify.$size FAILED (message does not round trip)"; fail=1
+    fi
+
+    cd rt || exit 1
+    if ns=$(best roundtrip); then
+        report "roundtrip.$size" "$size" "$srcbytes" "$ns"
+    else
+        echo "roundtrip.$size FAILED (output differs)"; fail=1
+    fi
+done
+
+if [ -z "$BASELINE" ]; then
+    exit $fail
+fi
+
+if [ "$BENCH_UPDATE" = "1" ]; then
+    {
+        echo "# mkmsgf benchmark baseline: <case> <messages/s>"
+        echo "# machine specific, regenerate with BENCH_UPDATE=1"
+        cat "$RESULTS"
+    } > "$BASELINE"
+    echo "baseline written to $BASELINE"
+    exit $fail
+fi
+
+if [ ! -f "$BASELINE" ]; then
+    echo "no baseline $BASELINE, run with BENCH_UPDATE=1 to create it"
+    exit $fail
+fi
+
+echo "== against baseline, tolerance $TOLERANCE%"
+awk -v tol="$TOLERANCE" '
+    NR == FNR { if ($1 !~ /^#/) base[$1] = $2; next }
+    !($1 in base) { printf "%-18s %12s\n", $1, "new"; next }
+    {
+        change = ($2 - base[$1]) * 100 / base[$1]
+        flag = (change < -tol) ? "REGRESSION" : ""
+        if (flag != "") bad = 1
+        printf "%-18s %+8.1f%% %s\n", $1, change, flag
+    }
+    END { exit bad }' "$BASELINE" "$RESULTS" || fail=1
+
+exit $fail
@@ -0,0 +1,395 @@
+/****************************************************************************
+ *
+ *  dlistbench.c -- Make Message File Utilities dlist benchmark
+ *
+ *  ========================================================================
+ *
+ *  Description: Times the dlist operations MKMSGF uses on the include
+ *               symbol list, with the LinkNodes from the slab pool
+ *               (built with USE_POOLMAN) or from malloc (built without).
+ *               The same source is built both ways, see CMakeLists.txt.
+ *
+ *               build   InsertItem n items, DestroyList
+ *               walk    ForEachItem over n items
+ *               churn   n times delete the first item, append a new one
+ *               sort    SortList of n items in random tag order
+ *               tagsort SortListByTag of the same
+ *
+ *               and the same on an arena list (CreateArenaList), which
+ *               does not depend on the build:
+ *
+ *               build   InsertItem n items, DestroyList
+ *               bulk    AppendItems n items in one call, DestroyList
+ *               walk    ForEachItem over n items loaded with AppendItems
+ *
+ *               and on a vector list (CreateVectorList):
+ *
+ *               build   InsertItem n items, DestroyList
+ *               walk    ForEachItem over n items
+ *               sort    SortList of n items in random tag order
+ *               tagsort SortListByTag of the same
+ *
+ *               Each case is the best of the runs, in ns per item.
+ *
+ *  ========================================================================
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include "dlist.h"
+
+#ifdef USE_POOLMAN
+#define BENCH_ALLOC "pool"
+#define NEWLIST() CreateList(256, 0, 256)
+#else
+#define BENCH_ALLOC "malloc"
+#define NEWLIST() CreateList()
+#endif
+
+#define BENCH_ITEM 81 // size of a MKMSGF include symbol item
+
+static char item[BENCH_ITEM] = "MSG_BENCH_SYMBOL";
+static volatile uint32_t sink;
+
+// AppendItems input, n copies of item back to back
+static char *bulkitems;
+static CARDINAL32 *bulksizes;
+static TAG *bulktags;
+
+static uint64_t now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec);
+}
+
+/*
+ * fill( ) - append n items to list, exit on error
+ */
+static void fill(DLIST list, uint32_t n)
+{
+    CARDINAL32 rc = 0;
+
+    for (uint32_t x = 0; x < n; x++)
+    {
+        InsertItem(list, BENCH_ITEM, item, x, NULL, AppendToList, FALSE, &rc);
+        if (rc != DLIST_SUCCESS)
+        {
+            fprintf(stderr, "dlistbench: InsertItem failed (%lu)\n", (unsigned long)rc);
+            exit(1);
+        }
+    }
+}
+
+/*
+ * fillbulk( ) - append n items to list with one AppendItems, exit on error
+ */
+static void fillbulk(DLIST list, uint32_t n)
+{
+    CARDINAL32 rc = 0;
+
+    AppendItems(list, n, bulkitems, bulksizes, bulktags, &rc);
+    if (rc != DLIST_SUCCESS)
+    {
+        fprintf(stderr, "dlistbench: AppendItems failed (%lu)\n", (unsigned long)rc);
+        exit(1);
+    }
+}
+
+/*
+ * fillrandom( ) - append n items with random tags to list, exit on error
+ */
+static void fillrandom(DLIST list, uint32_t n)
+{
+    CARDINAL32 rc = 0;
+    uint32_t seed = 12345;
+
+    for (uint32_t x = 0; x < n; x++)
+    {
+        seed = seed * 1103515245u + 12345u;
+        InsertItem(list, BENCH_ITEM, item, seed >> 8, NULL, AppendToList, FALSE, &rc);
+        if (rc != DLIST_SUCCESS)
+        {
+            fprintf(stderr, "dlistbench: InsertItem failed (%lu)\n", (unsigned long)rc);
+            exit(1);
+        }
+    }
+}
+
+static INTEGER32 comparetag(ADDRESS Object1, TAG Object1Tag, ADDRESS Object2,
+                            TAG Object2Tag, CARDINAL32 *Error)
+{
+    *Error = DLIST_SUCCESS;
+    return (Object1Tag < Object2Tag) ? -1 : (Object1Tag > Object2Tag);
+}
+
+static void walkitem(ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize,
+                     ADDRESS ObjectHandle, ADDRESS Parameters, CARDINAL32 *Error)
+{
+    sink += ((char *)Object)[0] + ObjectTag;
+    *Error = DLIST_SUCCESS;
+}
+
+static uint64_t casebuild(uint32_t n)
+{
+    CARDINAL32 rc = 0;
+    uint64_t start = now();
+    DLIST list = NEWLIST();
+
+    fill(list, n);
+    DestroyList(&list, TRUE, &rc);
+
+    return (now() - start);
+}
+
+static uint64_t casewalk(uint32_t n)
+{
+    CARDINAL32 rc = 0;
+    DLIST list = NEWLIST();
+    uint64_t start;
+    uint64_t elapsed;
+
+    fill(list, n);
+    start = now();
+    ForEachItem(list, &walkitem, NULL, TRUE, &rc);
+    elapsed = now() - start;
+    DestroyList(&list, TRUE, &rc);
+
+    return (elapsed);
+}
+
+static uint64_t casechurn(uint32_t n)
+{
+    CARDINAL32 rc = 0;
+    DLIST list = NEWLIST();
+    uint64_t start;
+    uint64_t elapsed;
+
+    fill(list, n);
+    start = now();
+    for (uint32_t x = 0; x < n; x++)
+    {
+        GoToStartOfList(list, &rc);
+        DeleteItem(list, TRUE, NULL, &rc);
+        InsertItem(list, BENCH_ITEM, item, x, NULL, AppendToList, FALSE, &rc);
+    }
+    elapsed = now() - start;
+    DestroyList(&list, TRUE, &rc);
+
+    return (elapsed);
+}
+
+static uint64_t casesort(uint32_t n)
+{
+    CARDINAL32 rc = 0;
+    DLIST list = NEWLIST();
+    uint64_t start;
+    uint64_t elapsed;
+
+    fillrandom(list, n);
+    start = now();
+    SortList(list, &comparetag, &rc);
+    elapsed = now() - start;
+    DestroyList(&list, TRUE, &rc);
+
+    return (elapsed);
+}
+
+static uint64_t casetagsort(uint32_t n)
+{
+    CARDINAL32 rc = 0;
+    DLIST list = NEWLIST();
+    uint64_t start;
+    uint64_t elapsed;
+
+    fillrandom(list, n);
+    start = now();
+    SortListByTag(list, &rc);
+    elapsed = now() - start;
+    DestroyList(&list, TRUE, &rc);
+
+    return (elapsed);
+}
+
+static uint64_t casevectorbuild(uint32_t n)
+{
+    CARDINAL32 rc = 0;
+    uint64_t start = now();
+    DLIST list = CreateVectorList(0);
+
+    fill(list, n);
+    DestroyList(&list, TRUE, &rc);
+
+    return (now() - start);
+}
+
+static uint64_t casevectorwalk(uint32_t n)
+{
+    CARDINAL32 rc = 0;
+    DLIST list = CreateVectorList(0);
+    uint64_t start;
+    uint64_t elapsed;
+
+    fill(list, n);
+    start = now();
+    ForEachItem(list, &walkitem, NULL, TRUE, &rc);
+    elapsed = now() - start;
+    DestroyList(&list, TRUE, &rc);
+
+    return (elapsed);
+}
+
+static uint64_t casevectorsort(uint32_t n)
+{
+    CARDINAL32 rc = 0;
+    DLIST list = CreateVectorList(0);
+    uint64_t start;
+    uint64_t elapsed;
+
+    fillrandom(list, n);
+    start = now();
+    SortList(list, &comparetag, &rc);
+    elapsed = now() - start;
+    DestroyList(&list, TRUE, &rc);
+
+    return (elapsed);
+}
+
+static uint64_t casevectortagsort(uint32_t n)
+{
+    CARDINAL32 rc = 0;
+    DLIST list = CreateVectorList(0);
+    uint64_t start;
+    uint64_t elapsed;
+
+    fillrandom(list, n);
+    start = now();
+    SortListByTag(list, &rc);
+    elapsed = now() - start;
+    DestroyList(&list, TRUE, &rc);
+
+    return (elapsed);
+}
+
+static uint64_t casearenabuild(uint32_t n)
+{
+    CARDINAL32 rc = 0;
+    uint64_t start = now();
+    DLIST list = CreateArenaList(0);
+
+    fill(list, n);
+    DestroyList(&list, TRUE, &rc);
+
+    return (now() - start);
+}
+
+static uint64_t casearenabulk(uint32_t n)
+{
+    CARDINAL32 rc = 0;
+    uint64_t start = now();
+    DLIST list = CreateArenaList(0);
+
+    fillbulk(list, n);
+    DestroyList(&list, TRUE, &rc);
+
+    return (now() - start);
+}
+
+static uint64_t casearenawalk(uint32_t n)
+{
+    CARDINAL32 rc = 0;
+    DLIST list = CreateArenaList(0);
+    uint64_t start;
+    uint64_t elapsed;
+
+    fillbulk(list, n);
+    start = now();
+    ForEachItem(list, &walkitem, NULL, TRUE, &rc);
+    elapsed = now() - start;
+    DestroyList(&list, TRUE, &rc);
+
+    return (elapsed);
+}
+
+static void report(const char *alloc, const char *name, uint32_t n, uint32_t runs,
+                   uint64_t (*run)(uint32_t))
+{
+    uint64_t best = 0;
+
+    for (uint32_t r = 0; r < runs; r++)
+    {
+        uint64_t ns = run(n);
+        if (r == 0 || ns < best)
+            best = ns;
+    }
+
+    printf("%-7s %-7s %8lu items %8.1f ns/item\n", alloc, name,
+           (unsigned long)n, (double)best / n);
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t sizes[] = {1000, 10000, 100000};
+    uint32_t runs = (argc > 1) ? (uint32_t)atoi(argv[1]) : 10;
+    uint32_t max;
+
+    if (runs < 1)
+        runs = 1;
+
+    max = sizes[sizeof(sizes) / sizeof(sizes[0]) - 1];
+    bulkitems = malloc(max * BENCH_ITEM);
+    bulksizes = malloc(max * sizeof(CARDINAL32));
+    bulktags = malloc(max * sizeof(TAG));
+    if (bulkitems == NULL || bulksizes == NULL || bulktags == NULL)
+    {
+        fprintf(stderr, "dlistbench: out of memory\n");
+        return (1);
+    }
+    for (uint32_t x = 0; x < max; x++)
+    {
+        memcpy(bulkitems + x * BENCH_ITEM, item, BENCH_ITEM);
+        bulksizes[x] = BENCH_ITEM;
+        bulktags[x] = x;
+    }
+
+    for (uint32_t x = 0; x < sizeof(sizes) / sizeof(sizes[0]); x++)
+    {
+        report(BENCH_ALLOC, "build", sizes[x], runs, casebuild);
+        report(BENCH_ALLOC, "walk", sizes[x], runs, casewalk);
+        report(BENCH_ALLOC, "churn", sizes[x], runs, casechurn);
+        report(BENCH_ALLOC, "sort", sizes[x], runs, casesort);
+        report(BENCH_ALLOC, "tagsort", sizes[x], runs, casetagsort);
+        report("arena", "build", sizes[x], runs, casearenabuild);
+        report("arena", "bulk", sizes[x], runs, casearenabulk);
+        report("arena", "walk", sizes[x], runs, casearenawalk);
+        report("vector", "build", sizes[x], runs, casevectorbuild);
+        report("vector", "walk", sizes[x], runs, casevectorwalk);
+        report("vector", "sort", sizes[x], runs, casevectorsort);
+        report("vector", "tagsort", sizes[x], runs, casevectortagsort);
+    }
+
+    free(bulkitems);
+    free(bulksizes);
+    free(bulktags);
+
+    return (0);
+}
@@ -0,0 +1,289 @@
+/****************************************************************************
+ *
+ *  msggen.c -- Make Message File Utilities benchmark input generator
+ *
+ *  ========================================================================
+ *
+ *  Description: Writes a synthetic MKMSGF message source plus matching
+ *               BASEMID/UTILMD1 include files (.INC and .H) so the tools
+ *               can be timed on catalogs of any size up to 16376
+ *               messages. The output only depends on the options, the
+ *               same seed always gives the same files.
+ *
+ *  ========================================================================
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+
+#define GEN_MAXMSG   16376 // most messages MKMSGF can compile, the country
+                           // info offset behind a 32 bit index is 16 bits
+#define GEN_LINE     72    // wrap message text at this column
+#define GEN_MAXLINES 6     // max continuation lines of one message
+
+static const char *words[] = {
+    "file", "drive", "directory", "path", "not", "found", "the", "system",
+    "cannot", "access", "device", "is", "in", "use", "by", "another",
+    "process", "specified", "parameter", "invalid", "memory", "insufficient",
+    "to", "complete", "this", "operation", "press", "any", "key", "continue",
+    "disk", "error", "reading", "writing", "sector", "volume", "label",
+    "network", "name", "share", "printer", "out", "of", "paper", "retry",
+    "abort", "ignore", "codepage", "country", "keyboard", "layout", "copied",
+    "deleted", "renamed", "bytes", "free", "total", "and", "or", "with"};
+
+#define WORDCOUNT (sizeof(words) / sizeof(words[0]))
+
+static const char msgtypes[] = "EHIPW";
+
+typedef struct _GENOPT
+{
+    uint32_t count;    // -n messages to write
+    uint32_t first;    // -f number of the first message
+    uint32_t contpct;  // -c percent of messages with continuation lines
+    uint32_t zeropct;  // -z percent of messages ending in %0
+    uint32_t qpct;     // -q percent of ? placeholder messages
+    uint32_t parmpct;  // -p percent of words replaced by %1 - %9
+    uint32_t seed;     // -s random seed
+    char ident[4];     // -i component identifier
+} GENOPT;
+
+// small LCG so the same seed gives the same catalog on every libc
+static uint32_t genstate;
+
+static uint32_t genrand(uint32_t range)
+{
+    genstate = genstate * 1103515245u + 12345u;
+    return ((genstate >> 8) % range);
+}
+
+static void usage(void)
+{
+    fprintf(stderr,
+            "Usage: msggen [-n count] [-f first] [-c pct] [-z pct] [-q pct]\n"
+            "              [-p pct] [-s seed] [-i ID] outfile.txt\n\n"
+            "  -n  number of messages, 1 - %d (default 1000)\n"
+            "  -f  number of the first message (default 1)\n"
+            "  -c  percent of messages with continuation lines (default 25)\n"
+            "  -z  percent of messages ending with %%0 (default 10)\n"
+            "  -q  percent of ? placeholder messages (default 5)\n"
+            "  -p  percent of words replaced by %%1 - %%9 (default 3)\n"
+            "  -s  random seed (default 1)\n"
+            "  -i  three letter component identifier (default GEN)\n\n"
+            "BASEMID.INC/.H and UTILMD1.INC/.H are written next to outfile.\n",
+            GEN_MAXMSG);
+}
+
+/*************************************************************************
+ * Function:  writetext( )
+ *
+ * Write message text of at least one line: the first line starts after
+ * the "IDnnnnT: " prefix, continuation lines start at column 0.
+ *
+ * 1 Pick the number of lines
+ * 2 Fill each line with words up to GEN_LINE columns, sometimes a
+ *   %1 - %9 parameter instead of a word
+ * 3 Maybe end the last line with %0 instead of a line end
+ *
+ *************************************************************************/
+static void writetext(FILE *fp, GENOPT *opt, uint32_t column)
+{
+    uint32_t lines = 1;
+
+    if (genrand(100) < opt->contpct)
+        lines += 1 + genrand(GEN_MAXLINES - 1);
+
+    for (uint32_t line = 0; line < lines; line++)
+    {
+        uint32_t wordcount = 2 + genrand(10);
+
+        for (uint32_t w = 0; w < wordcount && column < GEN_LINE; w++)
+        {
+            if (w)
+            {
+                fputc(' ', fp);
+                column++;
+            }
+
+            if (genrand(100) < opt->parmpct)
+                column += fprintf(fp, "%%%u", 1 + genrand(9));
+            else
+                column += fprintf(fp, "%s", words[genrand(WORDCOUNT)]);
+        }
+
+        if (line == lines - 1 && genrand(100) < opt->zeropct)
+            fputs("%0", fp);
+
+        fputs("\r\n", fp);
+        column = 0;
+    }
+}
+
+/*************************************************************************
+ * Function:  writeinclude( )
+ *
+ * Write the symbols for messages [from, to) as an ASM INC file and as
+ * a C header, the two forms mkmsgf -a and -c read.
+ *
+ *************************************************************************/
+static int writeinclude(const char *dir, const char *name, GENOPT *opt,
+                        uint32_t from, uint32_t to)
+{
+    char filename[1024];
+    FILE *inc;
+    FILE *hdr;
+
+    snprintf(filename, sizeof(filename), "%s%s.INC", dir, name);
+    inc = fopen(filename, "w");
+    snprintf(filename, sizeof(filename), "%s%s.H", dir, name);
+    hdr = fopen(filename, "w");
+
+    if (inc == NULL || hdr == NULL)
+    {
+        if (inc)
+            fclose(inc);
+        if (hdr)
+            fclose(hdr);
+        fprintf(stderr, "msggen: can not write %s\n", filename);
+        return (1);
+    }
+
+    for (uint32_t x = from; x < to; x++)
+    {
+        fprintf(inc, "MSG_%s_%05u\tEQU\t%u\n", opt->ident, x, x);
+        fprintf(hdr, "#define MSG_%s_%05u\t%u\n", opt->ident, x, x);
+    }
+
+    fclose(inc);
+    fclose(hdr);
+    return (0);
+}
+
+int main(int argc, char *argv[])
+{
+    GENOPT opt = {1000, 1, 25, 10, 5, 3, 1, "GEN"};
+    char dir[1024] = {0};
+    char *sep;
+    FILE *fp;
+    int ch;
+
+    while ((ch = getopt(argc, argv, "n:f:c:z:q:p:s:i:h")) != -1)
+    {
+        switch (ch)
+        {
+        case 'n':
+            opt.count = strtoul(optarg, NULL, 10);
+            break;
+        case 'f':
+            opt.first = strtoul(optarg, NULL, 10);
+            break;
+        case 'c':
+            opt.contpct = strtoul(optarg, NULL, 10);
+            break;
+        case 'z':
+            opt.zeropct = strtoul(optarg, NULL, 10);
+            break;
+        case 'q':
+            opt.qpct = strtoul(optarg, NULL, 10);
+            break;
+        case 'p':
+            opt.parmpct = strtoul(optarg, NULL, 10);
+            break;
+        case 's':
+            opt.seed = strtoul(optarg, NULL, 10);
+            break;
+        case 'i':
+            if (strlen(optarg) != 3)
+            {
+                fprintf(stderr, "msggen: identifier must be 3 chars\n");
+                return (1);
+            }
+            strcpy(opt.ident, optarg);
+            break;
+        default:
+            usage();
+            return (1);
+        }
+    }
+
+    if (optind != argc - 1 || opt.count == 0)
+    {
+        usage();
+        return (1);
+    }
+
+    // a larger catalog would only make a source MKMSGF rejects
+    if (opt.count > GEN_MAXMSG)
+    {
+        fprintf(stderr, "msggen: MKMSGF compiles at most %d messages\n", GEN_MAXMSG);
+        return (1);
+    }
+
+    genstate = opt.seed;
+
+    fp = fopen(argv[optind], "wb");
+    if (fp == NULL)
+    {
+        fprintf(stderr, "msggen: can not write %s\n", argv[optind]);
+        return (1);
+    }
+
+    fprintf(fp, "; Synthetic message catalog: %u messages, seed %u\r\n",
+            opt.count, opt.seed);
+    fprintf(fp, "%s\r\n", opt.ident);
+
+    for (uint32_t x = 0; x < opt.count; x++)
+    {
+        // message IDs only have 4 digits, the index position is what counts
+        uint32_t number = (opt.first + x) % 10000;
+
+        if (genrand(100) < opt.qpct)
+        {
+            fprintf(fp, "%s%04u?:\r\n", opt.ident, number);
+            continue;
+        }
+
+        if (genrand(50) == 0)
+            fputs("; comment line\r\n", fp);
+
+        fprintf(fp, "%s%04u%c: ", opt.ident, number, msgtypes[genrand(5)]);
+        writetext(fp, &opt, 10);
+    }
+
+    if (fclose(fp) != 0)
+    {
+        fprintf(stderr, "msggen: write error %s\n", argv[optind]);
+        return (1);
+    }
+
+    // include files go next to the source, half of the IDs in each
+    strncpy(dir, argv[optind], sizeof(dir) - 1);
+    sep = strrchr(dir, '/');
+    if (sep)
+        sep[1] = 0;
+    else
+        dir[0] = 0;
+
+    if (writeinclude(dir, "BASEMID", &opt, opt.first, opt.first + opt.count / 2) ||
+        writeinclude(dir, "UTILMD1", &opt, opt.first + opt.count / 2, opt.first + opt.count))
+        return (1);
+
+    return (0);
+}
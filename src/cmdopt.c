@@ -0,0 +1,130 @@
+/****************************************************************************
+ *
+ *  cmdopt.c -- Make Message File Utilities
+ *
+ *  ========================================================================
+ *
+ *  Description: Reentrant getopt() replacement. Parsing stops at the
+ *               first argument that is not an option (no reordering of
+ *               argv), same as the Open Watcom getopt().
+ *
+ *  ========================================================================
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include "cmdopt.h"
+
+void CmdOptInit(CMDOPT *co)
+{
+    co->optind = 1;
+    co->optarg = NULL;
+    co->optopt = 0;
+    co->nextchar = 0;
+}
+
+int CmdOptSwitch(char c)
+{
+#if defined(__unix__) || defined(__APPLE__)
+    return (c == '-');
+#else
+    return (c == '-' || c == '/');
+#endif
+}
+
+/*************************************************************************
+ * Function:  CmdOptGet( )
+ *
+ * 1 If not inside an option group, check argv[optind] is an option:
+ *   stop at the end, at a non option and at "--"
+ * 2 Look up the option char in optstring
+ * 3 Option with argument takes the rest of this argv element or the
+ *   next argv element
+ *
+ * Return:    option char, '?' on error, -1 at end of options
+ *************************************************************************/
+
+int CmdOptGet(CMDOPT *co, int argc, char *argv[], const char *optstring)
+{
+    char *arg = NULL;
+    char *spec = NULL;
+    int ch = 0;
+
+    co->optarg = NULL;
+
+    if (co->nextchar == 0)
+    {
+        if (co->optind >= argc || argv[co->optind] == NULL)
+            return (-1);
+
+        arg = argv[co->optind];
+
+        if (!CmdOptSwitch(arg[0]) || arg[1] == 0x00)
+            return (-1);
+
+        if (arg[0] == '-' && arg[1] == '-' && arg[2] == 0x00)
+        {
+            co->optind++;
+            return (-1);
+        }
+
+        co->nextchar = 1;
+    }
+
+    arg = argv[co->optind];
+    ch = (unsigned char)arg[co->nextchar++];
+
+    spec = (ch == ':') ? NULL : strchr(optstring, ch);
+
+    if (spec == NULL)
+    {
+        co->optopt = ch;
+        if (arg[co->nextchar] == 0x00)
+        {
+            co->optind++;
+            co->nextchar = 0;
+        }
+        return ('?');
+    }
+
+    if (spec[1] == ':')
+    {
+        // argument is rest of this element or the next element
+        if (arg[co->nextchar] != 0x00)
+            co->optarg = &arg[co->nextchar];
+        else if (co->optind + 1 < argc)
+            co->optarg = argv[++co->optind];
+        else
+        {
+            co->optopt = ch;
+            co->optind++;
+            co->nextchar = 0;
+            return ('?');
+        }
+
+        co->optind++;
+        co->nextchar = 0;
+    }
+    else if (arg[co->nextchar] == 0x00)
+    {
+        co->optind++;
+        co->nextchar = 0;
+    }
+
+    return (ch);
+}
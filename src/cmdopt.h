@@ -0,0 +1,52 @@
+/****************************************************************************
+ *
+ *  cmdopt.h -- Make Message File Utilities
+ *
+ *  ========================================================================
+ *
+ *  Description: Reentrant command line option parser. Works like
+ *               getopt() but keeps its state in a CMDOPT structure
+ *               instead of optind/optarg globals, so several command
+ *               lines can be parsed at the same time.
+ *
+ *  ========================================================================
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ ***************************************************************************/
+
+#ifndef CMDOPT_H
+#define CMDOPT_H
+
+typedef struct _CMDOPT
+{
+    int optind;    // index of the next argv element to look at
+    char *optarg;  // argument of the option just returned
+    int optopt;    // option char that caused a '?' return
+    int nextchar;  // position inside a group of options like -ev
+} CMDOPT;
+
+// Start parsing at argv[1]
+void CmdOptInit(CMDOPT *co);
+
+// Return the next option char from argv, '?' for an unknown option or
+// a missing argument and -1 when there are no more options. Options
+// start with - (or / except on unix), optstring is as for getopt().
+int CmdOptGet(CMDOPT *co, int argc, char *argv[], const char *optstring);
+
+// Is c an option switch char?
+int CmdOptSwitch(char c);
+
+#endif
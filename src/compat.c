@@ -0,0 +1,256 @@
+/****************************************************************************
+ *
+ *  compat.c -- Make Message File Utilities
+ *
+ *  ========================================================================
+ *
+ *  Description: unix versions of the DOS/OS2 C library extras, see
+ *               compat.h. Nothing in here is built for OS/2.
+ *
+ *  ========================================================================
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ ***************************************************************************/
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#define _GNU_SOURCE     /* FNM_CASEFOLD */
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <dirent.h>
+#include <fnmatch.h>
+#include "compat.h"
+
+/*
+ * copyspan( )
+ *
+ * copy len chars of src to dest (if dest) and 0x00 terminate,
+ * truncated to max - 1 chars
+ */
+static void copyspan(char *dest, const char *src, size_t len, size_t max)
+{
+    if (dest == NULL)
+        return;
+
+    if (len >= max)
+        len = max - 1;
+
+    memcpy(dest, src, len);
+    dest[len] = 0x00;
+}
+
+/*************************************************************************
+ * Function:  _splitpath( )
+ *
+ * Split path into directory (with trailing separator), file name and
+ * extension (with the dot). There are no drives on unix so drive is
+ * always empty. Both / and \ are taken as separators so OS/2 style
+ * names from control files split the same way.
+ *
+ *************************************************************************/
+
+void _splitpath(const char *path, char *drive, char *dir, char *fname, char *ext)
+{
+    const char *base = path;
+    const char *dot = NULL;
+
+    for (const char *p = path; *p; p++)
+        if (*p == '/' || *p == '\\')
+            base = p + 1;
+
+    dot = strrchr(base, '.');
+    if (dot == NULL || dot == base)
+        dot = base + strlen(base);
+
+    copyspan(drive, path, 0, _MAX_DRIVE);
+    copyspan(dir, path, base - path, _MAX_DIR);
+    copyspan(fname, base, dot - base, _MAX_FNAME);
+    copyspan(ext, dot, strlen(dot), _MAX_EXT);
+}
+
+// one matching directory entry
+typedef struct _FINDNAME
+{
+    char *name;
+    int exact;      // 1 if it also matches the pattern case sensitive
+} FINDNAME;
+
+// search state behind a _findfirst handle, the matches of the directory
+// are read once in _findfirst
+typedef struct _FINDSTATE
+{
+    FINDNAME *names;
+    int count;
+    int next;       // next name _findnext returns
+} FINDSTATE;
+
+/*
+ * findcompare( )
+ *
+ * qsort order of the matches: ignoring case, of names that differ only
+ * by case the one matching the pattern case sensitive first, else the
+ * one that sorts first
+ */
+static int findcompare(const void *a, const void *b)
+{
+    const FINDNAME *na = (const FINDNAME *)a;
+    const FINDNAME *nb = (const FINDNAME *)b;
+    int rc = strcasecmp(na->name, nb->name);
+
+    if (rc != 0)
+        return (rc);
+    if (na->exact != nb->exact)
+        return (nb->exact - na->exact);
+
+    return (strcmp(na->name, nb->name));
+}
+
+/*
+ * findread( )
+ *
+ * read all entries of dirname matching the pattern, ignoring case like
+ * OS/2. They are sorted and of names that differ only by case just the
+ * first one is kept, OS/2 would only have one of them
+ */
+static int findread(FINDSTATE *state, const char *dirname, const char *pattern)
+{
+    DIR *dir = NULL;
+    struct dirent *entry = NULL;
+    FINDNAME *names = NULL;
+    int alloc = 0;
+    int count = 0;
+
+    dir = opendir(dirname);
+    if (dir == NULL)
+        return (-1);
+
+    while ((entry = readdir(dir)) != NULL)
+    {
+        if (fnmatch(pattern, entry->d_name, FNM_CASEFOLD) != 0)
+            continue;
+
+        if (state->count == alloc)
+        {
+            alloc = alloc ? alloc * 2 : 16;
+            names = (FINDNAME *)realloc(state->names, alloc * sizeof(FINDNAME));
+            if (names == NULL)
+                break;
+            state->names = names;
+        }
+
+        state->names[state->count].name = strdup(entry->d_name);
+        if (state->names[state->count].name == NULL)
+            break;
+        state->names[state->count].exact = (fnmatch(pattern, entry->d_name, 0) == 0);
+        state->count++;
+    }
+
+    closedir(dir);
+
+    if (entry != NULL)
+        return (-1);
+
+    qsort(state->names, state->count, sizeof(FINDNAME), findcompare);
+
+    for (int x = 0; x < state->count; x++)
+    {
+        if (count && strcasecmp(state->names[count - 1].name, state->names[x].name) == 0)
+            free(state->names[x].name);
+        else
+            state->names[count++] = state->names[x];
+    }
+    state->count = count;
+
+    return (0);
+}
+
+/*
+ * findmatch( )
+ *
+ * next match of the directory, -1 if none left
+ */
+static int findmatch(FINDSTATE *state, struct _finddata_t *fileinfo)
+{
+    const char *name = NULL;
+
+    if (state->next >= state->count)
+        return (-1);
+
+    name = state->names[state->next++].name;
+    copyspan(fileinfo->name, name, strlen(name), sizeof(fileinfo->name));
+
+    return (0);
+}
+
+long _findfirst(const char *filespec, struct _finddata_t *fileinfo)
+{
+    const char *base = filespec;
+    char dirname[_MAX_PATH];
+    FINDSTATE *state = NULL;
+
+    for (const char *p = filespec; *p; p++)
+        if (*p == '/' || *p == '\\')
+            base = p + 1;
+
+    state = (FINDSTATE *)calloc(1, sizeof(FINDSTATE));
+    if (state == NULL)
+        return (-1L);
+
+    copyspan(dirname, filespec, base - filespec, sizeof(dirname));
+    for (char *p = dirname; *p; p++)
+        if (*p == '\\')
+            *p = '/';
+    if (dirname[0] == 0x00)
+        strcpy(dirname, ".");
+
+    if (findread(state, dirname, base) != 0 || findmatch(state, fileinfo) != 0)
+    {
+        _findclose((long)state);
+        return (-1L);
+    }
+
+    return ((long)state);
+}
+
+int _findnext(long handle, struct _finddata_t *fileinfo)
+{
+    return (findmatch((FINDSTATE *)handle, fileinfo));
+}
+
+int _findclose(long handle)
+{
+    FINDSTATE *state = (FINDSTATE *)handle;
+
+    for (int x = 0; x < state->count; x++)
+        free(state->names[x].name);
+    free(state->names);
+    free(state);
+
+    return (0);
+}
+
+long _filelength(int handle)
+{
+    struct stat st;
+
+    if (fstat(handle, &st) != 0)
+        return (-1L);
+
+    return ((long)st.st_size);
+}
+
+#endif
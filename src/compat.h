@@ -0,0 +1,97 @@
+/****************************************************************************
+ *
+ *  compat.h -- Make Message File Utilities
+ *
+ *  ========================================================================
+ *
+ *  Description: Portability layer. On OS/2 this just pulls in the
+ *               Open Watcom headers, on unix it supplies the DOS/OS2
+ *               C library extras the tools use (_splitpath,
+ *               _findfirst, _filelength, chsize, flushall, O_TEXT,
+ *               _MAX_PATH) so they build natively.
+ *
+ *  ========================================================================
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ ***************************************************************************/
+
+#ifndef COMPAT_H
+#define COMPAT_H
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <stdio.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#define MKMSG_UNIX
+
+// FILECOUNTRYINFO holds a _MAX_PATH file name, the MSG file format
+// needs the OS/2 value, not PATH_MAX
+#define _MAX_PATH   260
+#define _MAX_DRIVE  3
+#define _MAX_DIR    256
+#define _MAX_FNAME  256
+#define _MAX_EXT    256
+
+#ifndef O_TEXT
+#define O_TEXT      0
+#endif
+#ifndef O_BINARY
+#define O_BINARY    0
+#endif
+
+#define flushall()  fflush(NULL)
+
+#define PATH_SEP        '/'
+#define PATH_SEP_STR    "/"
+#define PATH_LIST_SEP   ':'
+#define PATH_LIST_STR   ":"
+
+struct _finddata_t
+{
+    char name[_MAX_PATH];   // found file name, no path
+};
+
+void _splitpath(const char *path, char *drive, char *dir, char *fname, char *ext);
+
+// DOS style (case insensitive) wild card search of one directory
+long _findfirst(const char *filespec, struct _finddata_t *fileinfo);
+int _findnext(long handle, struct _finddata_t *fileinfo);
+int _findclose(long handle);
+
+long _filelength(int handle);
+
+#define chsize(fd, size)    ftruncate(fd, size)
+
+#else
+
+#include <os2.h>
+#include <io.h>
+#include <malloc.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define PATH_SEP        '\\'
+#define PATH_SEP_STR    "\\"
+#define PATH_LIST_SEP   ';'
+#define PATH_LIST_STR   ";"
+
+#endif
+
+#endif
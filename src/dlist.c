@@ -24,6 +24,9 @@
 
 /*
  * Functions: DLIST       CreateList
+ *            DLIST       CreateArenaList
+ *            DLIST       CreateVectorList
+ *            void        AppendItems
  *            void        AppendItem
  *            void        AppendObject
  *            void        InsertItem
@@ -59,7 +62,10 @@
  *            void        GoToEndOfList
  *            void        GoToSpecifiedItem
  *            void        SortList
+ *            void        SortListByTag
  *            void        ForEachItem
+ *            void        CreateTagIndex
+ *            void        FindItemsByTag
  *            void        PruneList
  *            void        AppendList
  *
@@ -77,11 +83,10 @@
 #include "dlist.h"    /* Import dlist.h so that the compiler can check the
                          consistency of the declarations in dlist.h against
                          those in this module.                              */
-#ifdef USE_POOLMAN
-
-  #include "poolman.h"  /* POOL, CreatePool, AllocateFromPool, DeallocateToPool, DestroyPool, SmartMalloc, SmartFree */
-
-#endif
+#include "poolman.h"   /* POOL, CreatePool, AllocateFromPool, DeallocateToPool, DestroyPool, PoolObjectsInUse,
+                          ReleasePool, SmartMalloc, SmartFree, ARENA, CreateArena, AllocateFromArena,
+                          DestroyArena                                                                         */
+#include "dvector.h"   /* VECTOR and the Vector functions for lists made by CreateVectorList */
 
 #ifdef DEBUG
 
@@ -104,6 +109,9 @@
    the operation is aborted.                                                 */
 #define VerifyValue 39646966L
 
+/* SortList sorts runs of this many items by insertion before merging. */
+#define SORT_RUN 8
+
 
 /*--------------------------------------------------
  * Private Type definitions
@@ -165,10 +173,49 @@ struct LinkNodeRecord
                                                     item.                                         */
   struct LinkNodeRecord *   NextLinkNode;        /* The LinkNode of the next item in the list. */
   struct LinkNodeRecord *   PreviousLinkNode;    /* The LinkNode of the item preceeding this one in the list. */
+  struct LinkNodeRecord *   NextTaggedNode;      /* The next item with the same tag, lists with a tag index only. */
+#ifdef USE_POOLMAN
+  POOL                      NodePool;            /* The pool this LinkNode came from.  AppendList and
+                                                    TransferItem move LinkNodes between lists, so
+                                                    this is not always the pool of the list.      */
+#endif
 };
 
 typedef struct LinkNodeRecord LinkNode;
 
+/* The tag index of a list, see CreateTagIndex.  Open addressing with
+   linear probing: a slot holds one tag and the chain of LinkNodes with
+   that tag, linked through NextTaggedNode in list order.
+   A slot whose chain runs empty keeps its tag until the table is rebuilt,
+   so no probe sequence is ever cut short.                                */
+
+typedef struct TagSlotRecord
+{
+  TAG           Tag;
+  LinkNode *    FirstNode;           /* The first item with Tag, NULL if there is none. */
+  LinkNode *    LastNode;            /* The last item with Tag. */
+  BOOLEAN       InUse;               /* The slot belongs to Tag. */
+} TagSlot;
+
+typedef struct TagIndexRecord
+{
+  CARDINAL32    SlotCount;           /* Slots in the table, a power of 2. */
+  CARDINAL32    SlotsInUse;          /* Slots that belong to a tag, at most 3/4 of SlotCount. */
+  CARDINAL32    LiveTags;            /* Slots with a chain of items. */
+  TagSlot *     Slots;
+} TagIndex;
+
+/* An item being sorted by SortList or SortListByTag.  The tag and data of
+   the item are copied next to its LinkNode, so the sort only reads the
+   array and the LinkNodes are touched to gather and to relink them.     */
+
+typedef struct SortEntryRecord
+{
+  ADDRESS       DataLocation;
+  TAG           DataTag;
+  LinkNode *    Node;
+} SortEntry;
+
 struct MasterListRecord
 {
   CARDINAL32      ItemCount;             /* The number of items in the list. */
@@ -177,26 +224,739 @@ struct MasterListRecord
   LinkNode *      CurrentItem;           /* The address of the LinkNode of the current item in the list. */
 #ifdef USE_POOLMAN
   POOL            NodePool;              /* The pool of LinkNodes for this DLIST. */
+  CARDINAL32      ForeignNodes;          /* LinkNodes in the list from the pool of another list. */
 #endif
+  ARENA           Arena;                 /* LinkNodes and item copies of a list made by CreateArenaList,
+                                            NULL for other lists.                                         */
+  TagIndex *      TagIndex;              /* Items by tag, NULL until CreateTagIndex. */
+  VECTOR          Vector;                /* The items of a list made by CreateVectorList, NULL for other
+                                            lists.  The other fields are unused then, every function
+                                            hands a vector list to dvector.c once it is validated.    */
   CARDINAL32      Verify;                /* A field to contain the VerifyValue which marks this as a list created by this module. */
 };
 
-typedef struct MasterListRecord ControlNode;
+typedef struct MasterListRecord ControlNode;
+
+
+/*--------------------------------------------------
+ Private global variables.
+--------------------------------------------------*/
+BOOLEAN  ErrorsFound = FALSE; /* Used to track whether or not errors have
+                                 been found.  Can be used with a memory access
+                                 breakpoint to stop program execution when
+                                 an error is detected so that the type of
+                                 error can be seen.                              */
+
+
+/*--------------------------------------------------
+ * Private Functions
+ --------------------------------------------------*/
+
+static ADDRESS InsertLinkNode ( DLIST           ListToAddTo,
+                                CARDINAL32      ItemSize,
+                                ADDRESS         ItemLocation,
+                                TAG             ItemTag,
+                                ADDRESS         TargetHandle,
+                                Insertion_Modes Insert_Mode,
+                                BOOLEAN         MakeCurrent,
+                                CARDINAL32 *    Error);
+
+/*
+ * NewLinkNode( ) - a LinkNode from the arena, the pool or the heap
+ */
+static LinkNode * NewLinkNode(ControlNode * ListData)
+{
+  if (ListData->Arena != NULL)
+    return (LinkNode *) AllocateFromArena(ListData->Arena, sizeof(LinkNode));
+
+#ifdef USE_POOLMAN
+  return (LinkNode *) AllocateFromPool(ListData->NodePool);
+#else
+  return (LinkNode *) malloc( sizeof(LinkNode) );
+#endif
+}
+
+/*
+ * FreeLinkNode( ) - return a LinkNode of ListData, arena nodes stay until
+ * DestroyList
+ */
+static void FreeLinkNode(ControlNode * ListData, LinkNode * Node)
+{
+  if (ListData->Arena != NULL)
+    return;
+
+#ifdef USE_POOLMAN
+  if (Node->NodePool != ListData->NodePool)
+    ListData->ForeignNodes--;
+
+  DeallocateToPool(Node->NodePool,Node);
+#else
+  free(Node);
+#endif
+}
+
+/*
+ * NewItemData( ) - memory for an item copy from the arena or the heap
+ */
+static ADDRESS NewItemData(ControlNode * ListData, CARDINAL32 ItemSize)
+{
+  if (ListData->Arena != NULL)
+    return AllocateFromArena(ListData->Arena, ItemSize);
+
+#ifdef USE_POOLMAN
+  return SmartMalloc(ItemSize);
+#else
+  return malloc(ItemSize);
+#endif
+}
+
+/*
+ * FreeItemData( ) - free an item of ListData, arena items stay until
+ * DestroyList
+ */
+static void FreeItemData(ControlNode * ListData, ADDRESS Data)
+{
+  if (ListData->Arena != NULL)
+    return;
+
+#ifdef USE_POOLMAN
+  SmartFree(Data);
+#else
+  free(Data);
+#endif
+}
+
+/*
+ * TagHash( ) - slot of Tag in a table of Mask + 1 slots
+ */
+static CARDINAL32 TagHash(TAG Tag, CARDINAL32 Mask)
+{
+  CARDINAL32 Hash = (CARDINAL32) Tag * 0x9E3779B1UL;
+
+  return (Hash ^ (Hash >> 16)) & Mask;
+}
+
+/*
+ * FindTagSlot( ) - the slot of Tag, or the free slot it would take
+ */
+static TagSlot * FindTagSlot(TagIndex * Index, TAG Tag)
+{
+  CARDINAL32 Mask = Index->SlotCount - 1;
+  CARDINAL32 Slot = TagHash(Tag, Mask);
+
+  while ( Index->Slots[Slot].InUse && (Index->Slots[Slot].Tag != Tag) )
+    Slot = (Slot + 1) & Mask;
+
+  return &Index->Slots[Slot];
+}
+
+/*
+ * ReserveTags( ) - make room for Count more tags in the tag index of
+ * ListData, so that IndexLinkNode can not fail. FALSE if out of memory.
+ */
+static BOOLEAN ReserveTags(ControlNode * ListData, CARDINAL32 Count)
+{
+  TagIndex *  Index = ListData->TagIndex;
+  TagSlot *   OldSlots;
+  TagSlot *   NewSlot;
+  CARDINAL32  OldCount;
+  CARDINAL32  SlotCount;
+  CARDINAL32  Slot;
+
+  if ( (Index == NULL) || (Count <= (Index->SlotCount / 4) * 3 - Index->SlotsInUse) )
+    return TRUE;
+
+  /* Rebuild at twice the live tags, slots of tags without items are dropped. */
+  if ( Count > 0x3FFFFFFFUL - Index->LiveTags )
+    return FALSE;
+
+  SlotCount = 16;
+  while ( SlotCount < (Index->LiveTags + Count) * 2 )
+    SlotCount *= 2;
+
+  OldSlots = Index->Slots;
+  OldCount = Index->SlotCount;
+
+  Index->Slots = (TagSlot *) calloc(SlotCount, sizeof(TagSlot));
+  if ( Index->Slots == NULL )
+  {
+    Index->Slots = OldSlots;
+    return FALSE;
+  }
+
+  Index->SlotCount = SlotCount;
+  Index->SlotsInUse = Index->LiveTags;
+
+  for ( Slot = 0; Slot < OldCount; Slot++ )
+  {
+    if ( OldSlots[Slot].FirstNode != NULL )
+    {
+      NewSlot = FindTagSlot(Index, OldSlots[Slot].Tag);
+      *NewSlot = OldSlots[Slot];
+    }
+  }
+
+  free(OldSlots);
+
+  return TRUE;
+}
+
+/*
+ * IndexLinkNode( ) - add Node to the end of the chain of its tag, for a
+ * Node behind every indexed item with its tag. Room must have been made
+ * with ReserveTags.
+ */
+static void IndexLinkNode(ControlNode * ListData, LinkNode * Node)
+{
+  TagSlot * Slot;
+
+  Node->NextTaggedNode = NULL;
+
+  if ( ListData->TagIndex == NULL )
+    return;
+
+  Slot = FindTagSlot(ListData->TagIndex, Node->DataTag);
+  if ( !Slot->InUse )
+  {
+    Slot->InUse = TRUE;
+    Slot->Tag = Node->DataTag;
+    ListData->TagIndex->SlotsInUse++;
+  }
+
+  if ( Slot->FirstNode == NULL )
+  {
+    Slot->FirstNode = Node;
+    ListData->TagIndex->LiveTags++;
+  }
+  else
+    Slot->LastNode->NextTaggedNode = Node;
+
+  Slot->LastNode = Node;
+}
+
+/*
+ * PlaceLinkNode( ) - add Node, linked anywhere in the list, to the chain
+ * of its tag at its place in list order. The list is searched both ways
+ * from Node for the nearest item with the same tag. Room must have been
+ * made with ReserveTags.
+ */
+static void PlaceLinkNode(ControlNode * ListData, LinkNode * Node)
+{
+  TagSlot *  Slot;
+  LinkNode * Previous = Node->PreviousLinkNode;
+  LinkNode * Next = Node->NextLinkNode;
+
+  if ( ListData->TagIndex == NULL )
+  {
+    Node->NextTaggedNode = NULL;
+    return;
+  }
+
+  Slot = FindTagSlot(ListData->TagIndex, Node->DataTag);
+  if ( Slot->FirstNode == NULL )
+  {
+    IndexLinkNode(ListData, Node);
+    return;
+  }
+
+  while ( (Next != NULL) && (Next->DataTag != Node->DataTag) )
+  {
+    if ( Previous == NULL )
+    {
+      /* No item with the tag before Node, it starts the chain. */
+      Node->NextTaggedNode = Slot->FirstNode;
+      Slot->FirstNode = Node;
+      return;
+    }
+
+    if ( Previous->DataTag == Node->DataTag )
+    {
+      /* Node follows Previous in the chain. */
+      Node->NextTaggedNode = Previous->NextTaggedNode;
+      Previous->NextTaggedNode = Node;
+      if ( Slot->LastNode == Previous )
+        Slot->LastNode = Node;
+      return;
+    }
+
+    Previous = Previous->PreviousLinkNode;
+    Next = Next->NextLinkNode;
+  }
+
+  /* No item with the tag after Node, it ends the chain. */
+  if ( Next == NULL )
+  {
+    IndexLinkNode(ListData, Node);
+    return;
+  }
+
+  /* Node goes before Next, whose predecessor in the chain is searched. */
+  if ( Slot->FirstNode == Next )
+    Slot->FirstNode = Node;
+  else
+  {
+    for ( Previous = Slot->FirstNode; Previous->NextTaggedNode != Next; Previous = Previous->NextTaggedNode )
+      ;
+    Previous->NextTaggedNode = Node;
+  }
+
+  Node->NextTaggedNode = Next;
+}
+
+/*
+ * UnindexLinkNode( ) - take Node out of the chain of its tag
+ */
+static void UnindexLinkNode(ControlNode * ListData, LinkNode * Node)
+{
+  TagSlot *  Slot;
+  LinkNode * Previous;
+
+  if ( ListData->TagIndex == NULL )
+    return;
+
+  Slot = FindTagSlot(ListData->TagIndex, Node->DataTag);
+
+  if ( Slot->FirstNode == Node )
+  {
+    Slot->FirstNode = Node->NextTaggedNode;
+    Previous = NULL;
+    if ( Slot->FirstNode == NULL )
+      ListData->TagIndex->LiveTags--;
+  }
+  else
+  {
+    for ( Previous = Slot->FirstNode; Previous->NextTaggedNode != Node; Previous = Previous->NextTaggedNode )
+      ;
+    Previous->NextTaggedNode = Node->NextTaggedNode;
+  }
+
+  if ( Slot->LastNode == Node )
+    Slot->LastNode = Previous;
+
+  Node->NextTaggedNode = NULL;
+}
+
+/*
+ * RetagLinkNode( ) - give Node a new tag, it joins the chain of that tag
+ * at its place in list order. Room must have been made with ReserveTags.
+ */
+static void RetagLinkNode(ControlNode * ListData, LinkNode * Node, TAG Tag)
+{
+  if ( Node->DataTag == Tag )
+    return;
+
+  UnindexLinkNode(ListData, Node);
+  Node->DataTag = Tag;
+  PlaceLinkNode(ListData, Node);
+}
+
+/*
+ * ClearTagIndex( ) - empty the tag index of ListData, for an empty list
+ */
+static void ClearTagIndex(ControlNode * ListData)
+{
+  TagIndex * Index = ListData->TagIndex;
+
+  if ( Index == NULL )
+    return;
+
+  memset(Index->Slots, 0, Index->SlotCount * sizeof(TagSlot));
+  Index->SlotsInUse = 0;
+  Index->LiveTags = 0;
+}
+
+/*
+ * IndexAllNodes( ) - rebuild the tag index of ListData in list order.
+ * FALSE if out of memory, the index is incomplete then. Can not fail if
+ * the index already held all tags of the list.
+ */
+static BOOLEAN IndexAllNodes(ControlNode * ListData)
+{
+  LinkNode * Node;
+
+  ClearTagIndex(ListData);
+
+  for ( Node = ListData->StartOfList; Node != NULL; Node = Node->NextLinkNode )
+  {
+    if ( !ReserveTags(ListData, 1) )
+      return FALSE;
+
+    IndexLinkNode(ListData, Node);
+  }
+
+  return TRUE;
+}
+
+/*
+ * RelinkNodes( ) - link the LinkNodes of ListData in the order of Entries,
+ * which holds all ItemCount of them
+ */
+static void RelinkNodes(ControlNode * ListData, SortEntry * Entries)
+{
+  LinkNode *  PreviousNode = NULL;
+  LinkNode *  Node;
+  CARDINAL32  Index;
+
+  for ( Index = 0; Index < ListData->ItemCount; Index++ )
+  {
+    Node = Entries[Index].Node;
+    Node->PreviousLinkNode = PreviousNode;
+
+    if ( PreviousNode != NULL )
+      PreviousNode->NextLinkNode = Node;
+
+    PreviousNode = Node;
+  }
+
+  PreviousNode->NextLinkNode = NULL;
+
+  ListData->StartOfList = Entries[0].Node;
+  ListData->EndOfList = PreviousNode;
+}
+
+/*
+ * SortEntries( ) - stable sort of Count entries with Compare. Runs of
+ * SORT_RUN entries are sorted by insertion, then merged back and forth
+ * between Entries and Scratch, which holds Count more. Returns the array
+ * holding the result, NULL if Compare set *Error.
+ */
+static SortEntry * SortEntries(SortEntry *  Entries,
+                               SortEntry *  Scratch,
+                               CARDINAL32   Count,
+                               INTEGER32    (* _System Compare) (ADDRESS Object1, TAG Object1Tag, ADDRESS Object2, TAG Object2Tag,CARDINAL32 * Error),
+                               CARDINAL32 * Error)
+{
+  SortEntry * Swap;
+  SortEntry   EntryToMove;
+  CARDINAL32  Start;
+  CARDINAL32  Middle;
+  CARDINAL32  End;
+  CARDINAL32  Left;
+  CARDINAL32  Right;
+  CARDINAL32  Position;
+  CARDINAL32  Width;
+  INTEGER32   CompareResult;
+
+  /* Insertion sort each run, an entry only moves past entries greater than it. */
+  for ( Start = 0; Start < Count; Start += SORT_RUN )
+  {
+    End = ( Count - Start > SORT_RUN ) ? Start + SORT_RUN : Count;
+
+    for ( Right = Start + 1; Right < End; Right++ )
+    {
+      EntryToMove = Entries[Right];
+
+      for ( Position = Right; Position > Start; Position-- )
+      {
+        CompareResult = (*Compare)(Entries[Position - 1].DataLocation,Entries[Position - 1].DataTag,EntryToMove.DataLocation,EntryToMove.DataTag,Error);
+
+        if ( *Error != DLIST_SUCCESS )
+          return NULL;
+
+        if ( CompareResult <= 0 )
+          break;
+
+        Entries[Position] = Entries[Position - 1];
+      }
+
+      Entries[Position] = EntryToMove;
+    }
+  }
+
+  /* Merge pairs of runs of Width entries from Entries into Scratch, on a
+     tie the entry of the left run goes first.                            */
+  for ( Width = SORT_RUN; Width < Count; Width *= 2 )
+  {
+    for ( Start = 0; Start < Count; Start += 2 * Width )
+    {
+      Middle = ( Count - Start > Width ) ? Start + Width : Count;
+      End = ( Count - Middle > Width ) ? Middle + Width : Count;
+
+      Left = Start;
+      Right = Middle;
+      Position = Start;
+
+      while ( (Left < Middle) && (Right < End) )
+      {
+        CompareResult = (*Compare)(Entries[Left].DataLocation,Entries[Left].DataTag,Entries[Right].DataLocation,Entries[Right].DataTag,Error);
+
+        if ( *Error != DLIST_SUCCESS )
+          return NULL;
+
+        if ( CompareResult > 0 )
+          Scratch[Position++] = Entries[Right++];
+        else
+          Scratch[Position++] = Entries[Left++];
+      }
+
+      while ( Left < Middle )
+        Scratch[Position++] = Entries[Left++];
+
+      while ( Right < End )
+        Scratch[Position++] = Entries[Right++];
+    }
+
+    Swap = Entries;
+    Entries = Scratch;
+    Scratch = Swap;
+  }
+
+  return Entries;
+}
+
+/*
+ * RadixSortTags( ) - stable LSD radix sort of Count entries by tag, one
+ * pass per byte that is not the same in all tags. Scratch holds Count
+ * more. Returns the array holding the result.
+ */
+static SortEntry * RadixSortTags(SortEntry *  Entries,
+                                 SortEntry *  Scratch,
+                                 CARDINAL32   Count)
+{
+  CARDINAL32  Buckets[256];
+  CARDINAL32  Index;
+  CARDINAL32  Total;
+  CARDINAL32  Position;
+  CARDINAL32  Shift;
+  TAG         Differences = 0;
+  SortEntry * Swap;
+
+  /* The bits that are not the same in all tags. */
+  for ( Index = 1; Index < Count; Index++ )
+    Differences |= Entries[Index].DataTag ^ Entries[0].DataTag;
+
+  for ( Shift = 0; Shift < sizeof(TAG) * 8; Shift += 8 )
+  {
+    if ( ((Differences >> Shift) & 0xFF) == 0 )
+      continue;
+
+    memset(Buckets, 0, sizeof(Buckets));
+
+    for ( Index = 0; Index < Count; Index++ )
+      Buckets[(Entries[Index].DataTag >> Shift) & 0xFF]++;
+
+    /* Turn the bucket sizes into the start of each bucket. */
+    Total = 0;
+    for ( Index = 0; Index < 256; Index++ )
+    {
+      Position = Buckets[Index];
+      Buckets[Index] = Total;
+      Total += Position;
+    }
+
+    for ( Index = 0; Index < Count; Index++ )
+      Scratch[Buckets[(Entries[Index].DataTag >> Shift) & 0xFF]++] = Entries[Index];
+
+    Swap = Entries;
+    Entries = Scratch;
+    Scratch = Swap;
+  }
+
+  return Entries;
+}
+
+/*
+ * CompareTags( ) - the order of SortListByTag as a SortList Compare
+ */
+static INTEGER32 _System CompareTags(ADDRESS Object1, TAG Object1Tag, ADDRESS Object2, TAG Object2Tag, CARDINAL32 * Error)
+{
+  (void) Object1;
+  (void) Object2;
+
+  *Error = DLIST_SUCCESS;
+
+  if ( Object1Tag < Object2Tag )
+    return -1;
+
+  return ( Object1Tag > Object2Tag ) ? 1 : 0;
+}
+
+/*
+ * MergeSortLinkNodes( ) - sort ListData in place by merging sublists, for
+ * when SortList or SortListByTag can not allocate its array
+ */
+static void MergeSortLinkNodes(ControlNode * ListData,
+                               INTEGER32     (* _System Compare) (ADDRESS Object1, TAG Object1Tag, ADDRESS Object2, TAG Object2Tag,CARDINAL32 * Error),
+                               CARDINAL32 *  Error)
+{
+  LinkNode *      NodeToMove;
+
+  LinkNode *      MergeList1;
+  CARDINAL32      MergeList1Size;
+
+  LinkNode *      MergeList2;
+  CARDINAL32      MergeList2Size;
+
+  CARDINAL32      MergeListMaxSize;
+  CARDINAL32      ListSize;
+
+  INTEGER32       CompareResult;
+
+  /* The original list will be repeatedly broken into sublists, which are then
+     merged back into one list.  This process is done two sublists at a time.
+     The two sublists are MergeList1 and MergeList2.  Both sublists are the
+     same size.  The only exception occurs when there are not enough items
+     remaining to create a MergeList2 of the same size as the MergeList1.
+     The size of MergeList1 and MergeList2 starts out at 1, and will be doubled
+     with each iteration of the outer "do" loop below.                            */
+  MergeListMaxSize = 1;
+
+  /* This is the outer "do" loop which controls the size of the sublists being
+     merged.  The sublists are merged two at a time, with MergeList1 and
+     MergeList2 representing the two sublists being merged.                     */
+  do
+  {
+
+    /* The first sublist will always start with the first element of the
+       list being sorted.                                                  */
+    MergeList1 = ListData->StartOfList;
+
+    /* This loop controls the merging of sublists back into one list. */
+    do
+    {
+
+      /* The maximum number of items in each of the sublists to be merged
+         is MergeListMaxSize.  As items are merged, they are removed from
+         the sublist they were in and placed in the single list which results
+         from the merging process.                                             */
+      MergeList1Size = MergeListMaxSize;
+      MergeList2Size = MergeListMaxSize;
+
+      /* Find the start of the second list for merging. */
+      ListSize = MergeList1Size;
+      MergeList2 = MergeList1;
+      while ( ( MergeList2 != NULL  ) && (ListSize > 0) )
+      {
+
+        MergeList2 = MergeList2->NextLinkNode;
+        ListSize--;
+
+      }
+
+      /* Now merge the two lists */
+      while ( (MergeList1 != NULL) && (MergeList2 != NULL) &&
+              (MergeList1Size > 0) && (MergeList2Size > 0) )
+      {
+
+        /* Compare the first item in MergeList1 with the first item in MergeList2. */
+        CompareResult = (*Compare)(MergeList1->DataLocation,MergeList1->DataTag,MergeList2->DataLocation,MergeList2->DataTag,Error);
+
+        /* If there was an error during the comparision, bail out! */
+        if ( *Error != DLIST_SUCCESS )
+        {
+
+          return;
+
+        }
+
+        /* See who gets moved. */
+        if ( CompareResult > 0 )
+        {
+          /* Object1 is greater than Object2. */
+
+          /* Object2 must be placed before Object 1. */
+          NodeToMove = MergeList2;
+
+          /* Make MergeList2 point to the new start of the second list. */
+          MergeList2 = MergeList2->NextLinkNode;
+
+          /* If NodeToMove was the last item in the list, we must update EndOfList since
+             NodeToMove will no longer be the last item in the list!                           */
+          if ( NodeToMove == ListData->EndOfList )
+          {
+            ListData->EndOfList = NodeToMove->PreviousLinkNode;
+          }
+
+          /* Remove NodeToMove from the list. */
+          if ( NodeToMove->PreviousLinkNode != NULL)
+          {
+            NodeToMove->PreviousLinkNode->NextLinkNode = MergeList2;
+
+            if (MergeList2 != NULL)
+            {
+              MergeList2->PreviousLinkNode = NodeToMove->PreviousLinkNode;
+            }
+
+          }
+
+          /* NodeToMove must go in front of the current item in the first list.  The
+            current item in the first list is given by MergeList1.                          */
+          if (MergeList1->PreviousLinkNode != NULL)
+          {
+            /* Make the item before MergeList1 point to NodeToMove. */
+            MergeList1->PreviousLinkNode->NextLinkNode = NodeToMove;
+          }
+
+          /* Make NodeToMove->PreviousLinkNode point to the item before MergeList1. */
+          NodeToMove->PreviousLinkNode = MergeList1->PreviousLinkNode;
+
+          /* Make NodeToMove->NextLinkNode point to MergeList1. */
+          NodeToMove->NextLinkNode = MergeList1;
+
+          /* Complete the process by making MergeList1->PreviousLinkNode point to NodeToMove. */
+          MergeList1->PreviousLinkNode = NodeToMove;
+
+          /* If MergeList1 was the first item in the list, we must update StartOfList since
+            MergeList1 is nolonger the first item in the list!                             */
+          if ( MergeList1 == ListData->StartOfList )
+          {
+            ListData->StartOfList = NodeToMove;
+          }
+
+          MergeList2Size--;
+        }
+        else
+        {
+          /* Object1 is less than or equal to Object2. */
+
+          /* Remove Object1 from the first list.  To do this, we just need to
+             advance the MergeList1 pointer, since it always points to the
+             first item in the first of the lists which are being merged.      */
+          MergeList1 = MergeList1->NextLinkNode;
+          MergeList1Size--;
+        }
+
+      }
+
+      /* We have left the while loop.  All of the items in one of the merge lists
+         must have been used.  We must now setup MergeList1 to point to the first
+         of the next two lists to be merged.                                      */
+      if ( (MergeList2Size == 0) || (MergeList2 == NULL) )
+      {
+
+        /* MergeList2 is empty.  Either MergeList2 now points to the first
+           item in the next list to be merged, or MergeList2 is NULL.  Thus,
+           MergeList2 points to what MergeList1 should point to.  So make
+           MergeList1 equal to MergeList2.  When we reach the top of the
+           "do" loop, MergeList2 will be set to point to the proper location. */
+        MergeList1 = MergeList2;
+
+      }
+      else
+      {
+
+        /* The first of the next two lists to be merged starts after the end of the
+           list pointed to by MergeList2.  Thus, we must start MergeList1 at
+           MergeList2 and advance it past the remaining items in MergeList2.        */
+        ListSize = MergeList2Size;
+        MergeList1 = MergeList2;
+        while ( ( MergeList1 != NULL  ) && (ListSize > 0) )
+        {
 
+          MergeList1 = MergeList1->NextLinkNode;
+          ListSize--;
 
-/*--------------------------------------------------
- Private global variables.
---------------------------------------------------*/
-BOOLEAN  ErrorsFound = FALSE; /* Used to track whether or not errors have
-                                 been found.  Can be used with a memory access
-                                 breakpoint to stop program execution when
-                                 an error is detected so that the type of
-                                 error can be seen.                              */
+        }
 
+      }
 
-/*--------------------------------------------------
- There are no private functions.
---------------------------------------------------*/
+    } while (MergeList1 != NULL);
+
+    MergeListMaxSize = MergeListMaxSize * 2;
+
+  } while ( ListData->ItemCount > MergeListMaxSize);
+
+}
 
 
 
@@ -234,15 +994,14 @@ BOOLEAN  ErrorsFound = FALSE; /* Used to track whether or not errors have
 /*                                     pool is created.              */
 /*          CARDINAL32 MaximumPoolSize - When the pool runs out of   */
 /*                                     link nodes, new nodes are     */
-/*                                     allocated by the pool.  When  */
-/*                                     these links start being       */
-/*                                     returned to the pool, the pool*/
-/*                                     will grow.  This parameter    */
-/*                                     puts a limit on how big the   */
-/*                                     pool may grow to.  Once the   */
-/*                                     pool reaches this size, any   */
-/*                                     link nodes being returned to  */
-/*                                     the pool will be deallocated. */
+/*                                     allocated by the pool, a slab */
+/*                                     of PoolIncrement at a time.   */
+/*                                     This parameter puts a limit   */
+/*                                     on how much the pool keeps:   */
+/*                                     once all link nodes are back  */
+/*                                     in a pool larger than this,   */
+/*                                     its slabs are deallocated.    */
+/*                                     0 means no limit.             */
 /*          CARDINAL32 PoolIncrement - When the pool runs out of link*/
 /*                                   nodes and more are required,    */
 /*                                   the pool will allocate one or   */
@@ -289,9 +1048,13 @@ DLIST _System CreateList(CARDINAL32 InitialPoolSize,
   ListData->StartOfList = NULL;    /* Since the list is empty, there is no first item */
   ListData->EndOfList = NULL;      /* Since the list is empty, there is no last item */
   ListData->CurrentItem = NULL;    /* Since the list is empty, there is no current item */
+  ListData->Arena = NULL;          /* Link nodes come from the pool, items from the heap. */
+  ListData->TagIndex = NULL;       /* No tag index until CreateTagIndex. */
+  ListData->Vector = NULL;         /* Items are kept in LinkNodes. */
 
   /* Create the pool of link nodes for this list. */
   ListData->NodePool = CreatePool(sizeof(LinkNode),InitialPoolSize, MaximumPoolSize, PoolIncrement,FALSE);
+  ListData->ForeignNodes = 0;
 
   if ( ListData->NodePool != NULL )
   {
@@ -376,6 +1139,9 @@ DLIST _System CreateList( void )
   ListData->StartOfList = NULL;    /* Since the list is empty, there is no first item */
   ListData->EndOfList = NULL;      /* Since the list is empty, there is no last item */
   ListData->CurrentItem = NULL;    /* Since the list is empty, there is no current item */
+  ListData->Arena = NULL;          /* Link nodes and items come from the heap. */
+  ListData->TagIndex = NULL;       /* No tag index until CreateTagIndex. */
+  ListData->Vector = NULL;         /* Items are kept in LinkNodes. */
 
   #ifdef DEBUG
 
@@ -392,6 +1158,110 @@ DLIST _System CreateList( void )
 #endif
 
 
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  CreateArenaList                                 */
+/*                                                                   */
+/*   Descriptive Name: Creates a list whose LinkNodes and item       */
+/*                     copies come from an arena.                    */
+/*                                                                   */
+/*   Notes:  See dlist.h for the parameters.                         */
+/*                                                                   */
+/*********************************************************************/
+DLIST _System CreateArenaList( CARDINAL32 ChunkSize )
+{
+
+  ControlNode * ListData;
+
+  ListData = (ControlNode *) malloc(sizeof(ControlNode));
+  if (ListData == NULL)
+  {
+
+    return NULL;
+  }
+
+  ListData->ItemCount = 0;         /* No items in the list. */
+  ListData->StartOfList = NULL;    /* Since the list is empty, there is no first item */
+  ListData->EndOfList = NULL;      /* Since the list is empty, there is no last item */
+  ListData->CurrentItem = NULL;    /* Since the list is empty, there is no current item */
+  ListData->TagIndex = NULL;       /* No tag index until CreateTagIndex. */
+  ListData->Vector = NULL;         /* Items are kept in LinkNodes. */
+#ifdef USE_POOLMAN
+  ListData->NodePool = NULL;       /* Link nodes come from the arena. */
+  ListData->ForeignNodes = 0;
+#endif
+
+  ListData->Arena = CreateArena(ChunkSize);
+  if (ListData->Arena == NULL)
+  {
+
+    free(ListData);
+    return NULL;
+  }
+
+  #ifdef DEBUG
+
+  ListData->Verify = VerifyValue;  /* Initialize the Verify field so that this list will recognized as being valid. */
+
+  #endif
+
+  return (DLIST) ListData;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  CreateVectorList                                */
+/*                                                                   */
+/*   Descriptive Name: Creates a list whose items are kept in an     */
+/*                     array by dvector.c.                           */
+/*                                                                   */
+/*   Notes:  See dlist.h for the parameters.                         */
+/*                                                                   */
+/*********************************************************************/
+DLIST _System CreateVectorList( CARDINAL32 InitialSize )
+{
+
+  ControlNode * ListData;
+
+  ListData = (ControlNode *) malloc(sizeof(ControlNode));
+  if (ListData == NULL)
+  {
+
+    return NULL;
+  }
+
+  ListData->ItemCount = 0;         /* The vector counts the items. */
+  ListData->StartOfList = NULL;    /* No LinkNodes. */
+  ListData->EndOfList = NULL;
+  ListData->CurrentItem = NULL;
+  ListData->Arena = NULL;
+  ListData->TagIndex = NULL;       /* Vector lists are searched without an index. */
+#ifdef USE_POOLMAN
+  ListData->NodePool = NULL;
+  ListData->ForeignNodes = 0;
+#endif
+
+  ListData->Vector = CreateVector(InitialSize);
+  if (ListData->Vector == NULL)
+  {
+
+    free(ListData);
+    return NULL;
+  }
+
+  #ifdef DEBUG
+
+  ListData->Verify = VerifyValue;  /* Initialize the Verify field so that this list will recognized as being valid. */
+
+  #endif
+
+  return (DLIST) ListData;
+
+}
+
+
 /*********************************************************************/
 /*                                                                   */
 /*   Function Name: InsertItem                                       */
@@ -483,6 +1353,18 @@ ADDRESS _System InsertItem ( DLIST           ListToAddTo,
 
   ADDRESS         Buffer;     /* Used during the allocation of space on the heap to hold the item being added to the list. */
   ADDRESS         Handle;     /* Used to capture the handle of the item being inserted. */
+  ControlNode *   ListData = (ControlNode *) ListToAddTo;
+
+#ifdef DEBUG
+
+  /* The list must be valid before its arena can be used for the copy. */
+  if ((ListData == NULL) || (ListData->Verify != VerifyValue))
+  {
+    *Error = DLIST_NOT_INITIALIZED;
+    return NULL;
+  }
+
+#endif
 
   /* Check the size and location of the item to add to the list. */
   if ( ItemLocation == NULL )
@@ -500,11 +1382,7 @@ ADDRESS _System InsertItem ( DLIST           ListToAddTo,
   }
 
   /* Allocate memory to hold the item being added to the list. */
-#ifdef USE_POOLMAN
-  Buffer = SmartMalloc(ItemSize);
-#else
-  Buffer = malloc(ItemSize);
-#endif
+  Buffer = NewItemData(ListData, ItemSize);
 
   /* Did we get the memory we needed? */
   if (Buffer == NULL)
@@ -519,13 +1397,13 @@ ADDRESS _System InsertItem ( DLIST           ListToAddTo,
   memcpy(Buffer,ItemLocation,ItemSize);
 
   /* Now add the item to the list. */
-  Handle = InsertObject(ListToAddTo, ItemSize, Buffer, ItemTag, TargetHandle, Insert_Mode, MakeCurrent, Error);
+  Handle = InsertLinkNode(ListToAddTo, ItemSize, Buffer, ItemTag, TargetHandle, Insert_Mode, MakeCurrent, Error);
 
   if ( *Error != DLIST_SUCCESS )
   {
 
     /* Since we could not add the item to the list, delete the buffer. */
-    free(Buffer);
+    FreeItemData(ListData, Buffer);
     return NULL;
 
   }
@@ -586,6 +1464,8 @@ ADDRESS _System InsertItem ( DLIST           ListToAddTo,
 /*                           be allocated.                           */
 /*                       TargetHandle is invalid or is for an item   */
 /*                           in another list.                        */
+/*                       ListToAddTo is an arena list, its memory is */
+/*                           not freed item by item.                 */
 /*                   If this routine fails, an error code is returned*/
 /*                   and any memory allocated by this function is    */
 /*                   freed.                                          */
@@ -624,6 +1504,42 @@ ADDRESS _System InsertObject ( DLIST           ListToAddTo,
                                CARDINAL32 *    Error)
 {
 
+  ControlNode *      ListData = (ControlNode *) ListToAddTo;
+
+  /* An arena list would never free the object. */
+  if ( (ListData != NULL) && (ListData->Arena != NULL) )
+  {
+    *Error = DLIST_ARENA_LIST;
+    return NULL;
+  }
+
+  return InsertLinkNode(ListToAddTo, ItemSize, ItemLocation, ItemTag, TargetHandle, Insert_Mode, MakeCurrent, Error);
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: InsertLinkNode                                   */
+/*                                                                   */
+/*   Descriptive Name:  Links ItemLocation into the list, the work   */
+/*                      of InsertItem and InsertObject.              */
+/*                                                                   */
+/*   Notes:  Same parameters and errors as InsertObject, except      */
+/*           that arena lists are accepted.  The LinkNode comes from */
+/*           the arena of an arena list.                             */
+/*                                                                   */
+/*********************************************************************/
+static ADDRESS InsertLinkNode ( DLIST           ListToAddTo,
+                                CARDINAL32      ItemSize,
+                                ADDRESS         ItemLocation,
+                                TAG             ItemTag,
+                                ADDRESS         TargetHandle,
+                                Insertion_Modes Insert_Mode,
+                                BOOLEAN         MakeCurrent,
+                                CARDINAL32 *    Error)
+{
+
   /* Since ListToAddTo is of type DLIST, we can not use it without having
      to type cast it each time.  To avoid all of the type casting, we
      will declare a local variable of type ControlNode * and then
@@ -692,7 +1608,7 @@ ADDRESS _System InsertObject ( DLIST           ListToAddTo,
       At this point, CurrentNode has been set equal to TargetHandle if TargetHandle
       is not NULL.  If TargetHandle is NULL, then CurrentNode was set to the current
       item in the list.                                                              .*/
-  if ( TargetHandle != NULL  )
+  if ( (TargetHandle != NULL) && (ListData->Vector == NULL) )
   {
 
     /* Is CurrentNode part of this list? */
@@ -731,12 +1647,19 @@ ADDRESS _System InsertObject ( DLIST           ListToAddTo,
 
 #endif
 
+  /* The handles of a vector list are not LinkNodes, dvector.c checks them. */
+  if ( ListData->Vector != NULL )
+    return VectorInsertObject(ListData->Vector, ItemSize, ItemLocation, ItemTag, TargetHandle, Insert_Mode, MakeCurrent, Error);
+
+  /* Make room in the tag index first, so nothing needs to be undone later. */
+  if ( !ReserveTags(ListData, 1) )
+  {
+    *Error = DLIST_OUT_OF_MEMORY;
+    return NULL;
+  }
+
   /* Since both the list and item are valid, lets make a LinkNode. */
-#ifdef USE_POOLMAN
-  NewNode = (LinkNode *) AllocateFromPool(ListData->NodePool);
-#else
-  NewNode = (LinkNode *) malloc( sizeof(LinkNode) );
-#endif
+  NewNode = NewLinkNode(ListData);
 
   /* Did we get the memory? */
   if (NewNode == NULL)
@@ -753,6 +1676,9 @@ ADDRESS _System InsertObject ( DLIST           ListToAddTo,
   NewNode->PreviousLinkNode = NULL;
   NewNode->ControlNodeLocation = ListData;     /* Initialize the link to the control node
                                                   of the list containing this link node.   */
+#ifdef USE_POOLMAN
+  NewNode->NodePool = ListData->NodePool;         /* Where the link node goes back to, wherever it moves. */
+#endif
 
   /* Now we can add the node to the list. */
 
@@ -840,44 +1766,216 @@ ADDRESS _System InsertObject ( DLIST           ListToAddTo,
 
                           }
 
-                          /* Now make NewNode point to CurrentNode and vice versa. */
-                          CurrentNode->NextLinkNode = NewNode;
-                          NewNode->PreviousLinkNode = CurrentNode;
+                          /* Now make NewNode point to CurrentNode and vice versa. */
+                          CurrentNode->NextLinkNode = NewNode;
+                          NewNode->PreviousLinkNode = CurrentNode;
+
+                          break;
+      case AppendToList:  /* Get the last item in the list. */
+                          CurrentNode = ListData->EndOfList;
+
+                          /* Now insert NewNode after CurrentNode. */
+                          CurrentNode->NextLinkNode = NewNode;
+                          NewNode->PreviousLinkNode = CurrentNode;
+
+                          /* Now update the ControlNode. */
+                          ListData->EndOfList = NewNode;
+
+                          break;
+      default :
+                NewNode->ControlNodeLocation = NULL;
+                FreeLinkNode(ListData, NewNode);
+                *Error = DLIST_INVALID_INSERTION_MODE;
+                return NULL;
+
+    }
+
+  }
+
+  /* Add the item to the tag index, room was made before the LinkNode was allocated. */
+  PlaceLinkNode(ListData, NewNode);
+
+  /* Adjust the count of the number of items in the list. */
+  ListData->ItemCount++;
+
+  /* Should the new node become the current item in the list? */
+  if ( MakeCurrent )
+  {
+
+    /* Adjust the control node so that NewNode becomes the current item in the list. */
+    ListData->CurrentItem = NewNode;
+
+  }
+
+#ifdef PARANOID
+
+  assert (CheckListIntegrity( ListToAddTo ) );
+
+#endif
+
+  /* All done.  Signal successful operation. */
+  *Error = DLIST_SUCCESS;
+
+  return NewNode;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: AppendItems                                      */
+/*                                                                   */
+/*   Descriptive Name:  Appends ItemCount items to the end of a      */
+/*                      DLIST in one call.                           */
+/*                                                                   */
+/*   Notes:  See dlist.h for the parameters.                         */
+/*                                                                   */
+/*           On an arena list the LinkNodes are one array and the    */
+/*           items one block, copied from Items with one memcpy, so  */
+/*           the items stay back to back in memory as they were in   */
+/*           Items.  On other lists each item goes through           */
+/*           InsertItem.                                             */
+/*                                                                   */
+/*********************************************************************/
+void _System AppendItems ( DLIST        ListToAddTo,
+                           CARDINAL32   ItemCount,
+                           ADDRESS      Items,
+                           CARDINAL32 * ItemSizes,
+                           TAG *        ItemTags,
+                           CARDINAL32 * Error)
+{
+
+  ControlNode *   ListData = (ControlNode *) ListToAddTo;
+  LinkNode *      NewNodes;   /* The LinkNodes of the new items, one array in the arena. */
+  char *          Data;       /* The item being appended. */
+  CARDINAL32      TotalSize;  /* The size of all items together. */
+  CARDINAL32      Index;
+
+#ifdef DEBUG
+
+  if ((ListData == NULL) || (ListData->Verify != VerifyValue))
+  {
+    *Error = DLIST_NOT_INITIALIZED;
+    return;
+  }
+
+#endif
+
+  *Error = DLIST_SUCCESS;
+
+  if ( ItemCount == 0 )
+    return;
+
+  if ( (Items == NULL) || (ItemSizes == NULL) )
+  {
+    *Error = DLIST_BAD_ITEM_POINTER;
+    return;
+  }
+
+  /* Check all items before the list is changed. */
+  TotalSize = 0;
+  for ( Index = 0; Index < ItemCount; Index++ )
+  {
+
+    if ( ItemSizes[Index] == 0 )
+    {
+      *Error = DLIST_ITEM_SIZE_ZERO;
+      return;
+    }
+
+    if ( ItemSizes[Index] > 0xFFFFFFFFUL - TotalSize )
+    {
+      *Error = DLIST_OUT_OF_MEMORY;
+      return;
+    }
+
+    TotalSize += ItemSizes[Index];
+
+  }
+
+  /* A vector list makes room for all items at once. */
+  if ( (ListData->Vector != NULL) && !ReserveVector(ListData->Vector, ItemCount) )
+  {
+    *Error = DLIST_OUT_OF_MEMORY;
+    return;
+  }
+
+  if ( ListData->Arena == NULL )
+  {
+
+    /* Without an arena the items are copied to the heap one by one. */
+    Data = (char *) Items;
+    for ( Index = 0; Index < ItemCount; Index++ )
+    {
+
+      InsertItem(ListToAddTo, ItemSizes[Index], Data, ( ItemTags != NULL ) ? ItemTags[Index] : 0,
+                 NULL, AppendToList, FALSE, Error);
+      if ( *Error != DLIST_SUCCESS )
+        return;
+
+      Data += ItemSizes[Index];
+
+    }
+
+    return;
+
+  }
+
+  if ( ItemCount > 0xFFFFFFFFUL / sizeof(LinkNode) )
+  {
+    *Error = DLIST_OUT_OF_MEMORY;
+    return;
+  }
+
+  if ( !ReserveTags(ListData, ItemCount) )
+  {
+    *Error = DLIST_OUT_OF_MEMORY;
+    return;
+  }
 
-                          break;
-      case AppendToList:  /* Get the last item in the list. */
-                          CurrentNode = ListData->EndOfList;
+  /* If the second allocation fails the first stays in the arena until DestroyList. */
+  NewNodes = (LinkNode *) AllocateFromArena(ListData->Arena, ItemCount * sizeof(LinkNode));
+  Data = ( NewNodes != NULL ) ? (char *) AllocateFromArena(ListData->Arena, TotalSize) : NULL;
+  if ( Data == NULL )
+  {
+    *Error = DLIST_OUT_OF_MEMORY;
+    return;
+  }
 
-                          /* Now insert NewNode after CurrentNode. */
-                          CurrentNode->NextLinkNode = NewNode;
-                          NewNode->PreviousLinkNode = CurrentNode;
+  memcpy(Data, Items, TotalSize);
 
-                          /* Now update the ControlNode. */
-                          ListData->EndOfList = NewNode;
+  /* Chain the new LinkNodes, the first one goes after the current end of the list. */
+  for ( Index = 0; Index < ItemCount; Index++ )
+  {
 
-                          break;
-      default :
-                NewNode->ControlNodeLocation = NULL;
-                free(NewNode->DataLocation);
-                free(NewNode);
-                *Error = DLIST_INVALID_INSERTION_MODE;
-                return NULL;
+    NewNodes[Index].DataLocation = Data;
+    NewNodes[Index].DataSize = ItemSizes[Index];
+    NewNodes[Index].DataTag = ( ItemTags != NULL ) ? ItemTags[Index] : 0;
+    NewNodes[Index].ControlNodeLocation = ListData;
+    NewNodes[Index].PreviousLinkNode = ( Index > 0 ) ? &NewNodes[Index - 1] : ListData->EndOfList;
+    NewNodes[Index].NextLinkNode = ( Index + 1 < ItemCount ) ? &NewNodes[Index + 1] : NULL;
+#ifdef USE_POOLMAN
+    NewNodes[Index].NodePool = NULL;
+#endif
+    IndexLinkNode(ListData, &NewNodes[Index]);
 
-    }
+    Data += ItemSizes[Index];
 
   }
 
-  /* Adjust the count of the number of items in the list. */
-  ListData->ItemCount++;
-
-  /* Should the new node become the current item in the list? */
-  if ( MakeCurrent )
+  /* An empty list gets a current item, the way InsertItem does it. */
+  if ( ListData->ItemCount == 0 )
   {
 
-    /* Adjust the control node so that NewNode becomes the current item in the list. */
-    ListData->CurrentItem = NewNode;
+    ListData->StartOfList = NewNodes;
+    ListData->CurrentItem = NewNodes;
 
   }
+  else
+    ListData->EndOfList->NextLinkNode = NewNodes;
+
+  ListData->EndOfList = &NewNodes[ItemCount - 1];
+  ListData->ItemCount += ItemCount;
 
 #ifdef PARANOID
 
@@ -885,11 +1983,6 @@ ADDRESS _System InsertObject ( DLIST           ListToAddTo,
 
 #endif
 
-  /* All done.  Signal successful operation. */
-  *Error = DLIST_SUCCESS;
-
-  return NewNode;
-
 }
 
 
@@ -1010,6 +2103,12 @@ void _System DeleteItem (DLIST        ListToDeleteFrom,
 
 #endif
 
+  if ( ListData->Vector != NULL )
+  {
+    VectorDeleteItem(ListData->Vector, FreeMemory, Handle, Error);
+    return;
+  }
+
   /* Check to see if the DLIST is empty. */
   if (ListData->ItemCount == 0)
   {
@@ -1094,6 +2193,9 @@ void _System DeleteItem (DLIST        ListToDeleteFrom,
 
   }
 
+  /* Take the item out of the tag index. */
+  UnindexLinkNode(ListData, CurrentLinkNode);
+
   /* Adjust the count of items in the list. */
   ListData->ItemCount = ListData->ItemCount - 1;
 
@@ -1101,20 +2203,12 @@ void _System DeleteItem (DLIST        ListToDeleteFrom,
   if ( FreeMemory )
   {
     /* Free the memory associated with the actual item stored in the list. */
-#ifdef USE_POOLMAN
-    SmartFree(CurrentLinkNode->DataLocation);
-#else
-    free(CurrentLinkNode->DataLocation);
-#endif
+    FreeItemData(ListData, CurrentLinkNode->DataLocation);
   }
 
   /* Free the memory associated with the control structures used to manage items in the list. */
   CurrentLinkNode->ControlNodeLocation = NULL;
-#ifdef USE_POOLMAN
-  DeallocateToPool(ListData->NodePool,CurrentLinkNode);    /* Return LinkNode to the Node Pool. */
-#else
-  free(CurrentLinkNode);
-#endif
+  FreeLinkNode(ListData, CurrentLinkNode);    /* Return LinkNode to the Node Pool. */
 
 #ifdef PARANOID
 
@@ -1226,6 +2320,12 @@ void _System DeleteAllItems (DLIST        ListToDeleteFrom,
 
 #endif
 
+  if ( ListData->Vector != NULL )
+  {
+    VectorDeleteAllItems(ListData->Vector, FreeMemory, Error);
+    return;
+  }
+
   /*--------------------------------------------------
      To empty a DLIST, we must traverse the linked
      list of LinkNodes and dispose of each LinkNode,
@@ -1242,27 +2342,22 @@ void _System DeleteAllItems (DLIST        ListToDeleteFrom,
     if ( (CurrentLinkNode->DataLocation != NULL) && FreeMemory )
     {
 
-#ifdef USE_POOLMAN
-      SmartFree(CurrentLinkNode->DataLocation);                /* Free the heap memory used to store the data for the DLIST node. */
-#else
-      free(CurrentLinkNode->DataLocation);
-#endif
+      FreeItemData(ListData, CurrentLinkNode->DataLocation);
 
     }
 
     CurrentLinkNode->ControlNodeLocation = NULL;
 
-#ifdef USE_POOLMAN
-    DeallocateToPool(ListData->NodePool,CurrentLinkNode);   /* Return LinkNode to the Node Pool. */
-#else
-    free(CurrentLinkNode);
-#endif
+    FreeLinkNode(ListData, CurrentLinkNode);   /* Return LinkNode to the Node Pool. */
   }
 
   /* Since there are no items in the list, set the CurrentItem and EndOfList pointers to NULL. */
   ListData->CurrentItem = NULL;
   ListData->EndOfList = NULL;
 
+  /* The tag index stays, empty. */
+  ClearTagIndex(ListData);
+
 #ifdef PARANOID
 
   assert (CheckListIntegrity( ListToDeleteFrom ) );
@@ -1360,6 +2455,7 @@ void _System GetItem( DLIST          ListToGetItemFrom,
      cast once.                                                            */
 
   ControlNode *      ListData;
+  ADDRESS            Object;           /* The item of a vector list. */
 
 
   LinkNode *         CurrentLinkNode;  /* Used to point to the LinkNode of the item we are going to return. */
@@ -1405,6 +2501,14 @@ void _System GetItem( DLIST          ListToGetItemFrom,
 
 #endif
 
+  if ( ListData->Vector != NULL )
+  {
+    Object = VectorGetObject(ListData->Vector, ItemSize, ItemTag, Handle, MakeCurrent, Error);
+    if ( Object != NULL )
+      memcpy(ItemLocation, Object, ItemSize);
+    return;
+  }
+
   /* Check to see if the DLIST is empty. */
   if (ListData->ItemCount == 0)
   {
@@ -1543,6 +2647,7 @@ void _System GetNextItem( DLIST           ListToGetItemFrom,
      initialize it once using ListToAdvance.  This way we just do the
      cast once.                                                            */
   ControlNode *      ListData;
+  ADDRESS            Object;           /* The item of a vector list. */
 
 
   LinkNode *         CurrentLinkNode; /* Used to point to the LinkNode of the
@@ -1598,6 +2703,14 @@ void _System GetNextItem( DLIST           ListToGetItemFrom,
 
 #endif
 
+  if ( ListData->Vector != NULL )
+  {
+    Object = VectorGetNextObject(ListData->Vector, ItemSize, ItemTag, Error);
+    if ( Object != NULL )
+      memcpy(ItemLocation, Object, ItemSize);
+    return;
+  }
+
   /* Check for empty list. */
   if (ListData->ItemCount == 0)
   {
@@ -1723,6 +2836,7 @@ void _System GetPreviousItem( DLIST          ListToGetItemFrom,
      initialize it once using ListToAdvance.  This way we just do the
      cast once.                                                            */
   ControlNode *      ListData;
+  ADDRESS            Object;           /* The item of a vector list. */
 
 
   LinkNode *         CurrentLinkNode; /* Used to point to the LinkNode of the
@@ -1778,6 +2892,14 @@ void _System GetPreviousItem( DLIST          ListToGetItemFrom,
 
 #endif
 
+  if ( ListData->Vector != NULL )
+  {
+    Object = VectorGetPreviousObject(ListData->Vector, ItemSize, ItemTag, Error);
+    if ( Object != NULL )
+      memcpy(ItemLocation, Object, ItemSize);
+    return;
+  }
+
   /* Check for empty list. */
   if (ListData->ItemCount == 0)
   {
@@ -1954,6 +3076,9 @@ ADDRESS _System GetObject( DLIST          ListToGetItemFrom,
 
 #endif
 
+  if ( ListData->Vector != NULL )
+    return VectorGetObject(ListData->Vector, ItemSize, ItemTag, Handle, MakeCurrent, Error);
+
   /* Check to see if the DLIST is empty. */
   if (ListData->ItemCount == 0)
   {
@@ -2133,6 +3258,9 @@ ADDRESS _System GetNextObject( DLIST           ListToGetItemFrom,
 
 #endif
 
+  if ( ListData->Vector != NULL )
+    return VectorGetNextObject(ListData->Vector, ItemSize, ItemTag, Error);
+
   /* Check for empty list. */
   if (ListData->ItemCount == 0)
   {
@@ -2303,6 +3431,9 @@ ADDRESS _System GetPreviousObject( DLIST          ListToGetItemFrom,
 
 #endif
 
+  if ( ListData->Vector != NULL )
+    return VectorGetPreviousObject(ListData->Vector, ItemSize, ItemTag, Error);
+
   /* Check for empty list. */
   if (ListData->ItemCount == 0)
   {
@@ -2446,6 +3577,7 @@ void _System ExtractItem( DLIST          ListToGetItemFrom,
      cast once.                                                            */
 
   ControlNode *      ListData;
+  ADDRESS            Object;           /* The item of a vector list. */
 
 
   LinkNode *         CurrentLinkNode;  /* Used to point to the LinkNode of the item being extracted. */
@@ -2496,6 +3628,17 @@ void _System ExtractItem( DLIST          ListToGetItemFrom,
 
 #endif
 
+  if ( ListData->Vector != NULL )
+  {
+    Object = VectorExtractObject(ListData->Vector, ItemSize, ItemTag, Handle, Error);
+    if ( Object != NULL )
+    {
+      memcpy(ItemLocation, Object, ItemSize);
+      FreeItemData(ListData, Object);
+    }
+    return;
+  }
+
   /* Check to see if the DLIST is empty. */
   if (ListData->ItemCount == 0)
   {
@@ -2597,22 +3740,17 @@ void _System ExtractItem( DLIST          ListToGetItemFrom,
 
   }
 
+  /* Take the item out of the tag index. */
+  UnindexLinkNode(ListData, CurrentLinkNode);
+
   /* Adjust the count of items in the list. */
   ListData->ItemCount = ListData->ItemCount - 1;
 
   /* Now we must free the memory associated with the current node. */
-#ifdef USE_POOLMAN
-  SmartFree(CurrentLinkNode->DataLocation);
-#else
-  free(CurrentLinkNode->DataLocation);
-#endif
+  FreeItemData(ListData, CurrentLinkNode->DataLocation);
 
   CurrentLinkNode->ControlNodeLocation = NULL;
-#ifdef USE_POOLMAN
-  DeallocateToPool(ListData->NodePool,CurrentLinkNode);    /* Return LinkNode to the Node Pool. */
-#else
-  free(CurrentLinkNode);
-#endif
+  FreeLinkNode(ListData, CurrentLinkNode);    /* Return LinkNode to the Node Pool. */
 
 #ifdef PARANOID
 
@@ -2669,6 +3807,7 @@ void _System ExtractItem( DLIST          ListToGetItemFrom,
 /*                             of the current item in the list       */
 /*                         Handle is invalid, or is for an item      */
 /*                             which is not in ListToGetItemFrom     */
+/*                         ListToGetItemFrom is an arena list        */
 /*                   If any of these conditions occur, *Error will   */
 /*                   contain a non-zero error code.                  */
 /*                                                                   */
@@ -2758,6 +3897,16 @@ ADDRESS _System ExtractObject( DLIST          ListToGetItemFrom,
 
 #endif
 
+  if ( ListData->Vector != NULL )
+    return VectorExtractObject(ListData->Vector, ItemSize, ItemTag, Handle, Error);
+
+  /* The object of an arena list lives in the arena, it can not be handed out. */
+  if (ListData->Arena != NULL)
+  {
+    *Error = DLIST_ARENA_LIST;
+    return NULL;
+  }
+
   /* Check to see if the DLIST is empty. */
   if (ListData->ItemCount == 0)
   {
@@ -2859,16 +4008,15 @@ ADDRESS _System ExtractObject( DLIST          ListToGetItemFrom,
 
   }
 
+  /* Take the item out of the tag index. */
+  UnindexLinkNode(ListData, CurrentLinkNode);
+
   /* Adjust the count of items in the list. */
   ListData->ItemCount = ListData->ItemCount - 1;
 
   /* Now we must free the memory associated with the current node. */
   CurrentLinkNode->ControlNodeLocation = NULL;
-#ifdef USE_POOLMAN
-  DeallocateToPool(ListData->NodePool,CurrentLinkNode);    /* Return LinkNode to the Node Pool. */
-#else
-  free(CurrentLinkNode);
-#endif
+  FreeLinkNode(ListData, CurrentLinkNode);    /* Return LinkNode to the Node Pool. */
 
 
 #ifdef PARANOID
@@ -3018,6 +4166,12 @@ void _System ReplaceItem( DLIST         ListToReplaceItemIn,
 
 #endif
 
+  if ( ListData->Vector != NULL )
+  {
+    VectorReplaceItem(ListData->Vector, ItemSize, ItemLocation, ItemTag, Handle, MakeCurrent, Error);
+    return;
+  }
+
   /* Check to see if the DLIST is empty. */
   if (ListData->ItemCount == 0)
   {
@@ -3046,14 +4200,17 @@ void _System ReplaceItem( DLIST         ListToReplaceItemIn,
   else
     CurrentLinkNode = ListData->CurrentItem;    /* Handle was NULL, so use the current item in the list. */
 
+  /* A new tag needs room in the tag index before anything is changed. */
+  if ( (ItemTag != CurrentLinkNode->DataTag) && !ReserveTags(ListData, 1) )
+  {
+    *Error = DLIST_OUT_OF_MEMORY;
+    return;
+  }
+
   /* Since our replacement checks out, we can allocate memory to hold it. */
   if (ItemSize != CurrentLinkNode->DataSize)
   {
-#ifdef USE_POOLMAN
-    NewData = SmartMalloc(ItemSize);
-#else
-    NewData = malloc(ItemSize);
-#endif
+    NewData = NewItemData(ListData, ItemSize);
     if (NewData == NULL)
     {
       *Error = DLIST_OUT_OF_MEMORY;
@@ -3070,16 +4227,12 @@ void _System ReplaceItem( DLIST         ListToReplaceItemIn,
      dispose of the old item. */
   if (CurrentLinkNode->DataLocation != NewData)
   {
-#ifdef USE_POOLMAN
-    SmartFree(CurrentLinkNode->DataLocation);
-#else
-    free(CurrentLinkNode->DataLocation);
-#endif
+    FreeItemData(ListData, CurrentLinkNode->DataLocation);
   }
 
   /* Now lets put our replacement into the list. */
   CurrentLinkNode->DataSize = ItemSize;
-  CurrentLinkNode->DataTag = ItemTag;
+  RetagLinkNode(ListData, CurrentLinkNode, ItemTag);
   CurrentLinkNode->DataLocation = NewData;
 
   /* Did the user want this item to become the current item in the list? */
@@ -3148,6 +4301,7 @@ void _System ReplaceItem( DLIST         ListToReplaceItemIn,
 /*                         The memory required can not be allocated. */
 /*                         Handle is invalid, or is for an item      */
 /*                             which is not in ListToGetItemFrom     */
+/*                         ListToReplaceItemIn is an arena list      */
 /*                    If any of these conditions occurs, *Error      */
 /*                    will contain a non-zero error code.            */
 /*                                                                   */
@@ -3246,6 +4400,16 @@ ADDRESS _System ReplaceObject( DLIST         ListToReplaceItemIn,
 
 #endif
 
+  if ( ListData->Vector != NULL )
+    return VectorReplaceObject(ListData->Vector, ItemSize, ItemLocation, ItemTag, Handle, MakeCurrent, Error);
+
+  /* The old object of an arena list lives in the arena, it can not be handed out. */
+  if (ListData->Arena != NULL)
+  {
+    *Error = DLIST_ARENA_LIST;
+    return NULL;
+  }
+
   /* Check to see if the DLIST is empty. */
   if (ListData->ItemCount == 0)
   {
@@ -3279,6 +4443,13 @@ ADDRESS _System ReplaceObject( DLIST         ListToReplaceItemIn,
 
   }
 
+  /* A new tag needs room in the tag index before anything is changed. */
+  if ( (*ItemTag != CurrentLinkNode->DataTag) && !ReserveTags(ListData, 1) )
+  {
+    *Error = DLIST_OUT_OF_MEMORY;
+    return NULL;
+  }
+
   /* Save the old values of DataSize, DataTag, and DataLocation for return to
      the caller.                                                              */
   OldItemSize = CurrentLinkNode->DataSize;
@@ -3287,7 +4458,7 @@ ADDRESS _System ReplaceObject( DLIST         ListToReplaceItemIn,
 
   /* Now lets put our replacement into the list. */
   CurrentLinkNode->DataSize = *ItemSize;
-  CurrentLinkNode->DataTag = *ItemTag;
+  RetagLinkNode(ListData, CurrentLinkNode, *ItemTag);
   CurrentLinkNode->DataLocation = ItemLocation;
 
   /* Setup return values for user. */
@@ -3404,6 +4575,9 @@ TAG _System GetTag( DLIST  ListToGetTagFrom,
 
 #endif
 
+  if ( ListData->Vector != NULL )
+    return VectorGetTag(ListData->Vector, Handle, ItemSize, Error);
+
   /* Check to see if the DLIST is empty. */
   if (ListData->ItemCount == 0)
   {
@@ -3536,6 +4710,9 @@ ADDRESS _System GetHandle ( DLIST ListToGetHandleFrom, CARDINAL32 * Error)
 
 #endif
 
+  if ( ListData->Vector != NULL )
+    return VectorGetHandle(ListData->Vector, Error);
+
   /* Check to see if the DLIST is empty. */
   if (ListData->ItemCount == 0)
   {
@@ -3629,6 +4806,12 @@ CARDINAL32 _System GetListSize( DLIST ListToGetSizeOf, CARDINAL32 * Error)
 
 #endif
 
+  if ( ListData->Vector != NULL )
+  {
+    *Error = DLIST_SUCCESS;
+    return VectorSize(ListData->Vector);
+  }
+
 #ifdef PARANOID
 
   assert (CheckListIntegrity( ListToGetSizeOf ) );
@@ -3715,6 +4898,12 @@ BOOLEAN _System ListEmpty( DLIST ListToCheck, CARDINAL32 * Error)
 
 #endif
 
+  if ( ListData->Vector != NULL )
+  {
+    *Error = DLIST_SUCCESS;
+    return ( VectorSize(ListData->Vector) == 0 );
+  }
+
   /* Indicate Success */
   *Error = DLIST_SUCCESS;
 
@@ -3799,6 +4988,12 @@ BOOLEAN _System AtEndOfList( DLIST ListToCheck, CARDINAL32 * Error)
 
 #endif
 
+  if ( ListData->Vector != NULL )
+  {
+    *Error = DLIST_SUCCESS;
+    return VectorAtEndOfList(ListData->Vector);
+  }
+
   /* Indicate Success */
   *Error = DLIST_SUCCESS;
 
@@ -3884,6 +5079,12 @@ BOOLEAN _System AtStartOfList( DLIST ListToCheck, CARDINAL32 * Error)
 
 #endif
 
+  if ( ListData->Vector != NULL )
+  {
+    *Error = DLIST_SUCCESS;
+    return VectorAtStartOfList(ListData->Vector);
+  }
+
   /* Indicate Success */
   *Error = DLIST_SUCCESS;
 
@@ -3993,9 +5194,56 @@ void _System DestroyList( DLIST *  ListToDestroy, BOOLEAN FreeItemMemory, CARDIN
      as well as the data item associated with each
      LinkNode.  Once all of the LinkNodes (and their
      data items) have been freed, we can then free the
-     ControlNode.
+     ControlNode.  The LinkNodes and data items of an
+     arena list all live in the arena, they go with it
+     without a traversal.
   --------------------------------------------------*/
 
+  if ( ListData->Arena != NULL )
+  {
+
+    DestroyArena(ListData->Arena);
+    ListData->Arena = NULL;
+    ListData->ItemCount = 0;
+
+  }
+
+  /* A vector list has no LinkNodes, the vector frees its items. */
+  if ( ListData->Vector != NULL )
+  {
+
+    DestroyVector(ListData->Vector, FreeItemMemory);
+    ListData->Vector = NULL;
+
+  }
+
+#ifdef USE_POOLMAN
+
+  /* When the list holds every LinkNode of its pool, the pool goes at once and
+     the LinkNodes are not returned one by one.  Only the items need a walk.    */
+  if ( (ListData->NodePool != NULL) && (ListData->ForeignNodes == 0) &&
+       (PoolObjectsInUse(ListData->NodePool) == ListData->ItemCount) )
+  {
+
+    if ( FreeItemMemory )
+    {
+
+      for ( CurrentLinkNode = ListData->StartOfList; CurrentLinkNode != NULL; CurrentLinkNode = CurrentLinkNode->NextLinkNode )
+      {
+        if ( CurrentLinkNode->DataLocation != NULL )
+          FreeItemData(ListData, CurrentLinkNode->DataLocation);
+      }
+
+    }
+
+    ReleasePool(ListData->NodePool);
+    ListData->NodePool = NULL;
+    ListData->ItemCount = 0;
+
+  }
+
+#endif
+
   /* Loop to dispose of the Listnodes. */
   while (ListData->ItemCount > 0)
   {
@@ -4004,18 +5252,10 @@ void _System DestroyList( DLIST *  ListToDestroy, BOOLEAN FreeItemMemory, CARDIN
     ListData->ItemCount--;                                  /* Decrement the number of items in the list or we will never leave the loop! */
     if ( (CurrentLinkNode->DataLocation != NULL) && FreeItemMemory )
     {
-#ifdef USE_POOLMAN
-      SmartFree(CurrentLinkNode->DataLocation);                /* Free the heap memory used to store the data for the DLIST node. */
-#else
-      free(CurrentLinkNode->DataLocation);
-#endif
+      FreeItemData(ListData, CurrentLinkNode->DataLocation);
     }
     CurrentLinkNode->ControlNodeLocation = NULL;
-#ifdef USE_POOLMAN
-    DeallocateToPool(ListData->NodePool,CurrentLinkNode);   /* Return LinkNode to the Node Pool. */
-#else
-    free(CurrentLinkNode);
-#endif
+    FreeLinkNode(ListData, CurrentLinkNode);   /* Return LinkNode to the Node Pool. */
   }
 
 #ifdef USE_POOLMAN
@@ -4025,6 +5265,16 @@ void _System DestroyList( DLIST *  ListToDestroy, BOOLEAN FreeItemMemory, CARDIN
 
 #endif
 
+  /* Release the tag index. */
+  if ( ListData->TagIndex != NULL )
+  {
+
+    free(ListData->TagIndex->Slots);
+    free(ListData->TagIndex);
+    ListData->TagIndex = NULL;
+
+  }
+
 #ifdef DEBUG
 
   /* Set Verify to 0 so that, if the same block of
@@ -4134,6 +5384,12 @@ void _System NextItem( DLIST  ListToAdvance, CARDINAL32 * Error)
 
 #endif
 
+  if ( ListData->Vector != NULL )
+  {
+    VectorNextItem(ListData->Vector, Error);
+    return;
+  }
+
   /* Check for empty list. */
   if (ListData->ItemCount == 0)
   {
@@ -4247,6 +5503,12 @@ void _System PreviousItem( DLIST  ListToChange, CARDINAL32 * Error)
 
 #endif
 
+  if ( ListData->Vector != NULL )
+  {
+    VectorPreviousItem(ListData->Vector, Error);
+    return;
+  }
+
   /* Check for empty list. */
   if (ListData->ItemCount == 0)
   {
@@ -4348,6 +5610,13 @@ void _System GoToStartOfList( DLIST ListToReset, CARDINAL32 * Error)
 
 #endif
 
+  if ( ListData->Vector != NULL )
+  {
+    VectorGoToStartOfList(ListData->Vector);
+    *Error = DLIST_SUCCESS;
+    return;
+  }
+
   /* Set the current item pointer. */
   ListData->CurrentItem = ListData->StartOfList;
 
@@ -4435,6 +5704,13 @@ void _System GoToEndOfList( DLIST ListToSet, CARDINAL32 * Error)
 
 #endif
 
+  if ( ListData->Vector != NULL )
+  {
+    VectorGoToEndOfList(ListData->Vector);
+    *Error = DLIST_SUCCESS;
+    return;
+  }
+
   /* Set the current item pointer. */
   ListData->CurrentItem = ListData->EndOfList;
 
@@ -4531,6 +5807,12 @@ void _System GoToSpecifiedItem( DLIST ListToReposition, ADDRESS Handle, CARDINAL
 
 #endif
 
+  if ( ListData->Vector != NULL )
+  {
+    VectorGoToSpecifiedItem(ListData->Vector, Handle, Error);
+    return;
+  }
+
   /* Since the list is valid, we must now see if the Handle is valid.  We
      will assume that, if the Handle is not NULL, it points to a LinkNode.
      If the ControlNodeLocation field of the LinkNode points to the
@@ -4624,12 +5906,20 @@ void _System GoToSpecifiedItem( DLIST ListToReposition, ADDRESS Handle, CARDINAL
 /*           this assumption is violated, an exception or trap       */
 /*           may occur.                                              */
 /*                                                                   */
-/*           This function works by breaking the list into sublists  */
-/*           and merging the sublists back into one list.  The size  */
-/*           of the sublists starts at 1, and with each pass, the    */
-/*           of the sublists is doubled.  The sort ends when the size*/
-/*           of a sublist is greater than the size of the original   */
-/*           list.                                                   */
+/*           This function copies the LinkNode addresses, tags and   */
+/*           data addresses into an array, sorts the array and       */
+/*           relinks the list in one pass, so *Compare never waits   */
+/*           on a LinkNode.  Runs of SORT_RUN items are sorted by    */
+/*           insertion, then merged with a second array, doubling    */
+/*           the size of the runs with each pass.  The list is only  */
+/*           relinked if *Compare never set *Error.                  */
+/*                                                                   */
+/*           If the array can not be allocated, the list is sorted   */
+/*           in place by breaking it into sublists and merging the   */
+/*           sublists back into one list.  The size of the sublists  */
+/*           starts at 1, and with each pass, the size of the        */
+/*           sublists is doubled.  The sort ends when the size of a  */
+/*           sublist is greater than the size of the original list.  */
 /*                                                                   */
 /*********************************************************************/
 void _System SortList(DLIST ListToSort,
@@ -4638,18 +5928,10 @@ void _System SortList(DLIST ListToSort,
 {
   ControlNode *   ListData;
 
-  LinkNode *      NodeToMove;
-
-  LinkNode *      MergeList1;
-  CARDINAL32      MergeList1Size;
-
-  LinkNode *      MergeList2;
-  CARDINAL32      MergeList2Size;
-
-  CARDINAL32      MergeListMaxSize;
-  CARDINAL32      ListSize;
-
-  INTEGER32       CompareResult;
+  SortEntry *     Entries;
+  SortEntry *     SortedEntries;
+  LinkNode *      CurrentNode;
+  CARDINAL32      Index;
 
   /* We will assume that ListToSort points to a valid list.  Given this,
      we will initialize ListData to point to the ControlNode of this
@@ -4681,6 +5963,12 @@ void _System SortList(DLIST ListToSort,
 
 #endif
 
+  if ( ListData->Vector != NULL )
+  {
+    VectorSortList(ListData->Vector, Compare, Error);
+    return;
+  }
+
   /* We will assume success until proven otherwise. */
   *Error = DLIST_SUCCESS;
 
@@ -4688,172 +5976,178 @@ void _System SortList(DLIST ListToSort,
   if ( ListData->ItemCount > 1)
   {
 
-    /* The original list will be repeatedly broken into sublists, which are then
-       merged back into one list.  This process is done two sublists at a time.
-       The two sublists are MergeList1 and MergeList2.  Both sublists are the
-       same size.  The only exception occurs when there are not enough items
-       remaining to create a MergeList2 of the same size as the MergeList1.
-       The size of MergeList1 and MergeList2 starts out at 1, and will be doubled
-       with each iteration of the outer "do" loop below.                            */
-    MergeListMaxSize = 1;
+    /* Gather the items into an array with room for a second copy, the
+       scratch space of the merge sort.                                    */
+    Entries = (SortEntry *) SmartMalloc( 2 * ListData->ItemCount * sizeof(SortEntry) );
 
-    /* This is the outer "do" loop which controls the size of the sublists being
-       merged.  The sublists are merged two at a time, with MergeList1 and
-       MergeList2 representing the two sublists being merged.                     */
-    do
+    if ( Entries == NULL )
     {
 
-      /* The first sublist will always start with the first element of the
-         list being sorted.                                                  */
-      MergeList1 = ListData->StartOfList;
+      /* No memory for the array, merge the list in place. */
+      MergeSortLinkNodes(ListData, Compare, Error);
+
+    }
+    else
+    {
 
-      /* This loop controls the merging of sublists back into one list. */
-      do
+      Index = 0;
+      for ( CurrentNode = ListData->StartOfList; CurrentNode != NULL; CurrentNode = CurrentNode->NextLinkNode )
       {
+        Entries[Index].DataLocation = CurrentNode->DataLocation;
+        Entries[Index].DataTag = CurrentNode->DataTag;
+        Entries[Index].Node = CurrentNode;
+        Index++;
+      }
 
-        /* The maximum number of items in each of the sublists to be merged
-           is MergeListMaxSize.  As items are merged, they are removed from
-           the sublist they were in and placed in the single list which results
-           from the merging process.                                             */
-        MergeList1Size = MergeListMaxSize;
-        MergeList2Size = MergeListMaxSize;
-
-        /* Find the start of the second list for merging. */
-        ListSize = MergeList1Size;
-        MergeList2 = MergeList1;
-        while ( ( MergeList2 != NULL  ) && (ListSize > 0) )
-        {
+      SortedEntries = SortEntries(Entries, Entries + ListData->ItemCount, ListData->ItemCount, Compare, Error);
 
-          MergeList2 = MergeList2->NextLinkNode;
-          ListSize--;
+      /* The list is only relinked if the sort finished. */
+      if ( SortedEntries != NULL )
+        RelinkNodes(ListData, SortedEntries);
 
-        }
+      SmartFree(Entries);
 
-        /* Now merge the two lists */
-        while ( (MergeList1 != NULL) && (MergeList2 != NULL) &&
-                (MergeList1Size > 0) && (MergeList2Size > 0) )
-        {
+    }
 
-          /* Compare the first item in MergeList1 with the first item in MergeList2. */
-          CompareResult = (*Compare)(MergeList1->DataLocation,MergeList1->DataTag,MergeList2->DataLocation,MergeList2->DataTag,Error);
+    if ( *Error != DLIST_SUCCESS )
+      return;
 
-          /* If there was an error during the comparision, bail out! */
-          if ( *Error != DLIST_SUCCESS )
-          {
+  }
 
-            return;
+  /* Chains of the tag index follow the new order of the list. */
+  IndexAllNodes(ListData);
 
-          }
+#ifdef PARANOID
 
-          /* See who gets moved. */
-          if ( CompareResult > 0 )
-          {
-            /* Object1 is greater than Object2. */
+  assert (CheckListIntegrity( ListToSort ) );
+
+#endif
+
+}
 
-            /* Object2 must be placed before Object 1. */
-            NodeToMove = MergeList2;
 
-            /* Make MergeList2 point to the new start of the second list. */
-            MergeList2 = MergeList2->NextLinkNode;
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  SortListByTag                                   */
+/*                                                                   */
+/*   Descriptive Name:  This function sorts the items of a list in   */
+/*                      ascending order of their item tags.  Items   */
+/*                      with the same tag keep their order.          */
+/*                                                                   */
+/*   Input: DLIST ListToSort : The DLIST that is to be sorted.       */
+/*          CARDINAL32 * Error : The address of a variable to hold   */
+/*                               the error return value.             */
+/*                                                                   */
+/*   Output:  If successful, this function will set *Error to        */
+/*               DLIST_SUCCESS and ListToSort will have been sorted. */
+/*            If unsuccessful, *Error will contain an error code.    */
+/*                                                                   */
+/*   Error Handling: This function will fail if ListToSort is not a  */
+/*                   valid list.                                     */
+/*                                                                   */
+/*   Side Effects: None.                                             */
+/*                                                                   */
+/*   Notes:  It is assumed that Error contains a valid address. If   */
+/*           this assumption is violated, an exception or trap       */
+/*           may occur.                                              */
+/*                                                                   */
+/*           The tags are copied into an array next to the LinkNode  */
+/*           addresses and radix sorted a byte at a time, so no      */
+/*           compare function is called and the LinkNodes are only   */
+/*           touched to gather them and to relink them.  If the      */
+/*           array can not be allocated, the list is sorted the way  */
+/*           SortList does without its array.                        */
+/*                                                                   */
+/*********************************************************************/
+void _System SortListByTag(DLIST ListToSort, CARDINAL32 * Error)
+{
+  ControlNode *   ListData;
 
-            /* If NodeToMove was the last item in the list, we must update EndOfList since
-               NodeToMove will no longer be the last item in the list!                           */
-            if ( NodeToMove == ListData->EndOfList )
-            {
-              ListData->EndOfList = NodeToMove->PreviousLinkNode;
-            }
+  SortEntry *     Entries;
+  LinkNode *      CurrentNode;
+  CARDINAL32      Index;
+  BOOLEAN         Sorted = TRUE;
 
-            /* Remove NodeToMove from the list. */
-            if ( NodeToMove->PreviousLinkNode != NULL)
-            {
-              NodeToMove->PreviousLinkNode->NextLinkNode = MergeList2;
+  /* We will assume that ListToSort points to a valid list.  Given this,
+     we will initialize ListData to point to the ControlNode of this
+     list.                                                                 */
+  ListData = (ControlNode *) ListToSort;
 
-              if (MergeList2 != NULL)
-              {
-                MergeList2->PreviousLinkNode = NodeToMove->PreviousLinkNode;
-              }
 
-            }
+#ifdef DEBUG
 
-            /* NodeToMove must go in front of the current item in the first list.  The
-              current item in the first list is given by MergeList1.                          */
-            if (MergeList1->PreviousLinkNode != NULL)
-            {
-              /* Make the item before MergeList1 point to NodeToMove. */
-              MergeList1->PreviousLinkNode->NextLinkNode = NodeToMove;
-            }
+  #ifdef PARANOID
 
-            /* Make NodeToMove->PreviousLinkNode point to the item before MergeList1. */
-            NodeToMove->PreviousLinkNode = MergeList1->PreviousLinkNode;
+  if ( !CheckListIntegrity(ListToSort) )
+  {
+    *Error = DLIST_CORRUPTED;
+    return;
+  }
 
-            /* Make NodeToMove->NextLinkNode point to MergeList1. */
-            NodeToMove->NextLinkNode = MergeList1;
+  #else
 
-            /* Complete the process by making MergeList1->PreviousLinkNode point to NodeToMove. */
-            MergeList1->PreviousLinkNode = NodeToMove;
+  /* We must now validate the list before we attempt to use it.  We will
+     do this by checking the Verify field in the ControlNode.               */
+  if ((ListData == NULL) || (ListData->Verify != VerifyValue))
+  {
+    *Error = DLIST_NOT_INITIALIZED;
+    return;
+  }
 
-            /* If MergeList1 was the first item in the list, we must update StartOfList since
-              MergeList1 is nolonger the first item in the list!                             */
-            if ( MergeList1 == ListData->StartOfList )
-            {
-              ListData->StartOfList = NodeToMove;
-            }
+  #endif
 
-            MergeList2Size--;
-          }
-          else
-          {
-            /* Object1 is less than or equal to Object2. */
+#endif
 
-            /* Remove Object1 from the first list.  To do this, we just need to
-               advance the MergeList1 pointer, since it always points to the
-               first item in the first of the lists which are being merged.      */
-            MergeList1 = MergeList1->NextLinkNode;
-            MergeList1Size--;
-          }
+  if ( ListData->Vector != NULL )
+  {
+    VectorSortListByTag(ListData->Vector, Error);
+    return;
+  }
 
-        }
+  /* We will assume success until proven otherwise. */
+  *Error = DLIST_SUCCESS;
 
-        /* We have left the while loop.  All of the items in one of the merge lists
-           must have been used.  We must now setup MergeList1 to point to the first
-           of the next two lists to be merged.                                      */
-        if ( (MergeList2Size == 0) || (MergeList2 == NULL) )
-        {
+  /* Is the list big enough to sort? */
+  if ( ListData->ItemCount < 2 )
+    return;
 
-          /* MergeList2 is empty.  Either MergeList2 now points to the first
-             item in the next list to be merged, or MergeList2 is NULL.  Thus,
-             MergeList2 points to what MergeList1 should point to.  So make
-             MergeList1 equal to MergeList2.  When we reach the top of the
-             "do" loop, MergeList2 will be set to point to the proper location. */
-          MergeList1 = MergeList2;
+  /* Gather the items into an array with room for a second copy, the
+     scratch space of the radix sort.                                      */
+  Entries = (SortEntry *) SmartMalloc( 2 * ListData->ItemCount * sizeof(SortEntry) );
 
-        }
-        else
-        {
+  if ( Entries == NULL )
+  {
 
-          /* The first of the next two lists to be merged starts after the end of the
-             list pointed to by MergeList2.  Thus, we must start MergeList1 at
-             MergeList2 and advance it past the remaining items in MergeList2.        */
-          ListSize = MergeList2Size;
-          MergeList1 = MergeList2;
-          while ( ( MergeList1 != NULL  ) && (ListSize > 0) )
-          {
+    /* No memory for the arrays, merge the list in place. */
+    MergeSortLinkNodes(ListData, &CompareTags, Error);
 
-            MergeList1 = MergeList1->NextLinkNode;
-            ListSize--;
+  }
+  else
+  {
 
-          }
+    Index = 0;
+    for ( CurrentNode = ListData->StartOfList; CurrentNode != NULL; CurrentNode = CurrentNode->NextLinkNode )
+    {
+      Entries[Index].DataTag = CurrentNode->DataTag;
+      Entries[Index].Node = CurrentNode;
 
-        }
+      if ( (Index > 0) && (Entries[Index - 1].DataTag > Entries[Index].DataTag) )
+        Sorted = FALSE;
 
-      } while (MergeList1 != NULL);
+      Index++;
+    }
 
-      MergeListMaxSize = MergeListMaxSize * 2;
+    /* A list that is already in order is left as it is. */
+    if ( !Sorted )
+      RelinkNodes(ListData, RadixSortTags(Entries, Entries + ListData->ItemCount, ListData->ItemCount));
 
-    } while ( ListData->ItemCount > MergeListMaxSize);
+    SmartFree(Entries);
 
   }
 
+  /* Chains of the tag index follow the new order of the list. */
+  IndexAllNodes(ListData);
+
 #ifdef PARANOID
 
   assert (CheckListIntegrity( ListToSort ) );
@@ -5003,6 +6297,12 @@ void _System ForEachItem(DLIST        ListToProcess,
 
 #endif
 
+  if ( ListData->Vector != NULL )
+  {
+    VectorForEachItem(ListData->Vector, ProcessItem, Parameters, Forward, Error);
+    return;
+  }
+
   /* Assume success. */
   *Error = DLIST_SUCCESS;
 
@@ -5071,6 +6371,162 @@ void _System ForEachItem(DLIST        ListToProcess,
 }
 
 
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  CreateTagIndex                                  */
+/*                                                                   */
+/*   Descriptive Name: Gives a list a tag index for FindItemsByTag.  */
+/*                                                                   */
+/*   Notes:  See dlist.h for the parameters.                         */
+/*                                                                   */
+/*********************************************************************/
+void _System CreateTagIndex(DLIST        ListToIndex,
+                            CARDINAL32 * Error)
+{
+
+  ControlNode *      ListData = (ControlNode *) ListToIndex;
+
+#ifdef DEBUG
+
+  if ((ListData == NULL) || (ListData->Verify != VerifyValue))
+  {
+    *Error = DLIST_NOT_INITIALIZED;
+    return;
+  }
+
+#endif
+
+  *Error = DLIST_SUCCESS;
+
+  /* Already indexed, the index is kept up to date.  A vector list is
+     searched without one.                                              */
+  if ( (ListData->TagIndex != NULL) || (ListData->Vector != NULL) )
+    return;
+
+  ListData->TagIndex = (TagIndex *) malloc(sizeof(TagIndex));
+  if ( ListData->TagIndex != NULL )
+  {
+    ListData->TagIndex->SlotCount = 16;
+    ListData->TagIndex->Slots = (TagSlot *) calloc(16, sizeof(TagSlot));
+  }
+
+  if ( (ListData->TagIndex == NULL) || (ListData->TagIndex->Slots == NULL) || !IndexAllNodes(ListData) )
+  {
+
+    if ( ListData->TagIndex != NULL )
+      free(ListData->TagIndex->Slots);
+    free(ListData->TagIndex);
+    ListData->TagIndex = NULL;
+
+    *Error = DLIST_OUT_OF_MEMORY;
+    return;
+
+  }
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  FindItemsByTag                                  */
+/*                                                                   */
+/*   Descriptive Name: Calls ProcessItem for each item with ItemTag. */
+/*                                                                   */
+/*   Notes:  See dlist.h for the parameters.                         */
+/*                                                                   */
+/*           With a tag index this follows the chain of ItemTag,     */
+/*           else it walks the whole list.                           */
+/*                                                                   */
+/*********************************************************************/
+void _System FindItemsByTag(DLIST        ListToSearch,
+                            TAG          ItemTag,
+                            void         (* _System ProcessItem) (ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, ADDRESS ObjectHandle, ADDRESS Parameters, CARDINAL32 * Error),
+                            ADDRESS      Parameters,
+                            CARDINAL32 * Error)
+{
+
+  ControlNode *      ListData = (ControlNode *) ListToSearch;
+  LinkNode *         CurrentLinkNode;  /* The item being processed. */
+  LinkNode *         NextLinkNode;     /* The next item to look at. */
+  TagSlot *          Slot;
+
+#ifdef DEBUG
+
+  #ifdef PARANOID
+
+  if ( !CheckListIntegrity(ListToSearch) )
+  {
+    *Error = DLIST_CORRUPTED;
+    return;
+  }
+
+  #else
+
+  if ((ListData == NULL) || (ListData->Verify != VerifyValue))
+  {
+    *Error = DLIST_NOT_INITIALIZED;
+    return;
+  }
+
+  #endif
+
+#endif
+
+  if ( ListData->Vector != NULL )
+  {
+    VectorFindItemsByTag(ListData->Vector, ItemTag, ProcessItem, Parameters, Error);
+    return;
+  }
+
+  *Error = DLIST_SUCCESS;
+
+  if ( ListData->TagIndex != NULL )
+  {
+
+    Slot = FindTagSlot(ListData->TagIndex, ItemTag);
+    CurrentLinkNode = Slot->InUse ? Slot->FirstNode : NULL;
+
+  }
+  else
+  {
+
+    CurrentLinkNode = ListData->StartOfList;
+    while ( (CurrentLinkNode != NULL) && (CurrentLinkNode->DataTag != ItemTag) )
+      CurrentLinkNode = CurrentLinkNode->NextLinkNode;
+
+  }
+
+  while ( CurrentLinkNode != NULL )
+  {
+
+    /* Find the next item first, so the chain walk does not depend on what ProcessItem does. */
+    if ( ListData->TagIndex != NULL )
+      NextLinkNode = CurrentLinkNode->NextTaggedNode;
+    else
+    {
+      NextLinkNode = CurrentLinkNode->NextLinkNode;
+      while ( (NextLinkNode != NULL) && (NextLinkNode->DataTag != ItemTag) )
+        NextLinkNode = NextLinkNode->NextLinkNode;
+    }
+
+    (*ProcessItem)(CurrentLinkNode->DataLocation, CurrentLinkNode->DataTag, CurrentLinkNode->DataSize, CurrentLinkNode, Parameters, Error);
+    if ( *Error != DLIST_SUCCESS )
+    {
+
+      if ( *Error == DLIST_SEARCH_COMPLETE )
+        *Error = DLIST_SUCCESS;
+
+      return;
+
+    }
+
+    CurrentLinkNode = NextLinkNode;
+
+  }
+
+}
+
+
 /*********************************************************************/
 /*                                                                   */
 /*   Function Name:  PruneList                                       */
@@ -5224,6 +6680,12 @@ void _System PruneList(DLIST        ListToProcess,
 
 #endif
 
+  if ( ListData->Vector != NULL )
+  {
+    VectorPruneList(ListData->Vector, KillItem, Parameters, Error);
+    return;
+  }
+
   /* Assume success. */
   *Error = DLIST_SUCCESS;
 
@@ -5320,6 +6782,9 @@ void _System PruneList(DLIST        ListToProcess,
 
       }
 
+      /* Take the item out of the tag index. */
+      UnindexLinkNode(ListData, CurrentLinkNode);
+
       /* Adjust the count of items in the list. */
       ListData->ItemCount = ListData->ItemCount - 1;
 
@@ -5327,20 +6792,12 @@ void _System PruneList(DLIST        ListToProcess,
       if ( FreeMemory )
       {
         /* Free the memory associated with the actual item stored in the list. */
-#ifdef USE_POOLMAN
-        SmartFree(CurrentLinkNode->DataLocation);
-#else
-        free(CurrentLinkNode->DataLocation);
-#endif
+        FreeItemData(ListData, CurrentLinkNode->DataLocation);
       }
 
       /* Free the memory associated with the control structures used to manage items in the list. */
       CurrentLinkNode->ControlNodeLocation = NULL;
-#ifdef USE_POOLMAN
-      DeallocateToPool(ListData->NodePool,CurrentLinkNode);    /* Return LinkNode to the Node Pool. */
-#else
-      free(CurrentLinkNode);
-#endif
+      FreeLinkNode(ListData, CurrentLinkNode);    /* Return LinkNode to the Node Pool. */
 
       /* Resume our traversal of the tree. */
 
@@ -5434,6 +6891,10 @@ void _System PruneList(DLIST        ListToProcess,
 /*                    SourceList are appended to TargetList, so if an*/
 /*                    error is detected and the function aborts,     */
 /*                    SourceList and TargetList are unaltered.       */
+/*                    DLIST_ARENA_LIST if only one of the lists is   */
+/*                    an arena list.                                 */
+/*                    DLIST_VECTOR_LIST if only one of the lists is  */
+/*                    a vector list.                                 */
 /*                                                                   */
 /*   Side Effects: None.                                             */
 /*                                                                   */
@@ -5515,9 +6976,44 @@ void _System AppendList(DLIST         TargetList,
 
 #endif
 
+  /* The nodes and items of an arena list can not leave it, nor can heap nodes join it. */
+  if ( (TargetListData != SourceListData) &&
+       ( (TargetListData->Arena != NULL) || (SourceListData->Arena != NULL) ) )
+  {
+    *Error = DLIST_ARENA_LIST;
+    return;
+  }
+
+  /* Items in a vector have no LinkNode to move to another kind of list. */
+  if ( (TargetListData->Vector == NULL) != (SourceListData->Vector == NULL) )
+  {
+    *Error = DLIST_VECTOR_LIST;
+    return;
+  }
+
   /* Assume success. */
   *Error = DLIST_SUCCESS;
 
+  /* Two vector lists just swap vectors if the target list is empty. */
+  if ( TargetListData->Vector != NULL )
+  {
+
+    if ( TargetListData == SourceListData )
+      return;
+
+    if ( VectorSize(TargetListData->Vector) == 0 )
+    {
+      TempListData.Vector = TargetListData->Vector;
+      TargetListData->Vector = SourceListData->Vector;
+      SourceListData->Vector = TempListData.Vector;
+      return;
+    }
+
+    VectorAppendVector(TargetListData->Vector, SourceListData->Vector, Error);
+    return;
+
+  }
+
   /* Is the source list empty?  If so, we have nothing to do! */
   if (SourceListData->ItemCount == 0)
   {
@@ -5527,6 +7023,16 @@ void _System AppendList(DLIST         TargetList,
 
   }
 
+  /* The tag index of the target list must have room for all items being moved. */
+  if ( !ReserveTags(TargetListData, SourceListData->ItemCount) )
+  {
+    *Error = DLIST_OUT_OF_MEMORY;
+    return;
+  }
+
+  /* The source list will be empty. */
+  ClearTagIndex(SourceListData);
+
   /* Is the target list currently empty? */
   if (TargetListData->ItemCount == 0)
   {
@@ -5537,11 +7043,24 @@ void _System AppendList(DLIST         TargetList,
     *TargetListData = *SourceListData;
     *SourceListData = TempListData;
 
+    /* Each list keeps its own tag index. */
+    SourceListData->TagIndex = TargetListData->TagIndex;
+    TargetListData->TagIndex = TempListData.TagIndex;
+
     /* Get the first item in the target list. */
     CurrentLinkNode = TargetListData->StartOfList;
 
     /* Adjust the the ControlNodeLocation field of this Link Node. */
     CurrentLinkNode->ControlNodeLocation = TargetListData;
+    IndexLinkNode(TargetListData, CurrentLinkNode);
+
+#ifdef USE_POOLMAN
+
+    /* The pools were swapped with the lists, the moved LinkNodes are counted again below. */
+    SourceListData->ForeignNodes = 0;
+    TargetListData->ForeignNodes = ( CurrentLinkNode->NodePool != TargetListData->NodePool ) ? 1 : 0;
+
+#endif
 
   }
   else
@@ -5569,6 +7088,9 @@ void _System AppendList(DLIST         TargetList,
     SourceListData->EndOfList = NULL;
     SourceListData->CurrentItem = NULL;
     SourceListData->ItemCount = 0;
+#ifdef USE_POOLMAN
+    SourceListData->ForeignNodes = 0;
+#endif
 
   }
 
@@ -5577,6 +7099,11 @@ void _System AppendList(DLIST         TargetList,
   {
     CurrentLinkNode = CurrentLinkNode->NextLinkNode;
     CurrentLinkNode->ControlNodeLocation = TargetListData;
+    IndexLinkNode(TargetListData, CurrentLinkNode);
+#ifdef USE_POOLMAN
+    if ( CurrentLinkNode->NodePool != TargetListData->NodePool )
+      TargetListData->ForeignNodes++;
+#endif
   }
 
 
@@ -5661,6 +7188,20 @@ BOOLEAN _System CheckListIntegrity(DLIST ListToCheck)
 
   }
 
+  /* The items of a vector list are checked by dvector.c. */
+  if ( ListData->Vector != NULL )
+  {
+
+    if ( (ListData->ItemCount != 0) || (ListData->StartOfList != NULL) || !CheckVector(ListData->Vector) )
+    {
+      ErrorsFound = TRUE;
+      return FALSE;
+    }
+
+    return TRUE;
+
+  }
+
   /* Begin Checking. */
 
   if ( ListData->ItemCount == 0 )
@@ -5846,6 +7387,10 @@ BOOLEAN _System CheckListIntegrity(DLIST ListToCheck)
 /*                    SourceList are appended to TargetList, so if an*/
 /*                    error is detected and the function aborts,     */
 /*                    SourceList and TargetList are unaltered.       */
+/*                    DLIST_ARENA_LIST if only one of the lists is   */
+/*                    an arena list.                                 */
+/*                    DLIST_VECTOR_LIST if only one of the lists is  */
+/*                    a vector list.                                 */
 /*                                                                   */
 /*   Side Effects: None.                                             */
 /*                                                                   */
@@ -5939,6 +7484,28 @@ void _System TransferItem(DLIST             SourceList,
 
   }
 
+  /* The nodes and items of an arena list can not leave it, nor can heap nodes join it. */
+  if ( (TargetListData != SourceListData) &&
+       ( (TargetListData->Arena != NULL) || (SourceListData->Arena != NULL) ) )
+  {
+    *Error = DLIST_ARENA_LIST;
+    return;
+  }
+
+  /* Items in a vector have no LinkNode to move to another kind of list. */
+  if ( (TargetListData->Vector == NULL) != (SourceListData->Vector == NULL) )
+  {
+    *Error = DLIST_VECTOR_LIST;
+    return;
+  }
+
+  /* The item keeps its handle, which is valid in TargetList then. */
+  if ( TargetListData->Vector != NULL )
+  {
+    VectorTransferItem(SourceListData->Vector, SourceHandle, TargetListData->Vector, TargetHandle, TransferMode, MakeCurrent, Error);
+    return;
+  }
+
   /* Assume success. */
   *Error = DLIST_SUCCESS;
 
@@ -6003,7 +7570,15 @@ void _System TransferItem(DLIST             SourceList,
 
   }
 
+  /* The tag index of the target list must have room for the item. */
+  if ( !ReserveTags(TargetListData, 1) )
+  {
+    *Error = DLIST_OUT_OF_MEMORY;
+    return;
+  }
+
   /* Remove SourceLinkNode from the SourceList. */
+  UnindexLinkNode(SourceListData, SourceLinkNode);
   PreviousNode = SourceLinkNode->PreviousLinkNode;
   NextNode = SourceLinkNode->NextLinkNode;
   if ( PreviousNode != NULL )
@@ -6159,6 +7734,18 @@ void _System TransferItem(DLIST             SourceList,
 
   /* Adjust the ControlNodeLocation of SourceLinkNode so that it thinks it is now a member of TargetList. */
   SourceLinkNode->ControlNodeLocation = TargetListData;
+  PlaceLinkNode(TargetListData, SourceLinkNode);
+
+#ifdef USE_POOLMAN
+
+  /* Keep count of the LinkNodes each list holds from another pool, see DestroyList. */
+  if ( SourceLinkNode->NodePool != SourceListData->NodePool )
+    SourceListData->ForeignNodes--;
+
+  if ( SourceLinkNode->NodePool != TargetListData->NodePool )
+    TargetListData->ForeignNodes++;
+
+#endif
 
   /* Should the transferred item become the current item in TargetList? */
   if ( MakeCurrent )
@@ -25,8 +25,11 @@
 
 /*
 * Functions: DLIST       CreateList
+*            DLIST       CreateArenaList
+*            DLIST       CreateVectorList
 *            void        InsertItem
 *            void        InsertObject
+*            void        AppendItems
 *            void        GetItem
 *            void        GetNextItem
 *            void        GetPreviousItem
@@ -51,7 +54,10 @@
 *            void        GoToEndOfList
 *            void        GoToSpecifiedItem
 *            void        SortList
+*            void        SortListByTag
 *            void        ForEachItem
+*            void        CreateTagIndex
+*            void        FindItemsByTag
 *            void        PruneList
 *            void        AppendList
 *            void        TransferItem
@@ -141,6 +147,38 @@
 *         users of this module should not call free on an object returned by this
 *         module as long as that object is still within a list.
 *
+*         A list made by CreateArenaList takes its LinkNodes and item copies
+*         from an arena instead of one heap block each, and DestroyList frees
+*         the arena without visiting the items.  Memory of an arena list is
+*         only freed by DestroyList: deleting an item keeps its memory, and
+*         an item kept by DeleteItem or PruneList stays valid until then and
+*         must not be freed by the user.  Since objects of an arena list can
+*         not change hands, InsertObject, ExtractObject and ReplaceObject
+*         fail on it, as do AppendList and TransferItem between an arena
+*         list and another list.  AppendItems loads many items at once.
+*
+*         A list used as a table keyed by item tag can get a tag index with
+*         CreateTagIndex.  FindItemsByTag then finds the items of a tag
+*         without walking the list.  Every function that adds, removes,
+*         retags or moves items keeps the index up to date, at the cost of
+*         a hash lookup per change.  The items of a tag stay in list order
+*         in the index; an item added or retagged away from the end of the
+*         list is placed by searching the list around it for its nearest
+*         item with the same tag.
+*
+*         A list made by CreateVectorList has no LinkNodes.  The location,
+*         size and tag of its items are kept in one array with a gap, so
+*         a list that is mostly appended to and walked reads its items in
+*         order from one block of memory.  Inserting and deleting close
+*         to the last insert or delete is cheap, anywhere else the items
+*         in between move.  Handles stay valid until their item is
+*         deleted, also when AppendList or TransferItem move it to another
+*         vector list.  Items can not move between a vector list and a
+*         list of another kind, AppendList and TransferItem fail with
+*         DLIST_VECTOR_LIST.  A vector list has no tag index:
+*         CreateTagIndex does nothing on it and FindItemsByTag searches
+*         the whole list.
+*
 *
 */
 
@@ -191,6 +229,8 @@ AppendToList
 *    11 : Already at start of list!
 *    12 : Bad Handle!
 *    13 : Invalid Insertion Mode!
+*    14 : Not possible on an arena list!
+*    15 : Not possible between a vector list and another list!
 */
 
 #define DLIST_SUCCESS                    0
@@ -207,6 +247,8 @@ AppendToList
 #define DLIST_ALREADY_AT_START          11
 #define DLIST_BAD_HANDLE                12
 #define DLIST_INVALID_INSERTION_MODE    13
+#define DLIST_ARENA_LIST                14
+#define DLIST_VECTOR_LIST               15
 
 /* The following code is special.  It is for use with the PruneList and ForEachItem functions.  Basically, these functions
 can be thought of as "searching" a list.  They present each item in the list to a user supplied function which can then
@@ -240,15 +282,14 @@ remaining items in the list.
 /*                                     pool is created.              */
 /*          CARDINAL32 MaximumPoolSize - When the pool runs out of   */
 /*                                     link nodes, new nodes are     */
-/*                                     allocated by the pool.  When  */
-/*                                     these links start being       */
-/*                                     returned to the pool, the pool*/
-/*                                     will grow.  This parameter    */
-/*                                     puts a limit on how big the   */
-/*                                     pool may grow to.  Once the   */
-/*                                     pool reaches this size, any   */
-/*                                     link nodes being returned to  */
-/*                                     the pool will be deallocated. */
+/*                                     allocated by the pool, a slab */
+/*                                     of PoolIncrement at a time.   */
+/*                                     This parameter puts a limit   */
+/*                                     on how much the pool keeps:   */
+/*                                     once all link nodes are back  */
+/*                                     in a pool larger than this,   */
+/*                                     its slabs are deallocated.    */
+/*                                     0 means no limit.             */
 /*          CARDINAL32 PoolIncrement - When the pool runs out of link*/
 /*                                   nodes and more are required,    */
 /*                                   the pool will allocate one or   */
@@ -301,6 +342,63 @@ DLIST _System CreateList( void );
 
 #endif
 
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  CreateArenaList                                 */
+/*                                                                   */
+/*   Descriptive Name: This function creates a list whose LinkNodes  */
+/*                     and item copies are allocated from an arena.  */
+/*                                                                   */
+/*   Input: CARDINAL32 ChunkSize - The arena allocates memory in     */
+/*                               chunks of this many bytes, 0 for    */
+/*                               the default.  An item or a batch of */
+/*                               AppendItems larger than a quarter   */
+/*                               chunk gets a chunk of its own.      */
+/*                                                                   */
+/*   Output: If Success : The function return value will be non-NULL */
+/*                                                                   */
+/*           If Failure : The function return value will be NULL.    */
+/*                                                                   */
+/*   Error Handling:  The function will only fail if it can not      */
+/*                    allocate enough memory to create the new list. */
+/*                                                                   */
+/*   Side Effects:  None.                                            */
+/*                                                                   */
+/*   Notes:  Meant for lists that are loaded, read and then          */
+/*           destroyed as a whole.  See the notes on arena lists at  */
+/*           the top of this file.                                   */
+/*                                                                   */
+/*********************************************************************/
+DLIST _System CreateArenaList( CARDINAL32 ChunkSize );
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  CreateVectorList                                */
+/*                                                                   */
+/*   Descriptive Name: This function creates a list that keeps its   */
+/*                     items in an array instead of LinkNodes.       */
+/*                                                                   */
+/*   Input: CARDINAL32 InitialSize - The number of items the array   */
+/*                                 has room for at first, 0 for the  */
+/*                                 default.  The array doubles when  */
+/*                                 it is full.                       */
+/*                                                                   */
+/*   Output: If Success : The function return value will be non-NULL */
+/*                                                                   */
+/*           If Failure : The function return value will be NULL.    */
+/*                                                                   */
+/*   Error Handling:  The function will only fail if it can not      */
+/*                    allocate enough memory to create the new list. */
+/*                                                                   */
+/*   Side Effects:  None.                                            */
+/*                                                                   */
+/*   Notes:  Meant for lists that are appended to and walked more    */
+/*           than they are changed in the middle.  See the notes on  */
+/*           vector lists at the top of this file.                   */
+/*                                                                   */
+/*********************************************************************/
+DLIST _System CreateVectorList( CARDINAL32 InitialSize );
+
 /*********************************************************************/
 /*                                                                   */
 /*   Function Name: InsertItem                                       */
@@ -476,6 +574,60 @@ Insertion_Modes Insert_Mode,
 BOOLEAN         MakeCurrent,
 CARDINAL32 *    Error);
 
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: AppendItems                                      */
+/*                                                                   */
+/*   Descriptive Name:  This function appends ItemCount items to the */
+/*                      end of a DLIST in one call.                  */
+/*                                                                   */
+/*   Input:  DLIST          ListToAddTo : The list to which the      */
+/*                                        items are to be appended.  */
+/*           CARDINAL32    ItemCount : The number of items.          */
+/*           ADDRESS       Items : The items, back to back, item x   */
+/*                                 is ItemSizes[x] bytes long.       */
+/*           CARDINAL32 *  ItemSizes : The size of each item.        */
+/*           TAG *         ItemTags : The item tag of each item, or  */
+/*                                    NULL to give all items tag 0.  */
+/*           CARDINAL32 *  Error : The address of a variable to hold */
+/*                                 the error return code.            */
+/*                                                                   */
+/*   Output:  If the operation is successful, then *Error will be    */
+/*            set to 0.  If the operation fails, then *Error will    */
+/*            contain an error code.                                 */
+/*                                                                   */
+/*   Error Handling: This function will fail under the following     */
+/*                   conditions:                                     */
+/*                       ListToAddTo does not point to a valid       */
+/*                           list                                    */
+/*                       Items or ItemSizes is NULL                  */
+/*                       An item size is 0                           */
+/*                       The memory required can not be allocated.   */
+/*                   The sizes are checked before anything is added. */
+/*                   If memory runs out on an arena list nothing is  */
+/*                   added, on other lists the items appended before */
+/*                   stay in the list.                               */
+/*                                                                   */
+/*   Side Effects: None.                                             */
+/*                                                                   */
+/*   Notes:  The items are copied like InsertItem does.  On an arena */
+/*           list all LinkNodes take one allocation and all items    */
+/*           another, the items stay back to back as in Items, so an */
+/*           item is only aligned if the sizes before it keep it so. */
+/*           On other lists this is InsertItem with AppendToList for */
+/*           each item.                                              */
+/*                                                                   */
+/*           The current item does not change, unless the list was   */
+/*           empty, then the first new item becomes the current item.*/
+/*                                                                   */
+/*********************************************************************/
+void _System AppendItems ( DLIST        ListToAddTo,
+CARDINAL32   ItemCount,
+ADDRESS      Items,
+CARDINAL32 * ItemSizes,
+TAG *        ItemTags,
+CARDINAL32 * Error);
+
 /*********************************************************************/
 /*                                                                   */
 /*   Function Name:  DeleteItem                                      */
@@ -1799,6 +1951,42 @@ void _System SortList(DLIST        ListToSort,
 INTEGER32    (* _System Compare) (ADDRESS Object1, TAG Object1Tag, ADDRESS Object2, TAG Object2Tag,CARDINAL32 * Error),
 CARDINAL32 * Error);
 
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  SortListByTag                                   */
+/*                                                                   */
+/*   Descriptive Name:  This function sorts the items of a list in   */
+/*                      ascending order of their item tags.  Items   */
+/*                      with the same tag keep their order.          */
+/*                                                                   */
+/*   Input: DLIST ListToSort : The DLIST that is to be sorted.       */
+/*          CARDINAL32 * Error : The address of a variable to hold   */
+/*                               the error return value.             */
+/*                                                                   */
+/*   Output:  If successful, this function will set *Error to        */
+/*               DLIST_SUCCESS and ListToSort will have been sorted. */
+/*            If unsuccessful, *Error will contain an error code.    */
+/*                                                                   */
+/*   Error Handling: This function will fail if ListToSort is not a  */
+/*                   valid list.                                     */
+/*                                                                   */
+/*   Side Effects: None.                                             */
+/*                                                                   */
+/*   Notes:  It is assumed that Error contains a valid address. If   */
+/*           this assumption is violated, an exception or trap       */
+/*           may occur.                                              */
+/*                                                                   */
+/*           The tags are copied into an array next to the LinkNode  */
+/*           addresses and radix sorted a byte at a time, so no      */
+/*           compare function is called and the LinkNodes are only   */
+/*           touched to gather them and to relink them.  If the      */
+/*           array can not be allocated, the list is sorted the way  */
+/*           SortList does without its array.                        */
+/*                                                                   */
+/*********************************************************************/
+void _System SortListByTag(DLIST        ListToSort,
+CARDINAL32 * Error);
+
 /*********************************************************************/
 /*                                                                   */
 /*   Function Name:  ForEachItem                                     */
@@ -1899,6 +2087,81 @@ ADDRESS      Parameters,
 BOOLEAN      Forward,
 CARDINAL32 * Error);
 
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  CreateTagIndex                                  */
+/*                                                                   */
+/*   Descriptive Name: Gives a list a tag index, a hash table from   */
+/*                     item tag to the items with that tag.          */
+/*                                                                   */
+/*   Input:  DLIST ListToIndex : The list to index.                  */
+/*           CARDINAL32 * Error : The address of a variable to hold  */
+/*                                the error return value.            */
+/*                                                                   */
+/*   Output:  If successful, this function will set *Error to        */
+/*               DLIST_SUCCESS.                                      */
+/*            If unsuccessful, then this function will set *Error to */
+/*               a non-zero error code.                              */
+/*                                                                   */
+/*   Error Handling: This function fails if ListToIndex is not a     */
+/*                   valid list or the index can not be allocated.   */
+/*                   The list is unchanged and without an index then.*/
+/*                                                                   */
+/*   Side Effects: None.                                             */
+/*                                                                   */
+/*   Notes: The index is kept until DestroyList.  Calling this       */
+/*          function on a list with an index, or on a vector list,   */
+/*          does nothing.                                            */
+/*                                                                   */
+/*          Once a list has an index, functions that add an item     */
+/*          or change its tag may also fail with DLIST_OUT_OF_MEMORY */
+/*          when the index has to grow.  Nothing is changed then.    */
+/*                                                                   */
+/*********************************************************************/
+void _System CreateTagIndex(DLIST        ListToIndex,
+CARDINAL32 * Error);
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  FindItemsByTag                                  */
+/*                                                                   */
+/*   Descriptive Name: Calls ProcessItem for each item in the list   */
+/*                     with the tag ItemTag.                         */
+/*                                                                   */
+/*   Input:  DLIST ListToSearch : The list to search.                */
+/*           TAG ItemTag : The item tag to look for.                 */
+/*           void (*ProcessItem) (...) : The function to call, with  */
+/*                                      the same parameters as for   */
+/*                                      ForEachItem.                 */
+/*           ADDRESS Parameters : Passed on to *ProcessItem.         */
+/*           CARDINAL32 * Error : The address of a variable to hold  */
+/*                                the error return value.            */
+/*                                                                   */
+/*   Output:  If successful, this function will set *Error to        */
+/*               DLIST_SUCCESS, also if no item has ItemTag.         */
+/*            If unsuccessful, then this function will set *Error to */
+/*               a non-zero error code.                              */
+/*                                                                   */
+/*   Error Handling: This function aborts when *ProcessItem sets     */
+/*                   *Error, DLIST_SEARCH_COMPLETE ends the search   */
+/*                   with DLIST_SUCCESS like ForEachItem does.       */
+/*                                                                   */
+/*   Side Effects: None.                                             */
+/*                                                                   */
+/*   Notes: The items are visited in list order.  With a tag index   */
+/*          (CreateTagIndex) only the items with ItemTag are looked  */
+/*          at, without one the whole list is searched.              */
+/*                                                                   */
+/*          *ProcessItem may use the handle it gets, but it must not */
+/*          add, remove or retag items of the list.                  */
+/*                                                                   */
+/*********************************************************************/
+void _System FindItemsByTag(DLIST        ListToSearch,
+TAG          ItemTag,
+void         (* _System ProcessItem) (ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, ADDRESS ObjectHandle, ADDRESS Parameters, CARDINAL32 * Error),
+ADDRESS      Parameters,
+CARDINAL32 * Error);
+
 /*********************************************************************/
 /*                                                                   */
 /*   Function Name:  PruneList                                       */
@@ -2029,7 +2292,11 @@ CARDINAL32 * Error);
 /*                                                                   */
 /*   Side Effects: None.                                             */
 /*                                                                   */
-/*   Notes: None.                                                    */
+/*   Notes: Two vector lists keep the handles of the items, which    */
+/*          are valid in TargetList then.  TargetList is grown for   */
+/*          all items first, so if memory runs out no item moves.    */
+/*          A vector list and a list of another kind fail with       */
+/*          DLIST_VECTOR_LIST.                                       */
 /*                                                                   */
 /*********************************************************************/
 void _System AppendList(DLIST        TargetList,
@@ -2086,7 +2353,9 @@ CARDINAL32 * Error);
 /*                                                                   */
 /*   Side Effects: None.                                             */
 /*                                                                   */
-/*   Notes: None.                                                    */
+/*   Notes: Between two vector lists the item keeps its handle,      */
+/*          which is valid in TargetList then.  A vector list and a  */
+/*          list of another kind fail with DLIST_VECTOR_LIST.        */
 /*                                                                   */
 /*********************************************************************/
 void _System TransferItem(DLIST             SourceList,
@@ -0,0 +1,1419 @@
+/*
+*
+*   This program is free software;  you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 2 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY;  without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+*   the GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program;  if not, write to the Free Software
+*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+*/
+
+/*
+* Description:  The gap buffer behind the lists made by CreateVectorList,
+*               see dvector.h.
+*
+*/
+
+#include <stdlib.h>   /* realloc */
+#include <string.h>   /* memcpy, memmove */
+#include "dvector.h"
+#include "poolman.h"  /* POOL, CreatePool, AllocateFromPool, DeallocateToPool, DestroyPool, SmartMalloc,
+                         SmartFree                                                                       */
+
+
+/*--------------------------------------------------
+ * Private Constants
+ --------------------------------------------------*/
+
+/* The limit on the items of a vector. */
+#define MAXIMUM_ITEMS   0x7FFFFFFFUL
+
+/* VectorSortList sorts runs of this many items by insertion before merging. */
+#define SORT_RUN        8
+
+/* Handles per slab of the handle pool of a vector. */
+#define HANDLE_SLAB     256
+
+
+/*--------------------------------------------------
+ * Private Type definitions
+ --------------------------------------------------*/
+
+/* The handle of an item.  It is allocated when the item joins a vector
+   and stays with the item while it moves in the array or to another
+   vector, Owner and Index say where the item is.  Up to Owner it is laid
+   out like the LinkNode of dlist.c, so Owner is where a LinkNode keeps
+   its ControlNodeLocation: each kind of list rejects the handles of the
+   other kind with DLIST_BAD_HANDLE.                                      */
+
+typedef struct VectorHandleRecord
+{
+  ADDRESS                       Unused;        /* DataLocation in a LinkNode. */
+  CARDINAL32                    UnusedSize;    /* DataSize in a LinkNode. */
+  TAG                           UnusedTag;     /* DataTag in a LinkNode. */
+  struct VectorControlRecord *  Owner;         /* The vector holding the item, NULL once it left. */
+  CARDINAL32                    Index;         /* The index of the item in Items of Owner. */
+  POOL                          HandlePool;    /* The pool this handle came from.  Handles move
+                                                  between vectors, so this is not always the pool
+                                                  of Owner.                                        */
+} VectorHandle;
+
+/* An item of the array.  Handle leads to the handle of the item, so its
+   index there can be updated when it moves.                            */
+
+typedef struct VectorItemRecord
+{
+  ADDRESS         DataLocation;
+  CARDINAL32      DataSize;
+  TAG             DataTag;
+  VectorHandle *  Handle;
+} VectorItem;
+
+typedef struct VectorControlRecord
+{
+  VectorItem *    Items;       /* Capacity items, of which GapStart up to GapEnd are the gap. */
+  CARDINAL32      Capacity;
+  CARDINAL32      GapStart;    /* The first index of the gap, the position of the item after it. */
+  CARDINAL32      GapEnd;      /* The index after the gap. */
+  VectorHandle *  Current;     /* The handle of the current item, NULL if the vector is empty. */
+  POOL            HandlePool;  /* The pool of handles for this vector. */
+} VectorControl;
+
+#define GapSize(VectorData)             ( (VectorData)->GapEnd - (VectorData)->GapStart )
+#define ItemCount(VectorData)           ( (VectorData)->Capacity - GapSize(VectorData) )
+
+/* The index in Items of the item at Position in the list, and back. */
+#define IndexOf(VectorData, Position)   ( ((Position) < (VectorData)->GapStart) ? (Position) : (Position) + GapSize(VectorData) )
+#define PositionOf(VectorData, Index)   ( ((Index) < (VectorData)->GapStart) ? (Index) : (Index) - GapSize(VectorData) )
+
+
+/*--------------------------------------------------
+ * Private Functions
+ --------------------------------------------------*/
+
+/*
+ * UpdateHandles( ) - point the handles of Count items that moved to Index
+ * at their new place
+ */
+static void UpdateHandles(VectorControl * VectorData, CARDINAL32 Index, CARDINAL32 Count)
+{
+  for ( ; Count > 0; Count--, Index++ )
+    VectorData->Items[Index].Handle->Index = Index;
+}
+
+/*
+ * MoveGap( ) - move the gap to Position, the items between its old and
+ * new place move across it
+ */
+static void MoveGap(VectorControl * VectorData, CARDINAL32 Position)
+{
+  VectorItem * Items = VectorData->Items;
+  CARDINAL32   Count;
+
+  /* Without a gap nothing moves. */
+  if ( GapSize(VectorData) == 0 )
+  {
+    VectorData->GapStart = Position;
+    VectorData->GapEnd = Position;
+    return;
+  }
+
+  if ( Position < VectorData->GapStart )
+  {
+
+    Count = VectorData->GapStart - Position;
+    VectorData->GapStart = Position;
+    VectorData->GapEnd -= Count;
+    memmove(&Items[VectorData->GapEnd], &Items[Position], Count * sizeof(VectorItem));
+    UpdateHandles(VectorData, VectorData->GapEnd, Count);
+
+  }
+  else if ( Position > VectorData->GapStart )
+  {
+
+    Count = Position - VectorData->GapStart;
+    memmove(&Items[VectorData->GapStart], &Items[VectorData->GapEnd], Count * sizeof(VectorItem));
+    UpdateHandles(VectorData, VectorData->GapStart, Count);
+    VectorData->GapStart = Position;
+    VectorData->GapEnd += Count;
+
+  }
+}
+
+/*
+ * GrowItems( ) - make the gap at least Count items, doubling the array.
+ * FALSE if out of memory, nothing changes then.
+ */
+static BOOLEAN GrowItems(VectorControl * VectorData, CARDINAL32 Count)
+{
+  VectorItem * Items;
+  CARDINAL32   Capacity;
+  CARDINAL32   Tail;
+
+  if ( GapSize(VectorData) >= Count )
+    return TRUE;
+
+  if ( Count > MAXIMUM_ITEMS - ItemCount(VectorData) )
+    return FALSE;
+
+  Capacity = ( VectorData->Capacity > 0 ) ? VectorData->Capacity : VECTOR_INITIAL_SIZE;
+  while ( Capacity - ItemCount(VectorData) < Count )
+    Capacity = ( Capacity > MAXIMUM_ITEMS / 2 ) ? MAXIMUM_ITEMS : Capacity * 2;
+
+  if ( (size_t) Capacity > ((size_t) -1) / sizeof(VectorItem) )
+    return FALSE;
+
+  Items = (VectorItem *) realloc(VectorData->Items, Capacity * sizeof(VectorItem));
+  if ( Items == NULL )
+    return FALSE;
+
+  /* The items after the gap go to the end of the new array. */
+  Tail = VectorData->Capacity - VectorData->GapEnd;
+  memmove(&Items[Capacity - Tail], &Items[VectorData->GapEnd], Tail * sizeof(VectorItem));
+
+  VectorData->Items = Items;
+  VectorData->Capacity = Capacity;
+  VectorData->GapEnd = Capacity - Tail;
+  UpdateHandles(VectorData, VectorData->GapEnd, Tail);
+
+  return TRUE;
+}
+
+/*
+ * NewHandle( ) - a handle for a new item of VectorData from its pool,
+ * NULL if out of memory
+ */
+static VectorHandle * NewHandle(VectorControl * VectorData)
+{
+  VectorHandle * Handle;
+
+  Handle = (VectorHandle *) AllocateFromPool(VectorData->HandlePool);
+
+  if ( Handle != NULL )
+  {
+    Handle->HandlePool = VectorData->HandlePool;
+    Handle->Unused = NULL;
+    Handle->UnusedSize = 0;
+    Handle->UnusedTag = 0;
+    Handle->Owner = VectorData;
+  }
+
+  return Handle;
+}
+
+/*
+ * FreeHandle( ) - release the handle of an item that left its vector
+ */
+static void FreeHandle(VectorHandle * Handle)
+{
+  Handle->Owner = NULL;
+
+  DeallocateToPool(Handle->HandlePool, Handle);
+}
+
+/*
+ * HandleOf( ) - the handle Handle of an item in VectorData, NULL if it is
+ * not one
+ */
+static VectorHandle * HandleOf(VectorControl * VectorData, ADDRESS Handle)
+{
+  if ( (Handle == NULL) || (((VectorHandle *) Handle)->Owner != VectorData) )
+    return NULL;
+
+  return (VectorHandle *) Handle;
+}
+
+/*
+ * FindItem( ) - the item of Handle, or the current item if Handle is NULL.
+ * NULL with *Error set if the vector is empty or Handle is bad.
+ */
+static VectorItem * FindItem(VectorControl * VectorData, ADDRESS Handle, CARDINAL32 * Error)
+{
+  VectorHandle * ItemHandle = VectorData->Current;
+
+  if ( ItemCount(VectorData) == 0 )
+  {
+    *Error = DLIST_EMPTY;
+    return NULL;
+  }
+
+  if ( Handle != NULL )
+  {
+
+    ItemHandle = HandleOf(VectorData, Handle);
+    if ( ItemHandle == NULL )
+    {
+      *Error = DLIST_BAD_HANDLE;
+      return NULL;
+    }
+
+  }
+
+  return &VectorData->Items[ItemHandle->Index];
+}
+
+/*
+ * CheckItem( ) - TRUE if Item has ItemTag and ItemSize, else FALSE with
+ * *Error set
+ */
+static BOOLEAN CheckItem(VectorItem * Item, CARDINAL32 ItemSize, TAG ItemTag, CARDINAL32 * Error)
+{
+  if ( Item->DataTag != ItemTag )
+  {
+    *Error = DLIST_ITEM_TAG_WRONG;
+    return FALSE;
+  }
+
+  if ( Item->DataSize != ItemSize )
+  {
+    *Error = DLIST_ITEM_SIZE_WRONG;
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/*
+ * PlaceItem( ) - put Item into the vector by Insert_Mode, next to the item
+ * of Target or at an end.  Target is NULL only for an empty vector, where
+ * the item becomes current.  The gap must have room for the item.
+ */
+static void PlaceItem(VectorControl *   VectorData,
+                      VectorItem *      Item,
+                      VectorHandle *    Target,
+                      Insertion_Modes   Insert_Mode,
+                      BOOLEAN           MakeCurrent)
+{
+  CARDINAL32 Position;
+
+  /* In an empty vector the mode does not matter, the item becomes current. */
+  if ( ItemCount(VectorData) == 0 )
+  {
+    Position = 0;
+    MakeCurrent = TRUE;
+  }
+  else
+  {
+
+    switch ( Insert_Mode )
+    {
+      case InsertAtStart: Position = 0;
+                          break;
+      case InsertBefore:  Position = PositionOf(VectorData, Target->Index);
+                          break;
+      case InsertAfter:   Position = PositionOf(VectorData, Target->Index) + 1;
+                          break;
+      default :           Position = ItemCount(VectorData);
+                          break;
+    }
+
+  }
+
+  MoveGap(VectorData, Position);
+
+  VectorData->Items[VectorData->GapStart] = *Item;
+  Item->Handle->Owner = VectorData;
+  Item->Handle->Index = VectorData->GapStart;
+  VectorData->GapStart++;
+
+  if ( MakeCurrent )
+    VectorData->Current = Item->Handle;
+}
+
+/*
+ * RemoveItem( ) - take the item at Index out of the vector, its handle is
+ * kept for the caller.  A current item that is removed passes to the next
+ * item, else the previous one.
+ */
+static void RemoveItem(VectorControl * VectorData, CARDINAL32 Index)
+{
+  CARDINAL32     Position = PositionOf(VectorData, Index);
+  VectorHandle * Handle = VectorData->Items[Index].Handle;
+
+  /* The item goes into the gap at its front. */
+  MoveGap(VectorData, Position);
+  VectorData->GapEnd++;
+
+  if ( VectorData->Current == Handle )
+  {
+
+    if ( VectorData->GapEnd < VectorData->Capacity )
+      VectorData->Current = VectorData->Items[VectorData->GapEnd].Handle;
+    else if ( VectorData->GapStart > 0 )
+      VectorData->Current = VectorData->Items[VectorData->GapStart - 1].Handle;
+    else
+      VectorData->Current = NULL;
+
+  }
+}
+
+/*
+ * StepCurrent( ) - make the item after (Forward) or before the current
+ * item current and return it, if it has ItemSize and ItemTag.  Else the
+ * current item stays and NULL is returned with *Error set.
+ */
+static VectorItem * StepCurrent(VectorControl * VectorData,
+                                CARDINAL32      ItemSize,
+                                TAG             ItemTag,
+                                BOOLEAN         Forward,
+                                CARDINAL32 *    Error)
+{
+  CARDINAL32   Position;
+  VectorItem * Item;
+
+  if ( ItemCount(VectorData) == 0 )
+  {
+    *Error = DLIST_EMPTY;
+    return NULL;
+  }
+
+  Position = PositionOf(VectorData, VectorData->Current->Index);
+
+  if ( Forward && (Position + 1 == ItemCount(VectorData)) )
+  {
+    *Error = DLIST_END_OF_LIST;
+    return NULL;
+  }
+
+  if ( !Forward && (Position == 0) )
+  {
+    *Error = DLIST_ALREADY_AT_START;
+    return NULL;
+  }
+
+  Position = Forward ? Position + 1 : Position - 1;
+  Item = &VectorData->Items[IndexOf(VectorData, Position)];
+
+  if ( !CheckItem(Item, ItemSize, ItemTag, Error) )
+    return NULL;
+
+  VectorData->Current = Item->Handle;
+  *Error = DLIST_SUCCESS;
+
+  return Item;
+}
+
+/*
+ * InsertionSort( ) - stable sort of Items[Start] up to Items[End] with
+ * Compare.  FALSE if Compare set *Error, the items are partly sorted then.
+ */
+static BOOLEAN InsertionSort(VectorItem * Items,
+                             CARDINAL32   Start,
+                             CARDINAL32   End,
+                             INTEGER32    (* _System Compare) (ADDRESS Object1, TAG Object1Tag, ADDRESS Object2, TAG Object2Tag,CARDINAL32 * Error),
+                             CARDINAL32 * Error)
+{
+  VectorItem  ItemToMove;
+  CARDINAL32  Right;
+  CARDINAL32  Position;
+  INTEGER32   CompareResult;
+
+  /* An item only moves past items greater than it. */
+  for ( Right = Start + 1; Right < End; Right++ )
+  {
+
+    ItemToMove = Items[Right];
+
+    for ( Position = Right; Position > Start; Position-- )
+    {
+
+      CompareResult = (*Compare)(Items[Position - 1].DataLocation,Items[Position - 1].DataTag,ItemToMove.DataLocation,ItemToMove.DataTag,Error);
+
+      if ( *Error != DLIST_SUCCESS )
+      {
+        Items[Position] = ItemToMove;
+        return FALSE;
+      }
+
+      if ( CompareResult <= 0 )
+        break;
+
+      Items[Position] = Items[Position - 1];
+
+    }
+
+    Items[Position] = ItemToMove;
+
+  }
+
+  return TRUE;
+}
+
+/*
+ * SortItems( ) - stable sort of Count items with Compare.  Runs of
+ * SORT_RUN items are sorted by insertion, then merged back and forth
+ * between Items and Scratch, which holds Count more.  Returns the array
+ * holding all items, sorted unless Compare set *Error.
+ */
+static VectorItem * SortItems(VectorItem * Items,
+                              VectorItem * Scratch,
+                              CARDINAL32   Count,
+                              INTEGER32    (* _System Compare) (ADDRESS Object1, TAG Object1Tag, ADDRESS Object2, TAG Object2Tag,CARDINAL32 * Error),
+                              CARDINAL32 * Error)
+{
+  VectorItem * Swap;
+  CARDINAL32   Start;
+  CARDINAL32   Middle;
+  CARDINAL32   End;
+  CARDINAL32   Left;
+  CARDINAL32   Right;
+  CARDINAL32   Position;
+  CARDINAL32   Width;
+  INTEGER32    CompareResult;
+
+  for ( Start = 0; Start < Count; Start += SORT_RUN )
+  {
+    End = ( Count - Start > SORT_RUN ) ? Start + SORT_RUN : Count;
+
+    if ( !InsertionSort(Items, Start, End, Compare, Error) )
+      return Items;
+  }
+
+  /* Merge pairs of runs of Width items from Items into Scratch, on a tie
+     the item of the left run goes first.  Items stays whole until the
+     pass is done, so a failed pass leaves it as the result.              */
+  for ( Width = SORT_RUN; Width < Count; Width *= 2 )
+  {
+    for ( Start = 0; Start < Count; Start += 2 * Width )
+    {
+      Middle = ( Count - Start > Width ) ? Start + Width : Count;
+      End = ( Count - Middle > Width ) ? Middle + Width : Count;
+
+      Left = Start;
+      Right = Middle;
+      Position = Start;
+
+      while ( (Left < Middle) && (Right < End) )
+      {
+        CompareResult = (*Compare)(Items[Left].DataLocation,Items[Left].DataTag,Items[Right].DataLocation,Items[Right].DataTag,Error);
+
+        if ( *Error != DLIST_SUCCESS )
+          return Items;
+
+        if ( CompareResult > 0 )
+          Scratch[Position++] = Items[Right++];
+        else
+          Scratch[Position++] = Items[Left++];
+      }
+
+      while ( Left < Middle )
+        Scratch[Position++] = Items[Left++];
+
+      while ( Right < End )
+        Scratch[Position++] = Items[Right++];
+    }
+
+    Swap = Items;
+    Items = Scratch;
+    Scratch = Swap;
+  }
+
+  return Items;
+}
+
+/*
+ * RadixSortItems( ) - stable LSD radix sort of Count items by their tags,
+ * one pass per byte that is not the same in all tags.  Scratch holds
+ * Count more.  Returns the array holding the result.
+ */
+static VectorItem * RadixSortItems(VectorItem * Items,
+                                   VectorItem * Scratch,
+                                   CARDINAL32   Count)
+{
+  CARDINAL32   Buckets[256];
+  CARDINAL32   Index;
+  CARDINAL32   Total;
+  CARDINAL32   Position;
+  CARDINAL32   Shift;
+  TAG          Differences = 0;
+  VectorItem * Swap;
+
+  /* The bits that are not the same in all tags. */
+  for ( Index = 1; Index < Count; Index++ )
+    Differences |= Items[Index].DataTag ^ Items[0].DataTag;
+
+  for ( Shift = 0; Shift < sizeof(TAG) * 8; Shift += 8 )
+  {
+    if ( ((Differences >> Shift) & 0xFF) == 0 )
+      continue;
+
+    memset(Buckets, 0, sizeof(Buckets));
+
+    for ( Index = 0; Index < Count; Index++ )
+      Buckets[(Items[Index].DataTag >> Shift) & 0xFF]++;
+
+    /* Turn the bucket sizes into the start of each bucket. */
+    Total = 0;
+    for ( Index = 0; Index < 256; Index++ )
+    {
+      Position = Buckets[Index];
+      Buckets[Index] = Total;
+      Total += Position;
+    }
+
+    for ( Index = 0; Index < Count; Index++ )
+      Scratch[Buckets[(Items[Index].DataTag >> Shift) & 0xFF]++] = Items[Index];
+
+    Swap = Items;
+    Items = Scratch;
+    Scratch = Swap;
+  }
+
+  return Items;
+}
+
+/*
+ * CompareTags( ) - the order of VectorSortListByTag as a Compare, for
+ * when the scratch array can not be allocated
+ */
+static INTEGER32 _System CompareTags(ADDRESS Object1, TAG Object1Tag, ADDRESS Object2, TAG Object2Tag, CARDINAL32 * Error)
+{
+  (void) Object1;
+  (void) Object2;
+
+  *Error = DLIST_SUCCESS;
+
+  if ( Object1Tag < Object2Tag )
+    return -1;
+
+  return ( Object1Tag > Object2Tag ) ? 1 : 0;
+}
+
+
+/*--------------------------------------------------
+ * Public Functions
+ --------------------------------------------------*/
+
+VECTOR _System CreateVector(CARDINAL32 InitialSize)
+{
+  VectorControl * VectorData;
+
+  VectorData = (VectorControl *) SmartMalloc(sizeof(VectorControl));
+  if ( VectorData == NULL )
+    return NULL;
+
+  VectorData->Items = NULL;
+  VectorData->Capacity = 0;
+  VectorData->GapStart = 0;
+  VectorData->GapEnd = 0;
+  VectorData->Current = NULL;
+
+  VectorData->HandlePool = CreatePool(sizeof(VectorHandle), 0, 0, HANDLE_SLAB, FALSE);
+  if ( VectorData->HandlePool == NULL )
+  {
+    SmartFree(VectorData);
+    return NULL;
+  }
+
+  if ( !ReserveVector(VectorData, ( InitialSize > 0 ) ? InitialSize : VECTOR_INITIAL_SIZE) )
+  {
+    DestroyVector(VectorData, FALSE);
+    return NULL;
+  }
+
+  return (VECTOR) VectorData;
+}
+
+void _System DestroyVector(VECTOR Vector, BOOLEAN FreeItemMemory)
+{
+  VectorControl * VectorData = (VectorControl *) Vector;
+  CARDINAL32      Error;
+
+  VectorDeleteAllItems(Vector, FreeItemMemory, &Error);
+
+  DestroyPool(VectorData->HandlePool);
+
+  free(VectorData->Items);
+  SmartFree(VectorData);
+}
+
+BOOLEAN _System ReserveVector(VECTOR Vector, CARDINAL32 Count)
+{
+  return GrowItems((VectorControl *) Vector, Count);
+}
+
+BOOLEAN _System CheckVector(VECTOR Vector)
+{
+  VectorControl * VectorData = (VectorControl *) Vector;
+  VectorHandle *  Handle;
+  CARDINAL32      Index;
+
+  if ( (VectorData->GapStart > VectorData->GapEnd) || (VectorData->GapEnd > VectorData->Capacity) )
+    return FALSE;
+
+  /* Every item has a handle that leads back to it. */
+  for ( Index = 0; Index < VectorData->Capacity; Index++ )
+  {
+
+    if ( Index == VectorData->GapStart )
+      Index = VectorData->GapEnd;
+
+    if ( Index == VectorData->Capacity )
+      break;
+
+    Handle = VectorData->Items[Index].Handle;
+    if ( (Handle == NULL) || (Handle->Owner != VectorData) || (Handle->Index != Index) )
+      return FALSE;
+
+  }
+
+  /* The current item is an item, unless there are none. */
+  if ( ItemCount(VectorData) == 0 )
+    return ( VectorData->Current == NULL );
+
+  Handle = VectorData->Current;
+  return ( Handle != NULL ) && (Handle->Owner == VectorData) && (Handle->Index < VectorData->Capacity) &&
+         (VectorData->Items[Handle->Index].Handle == Handle);
+}
+
+CARDINAL32 _System VectorSize(VECTOR Vector)
+{
+  return ItemCount((VectorControl *) Vector);
+}
+
+ADDRESS _System VectorInsertObject(VECTOR          Vector,
+                                   CARDINAL32      ItemSize,
+                                   ADDRESS         ItemLocation,
+                                   TAG             ItemTag,
+                                   ADDRESS         TargetHandle,
+                                   Insertion_Modes Insert_Mode,
+                                   BOOLEAN         MakeCurrent,
+                                   CARDINAL32 *    Error)
+{
+  VectorControl * VectorData = (VectorControl *) Vector;
+  VectorHandle *  Target = VectorData->Current;
+  VectorItem      Item;
+
+  if ( TargetHandle != NULL )
+  {
+
+    Target = HandleOf(VectorData, TargetHandle);
+    if ( Target == NULL )
+    {
+      *Error = DLIST_BAD_HANDLE;
+      return NULL;
+    }
+
+  }
+
+  if ( Insert_Mode > AppendToList )
+  {
+    *Error = DLIST_INVALID_INSERTION_MODE;
+    return NULL;
+  }
+
+  if ( ItemLocation == NULL )
+  {
+    *Error = DLIST_BAD_ITEM_POINTER;
+    return NULL;
+  }
+
+  if ( ItemSize == 0 )
+  {
+    *Error = DLIST_ITEM_SIZE_ZERO;
+    return NULL;
+  }
+
+  /* The array first, a grown array is no harm if there is no handle. */
+  if ( !GrowItems(VectorData, 1) )
+  {
+    *Error = DLIST_OUT_OF_MEMORY;
+    return NULL;
+  }
+
+  Item.Handle = NewHandle(VectorData);
+  if ( Item.Handle == NULL )
+  {
+    *Error = DLIST_OUT_OF_MEMORY;
+    return NULL;
+  }
+
+  Item.DataLocation = ItemLocation;
+  Item.DataSize = ItemSize;
+  Item.DataTag = ItemTag;
+  PlaceItem(VectorData, &Item, Target, Insert_Mode, MakeCurrent);
+
+  *Error = DLIST_SUCCESS;
+
+  return (ADDRESS) Item.Handle;
+}
+
+void _System VectorDeleteItem(VECTOR       Vector,
+                              BOOLEAN      FreeMemory,
+                              ADDRESS      Handle,
+                              CARDINAL32 * Error)
+{
+  VectorControl * VectorData = (VectorControl *) Vector;
+  VectorItem *    Item;
+  VectorHandle *  ItemHandle;
+
+  Item = FindItem(VectorData, Handle, Error);
+  if ( Item == NULL )
+    return;
+
+  if ( FreeMemory )
+    SmartFree(Item->DataLocation);
+
+  ItemHandle = Item->Handle;
+  RemoveItem(VectorData, (CARDINAL32) (Item - VectorData->Items));
+  FreeHandle(ItemHandle);
+
+  *Error = DLIST_SUCCESS;
+}
+
+void _System VectorDeleteAllItems(VECTOR       Vector,
+                                  BOOLEAN      FreeMemory,
+                                  CARDINAL32 * Error)
+{
+  VectorControl * VectorData = (VectorControl *) Vector;
+  CARDINAL32      Index;
+
+  MoveGap(VectorData, 0);
+
+  for ( Index = VectorData->GapEnd; Index < VectorData->Capacity; Index++ )
+  {
+    if ( FreeMemory )
+      SmartFree(VectorData->Items[Index].DataLocation);
+
+    FreeHandle(VectorData->Items[Index].Handle);
+  }
+
+  VectorData->GapEnd = VectorData->Capacity;
+  VectorData->Current = NULL;
+
+  *Error = DLIST_SUCCESS;
+}
+
+ADDRESS _System VectorGetObject(VECTOR       Vector,
+                                CARDINAL32   ItemSize,
+                                TAG          ItemTag,
+                                ADDRESS      Handle,
+                                BOOLEAN      MakeCurrent,
+                                CARDINAL32 * Error)
+{
+  VectorControl * VectorData = (VectorControl *) Vector;
+  VectorItem *    Item;
+
+  Item = FindItem(VectorData, Handle, Error);
+  if ( (Item == NULL) || !CheckItem(Item, ItemSize, ItemTag, Error) )
+    return NULL;
+
+  if ( MakeCurrent )
+    VectorData->Current = Item->Handle;
+
+  *Error = DLIST_SUCCESS;
+
+  return Item->DataLocation;
+}
+
+ADDRESS _System VectorGetNextObject(VECTOR       Vector,
+                                    CARDINAL32   ItemSize,
+                                    TAG          ItemTag,
+                                    CARDINAL32 * Error)
+{
+  VectorItem * Item = StepCurrent((VectorControl *) Vector, ItemSize, ItemTag, TRUE, Error);
+
+  return ( Item != NULL ) ? Item->DataLocation : NULL;
+}
+
+ADDRESS _System VectorGetPreviousObject(VECTOR       Vector,
+                                        CARDINAL32   ItemSize,
+                                        TAG          ItemTag,
+                                        CARDINAL32 * Error)
+{
+  VectorItem * Item = StepCurrent((VectorControl *) Vector, ItemSize, ItemTag, FALSE, Error);
+
+  return ( Item != NULL ) ? Item->DataLocation : NULL;
+}
+
+ADDRESS _System VectorExtractObject(VECTOR       Vector,
+                                    CARDINAL32   ItemSize,
+                                    TAG          ItemTag,
+                                    ADDRESS      Handle,
+                                    CARDINAL32 * Error)
+{
+  VectorControl * VectorData = (VectorControl *) Vector;
+  VectorItem *    Item;
+  VectorHandle *  ItemHandle;
+  ADDRESS         Object;
+
+  Item = FindItem(VectorData, Handle, Error);
+  if ( (Item == NULL) || !CheckItem(Item, ItemSize, ItemTag, Error) )
+    return NULL;
+
+  Object = Item->DataLocation;
+  ItemHandle = Item->Handle;
+  RemoveItem(VectorData, (CARDINAL32) (Item - VectorData->Items));
+  FreeHandle(ItemHandle);
+
+  *Error = DLIST_SUCCESS;
+
+  return Object;
+}
+
+void _System VectorReplaceItem(VECTOR       Vector,
+                               CARDINAL32   ItemSize,
+                               ADDRESS      ItemLocation,
+                               TAG          ItemTag,
+                               ADDRESS      Handle,
+                               BOOLEAN      MakeCurrent,
+                               CARDINAL32 * Error)
+{
+  VectorControl * VectorData = (VectorControl *) Vector;
+  VectorItem *    Item;
+  ADDRESS         NewData;
+
+  if ( ItemLocation == NULL )
+  {
+    *Error = DLIST_BAD_ITEM_POINTER;
+    return;
+  }
+
+  if ( ItemSize == 0 )
+  {
+    *Error = DLIST_ITEM_SIZE_ZERO;
+    return;
+  }
+
+  Item = FindItem(VectorData, Handle, Error);
+  if ( Item == NULL )
+    return;
+
+  /* The old memory is used again if the size is the same. */
+  if ( ItemSize != Item->DataSize )
+  {
+
+    NewData = SmartMalloc(ItemSize);
+    if ( NewData == NULL )
+    {
+      *Error = DLIST_OUT_OF_MEMORY;
+      return;
+    }
+
+    SmartFree(Item->DataLocation);
+    Item->DataLocation = NewData;
+
+  }
+
+  memcpy(Item->DataLocation, ItemLocation, ItemSize);
+  Item->DataSize = ItemSize;
+  Item->DataTag = ItemTag;
+
+  if ( MakeCurrent )
+    VectorData->Current = Item->Handle;
+
+  *Error = DLIST_SUCCESS;
+}
+
+ADDRESS _System VectorReplaceObject(VECTOR       Vector,
+                                    CARDINAL32 * ItemSize,
+                                    ADDRESS      ItemLocation,
+                                    TAG *        ItemTag,
+                                    ADDRESS      Handle,
+                                    BOOLEAN      MakeCurrent,
+                                    CARDINAL32 * Error)
+{
+  VectorControl * VectorData = (VectorControl *) Vector;
+  VectorItem      OldItem;
+  VectorItem *    Item;
+
+  if ( ItemLocation == NULL )
+  {
+    *Error = DLIST_BAD_ITEM_POINTER;
+    return NULL;
+  }
+
+  if ( *ItemSize == 0 )
+  {
+    *Error = DLIST_ITEM_SIZE_ZERO;
+    return NULL;
+  }
+
+  Item = FindItem(VectorData, Handle, Error);
+  if ( Item == NULL )
+    return NULL;
+
+  OldItem = *Item;
+
+  Item->DataLocation = ItemLocation;
+  Item->DataSize = *ItemSize;
+  Item->DataTag = *ItemTag;
+
+  *ItemSize = OldItem.DataSize;
+  *ItemTag = OldItem.DataTag;
+
+  if ( MakeCurrent )
+    VectorData->Current = Item->Handle;
+
+  *Error = DLIST_SUCCESS;
+
+  return OldItem.DataLocation;
+}
+
+TAG _System VectorGetTag(VECTOR       Vector,
+                         ADDRESS      Handle,
+                         CARDINAL32 * ItemSize,
+                         CARDINAL32 * Error)
+{
+  VectorItem * Item;
+
+  Item = FindItem((VectorControl *) Vector, Handle, Error);
+  if ( Item == NULL )
+    return 0;
+
+  *ItemSize = Item->DataSize;
+  *Error = DLIST_SUCCESS;
+
+  return Item->DataTag;
+}
+
+ADDRESS _System VectorGetHandle(VECTOR Vector, CARDINAL32 * Error)
+{
+  VectorControl * VectorData = (VectorControl *) Vector;
+
+  if ( ItemCount(VectorData) == 0 )
+  {
+    *Error = DLIST_EMPTY;
+    return NULL;
+  }
+
+  *Error = DLIST_SUCCESS;
+
+  return (ADDRESS) VectorData->Current;
+}
+
+BOOLEAN _System VectorAtEndOfList(VECTOR Vector)
+{
+  VectorControl * VectorData = (VectorControl *) Vector;
+
+  if ( ItemCount(VectorData) == 0 )
+    return TRUE;
+
+  return ( PositionOf(VectorData, VectorData->Current->Index) + 1 == ItemCount(VectorData) );
+}
+
+BOOLEAN _System VectorAtStartOfList(VECTOR Vector)
+{
+  VectorControl * VectorData = (VectorControl *) Vector;
+
+  if ( ItemCount(VectorData) == 0 )
+    return TRUE;
+
+  return ( PositionOf(VectorData, VectorData->Current->Index) == 0 );
+}
+
+void _System VectorNextItem(VECTOR Vector, CARDINAL32 * Error)
+{
+  VectorControl * VectorData = (VectorControl *) Vector;
+  CARDINAL32      Position;
+
+  if ( ItemCount(VectorData) == 0 )
+  {
+    *Error = DLIST_EMPTY;
+    return;
+  }
+
+  Position = PositionOf(VectorData, VectorData->Current->Index) + 1;
+  if ( Position == ItemCount(VectorData) )
+  {
+    *Error = DLIST_END_OF_LIST;
+    return;
+  }
+
+  VectorData->Current = VectorData->Items[IndexOf(VectorData, Position)].Handle;
+  *Error = DLIST_SUCCESS;
+}
+
+void _System VectorPreviousItem(VECTOR Vector, CARDINAL32 * Error)
+{
+  VectorControl * VectorData = (VectorControl *) Vector;
+  CARDINAL32      Position;
+
+  if ( ItemCount(VectorData) == 0 )
+  {
+    *Error = DLIST_EMPTY;
+    return;
+  }
+
+  Position = PositionOf(VectorData, VectorData->Current->Index);
+  if ( Position == 0 )
+  {
+    *Error = DLIST_ALREADY_AT_START;
+    return;
+  }
+
+  VectorData->Current = VectorData->Items[IndexOf(VectorData, Position - 1)].Handle;
+  *Error = DLIST_SUCCESS;
+}
+
+void _System VectorGoToStartOfList(VECTOR Vector)
+{
+  VectorControl * VectorData = (VectorControl *) Vector;
+
+  if ( ItemCount(VectorData) > 0 )
+    VectorData->Current = VectorData->Items[IndexOf(VectorData, 0)].Handle;
+}
+
+void _System VectorGoToEndOfList(VECTOR Vector)
+{
+  VectorControl * VectorData = (VectorControl *) Vector;
+
+  if ( ItemCount(VectorData) > 0 )
+    VectorData->Current = VectorData->Items[IndexOf(VectorData, ItemCount(VectorData) - 1)].Handle;
+}
+
+void _System VectorGoToSpecifiedItem(VECTOR       Vector,
+                                     ADDRESS      Handle,
+                                     CARDINAL32 * Error)
+{
+  VectorControl * VectorData = (VectorControl *) Vector;
+  VectorHandle *  ItemHandle = HandleOf(VectorData, Handle);
+
+  if ( ItemHandle == NULL )
+  {
+    *Error = DLIST_BAD_HANDLE;
+    return;
+  }
+
+  VectorData->Current = ItemHandle;
+  *Error = DLIST_SUCCESS;
+}
+
+void _System VectorSortList(VECTOR       Vector,
+                            INTEGER32    (* _System Compare) (ADDRESS Object1, TAG Object1Tag, ADDRESS Object2, TAG Object2Tag,CARDINAL32 * Error),
+                            CARDINAL32 * Error)
+{
+  VectorControl * VectorData = (VectorControl *) Vector;
+  VectorItem *    Scratch;
+  VectorItem *    Sorted;
+  CARDINAL32      Count = ItemCount(VectorData);
+
+  *Error = DLIST_SUCCESS;
+
+  if ( Count < 2 )
+    return;
+
+  /* With the gap at the end the items are one array. */
+  MoveGap(VectorData, Count);
+
+  Scratch = (VectorItem *) SmartMalloc(Count * sizeof(VectorItem));
+  if ( Scratch == NULL )
+    InsertionSort(VectorData->Items, 0, Count, Compare, Error);
+  else
+  {
+
+    Sorted = SortItems(VectorData->Items, Scratch, Count, Compare, Error);
+    if ( Sorted != VectorData->Items )
+      memcpy(VectorData->Items, Sorted, Count * sizeof(VectorItem));
+
+    SmartFree(Scratch);
+
+  }
+
+  /* Also after an error, the items may have moved. */
+  UpdateHandles(VectorData, 0, Count);
+}
+
+void _System VectorSortListByTag(VECTOR Vector, CARDINAL32 * Error)
+{
+  VectorControl * VectorData = (VectorControl *) Vector;
+  VectorItem *    Scratch;
+  VectorItem *    Sorted;
+  CARDINAL32      Count = ItemCount(VectorData);
+  CARDINAL32      Index;
+
+  *Error = DLIST_SUCCESS;
+
+  if ( Count < 2 )
+    return;
+
+  MoveGap(VectorData, Count);
+
+  /* A vector that is already in order is left as it is. */
+  for ( Index = 1; Index < Count; Index++ )
+  {
+    if ( VectorData->Items[Index - 1].DataTag > VectorData->Items[Index].DataTag )
+      break;
+  }
+
+  if ( Index == Count )
+    return;
+
+  Scratch = (VectorItem *) SmartMalloc(Count * sizeof(VectorItem));
+  if ( Scratch == NULL )
+    InsertionSort(VectorData->Items, 0, Count, &CompareTags, Error);
+  else
+  {
+
+    Sorted = RadixSortItems(VectorData->Items, Scratch, Count);
+    if ( Sorted != VectorData->Items )
+      memcpy(VectorData->Items, Sorted, Count * sizeof(VectorItem));
+
+    SmartFree(Scratch);
+
+  }
+
+  UpdateHandles(VectorData, 0, Count);
+}
+
+void _System VectorForEachItem(VECTOR       Vector,
+                               void         (* _System ProcessItem) (ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, ADDRESS ObjectHandle, ADDRESS Parameters, CARDINAL32 * Error),
+                               ADDRESS      Parameters,
+                               BOOLEAN      Forward,
+                               CARDINAL32 * Error)
+{
+  VectorControl * VectorData = (VectorControl *) Vector;
+  VectorItem *    Item;
+  CARDINAL32      Count = ItemCount(VectorData);
+  CARDINAL32      Step;
+
+  *Error = DLIST_SUCCESS;
+
+  for ( Step = 0; Step < Count; Step++ )
+  {
+
+    Item = &VectorData->Items[IndexOf(VectorData, Forward ? Step : Count - 1 - Step)];
+
+    (*ProcessItem)(Item->DataLocation, Item->DataTag, Item->DataSize, (ADDRESS) Item->Handle, Parameters, Error);
+    if ( *Error != DLIST_SUCCESS )
+    {
+
+      if ( *Error == DLIST_SEARCH_COMPLETE )
+        *Error = DLIST_SUCCESS;
+
+      return;
+
+    }
+
+  }
+}
+
+void _System VectorFindItemsByTag(VECTOR       Vector,
+                                  TAG          ItemTag,
+                                  void         (* _System ProcessItem) (ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, ADDRESS ObjectHandle, ADDRESS Parameters, CARDINAL32 * Error),
+                                  ADDRESS      Parameters,
+                                  CARDINAL32 * Error)
+{
+  VectorControl * VectorData = (VectorControl *) Vector;
+  VectorItem *    Item;
+  CARDINAL32      Position;
+
+  *Error = DLIST_SUCCESS;
+
+  for ( Position = 0; Position < ItemCount(VectorData); Position++ )
+  {
+
+    Item = &VectorData->Items[IndexOf(VectorData, Position)];
+    if ( Item->DataTag != ItemTag )
+      continue;
+
+    (*ProcessItem)(Item->DataLocation, Item->DataTag, Item->DataSize, (ADDRESS) Item->Handle, Parameters, Error);
+    if ( *Error != DLIST_SUCCESS )
+    {
+
+      if ( *Error == DLIST_SEARCH_COMPLETE )
+        *Error = DLIST_SUCCESS;
+
+      return;
+
+    }
+
+  }
+}
+
+void _System VectorPruneList(VECTOR       Vector,
+                             BOOLEAN      (* _System KillItem) (ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, ADDRESS ObjectHandle, ADDRESS Parameters, BOOLEAN * FreeMemory, CARDINAL32 * Error),
+                             ADDRESS      Parameters,
+                             CARDINAL32 * Error)
+{
+  VectorControl * VectorData = (VectorControl *) Vector;
+  VectorItem *    Items;
+  CARDINAL32      Count = ItemCount(VectorData);
+  CARDINAL32      Read;
+  CARDINAL32      Write = 0;
+  BOOLEAN         FreeMemory;
+  BOOLEAN         Done = FALSE;
+  BOOLEAN         CurrentDeleted = FALSE;
+
+  *Error = DLIST_SUCCESS;
+
+  /* With the gap at the end, kept items move down over deleted ones. */
+  MoveGap(VectorData, Count);
+  Items = VectorData->Items;
+
+  for ( Read = 0; Read < Count; Read++ )
+  {
+
+    if ( !Done && (*KillItem)(Items[Read].DataLocation, Items[Read].DataTag, Items[Read].DataSize, (ADDRESS) Items[Read].Handle, Parameters, &FreeMemory, Error) )
+    {
+
+      /* An error keeps the item and ends the walk. */
+      if ( (*Error != DLIST_SUCCESS) && (*Error != DLIST_SEARCH_COMPLETE) )
+        Done = TRUE;
+      else
+      {
+
+        if ( FreeMemory )
+          SmartFree(Items[Read].DataLocation);
+
+        if ( VectorData->Current == Items[Read].Handle )
+          CurrentDeleted = TRUE;
+
+        FreeHandle(Items[Read].Handle);
+
+        if ( *Error == DLIST_SEARCH_COMPLETE )
+        {
+          *Error = DLIST_SUCCESS;
+          Done = TRUE;
+        }
+
+        continue;
+
+      }
+
+    }
+    else if ( !Done && (*Error != DLIST_SUCCESS) )
+    {
+
+      if ( *Error == DLIST_SEARCH_COMPLETE )
+        *Error = DLIST_SUCCESS;
+
+      Done = TRUE;
+
+    }
+
+    if ( Write != Read )
+    {
+      Items[Write] = Items[Read];
+      Items[Write].Handle->Index = Write;
+    }
+
+    /* A deleted current item passes to the next item that is kept. */
+    if ( CurrentDeleted )
+    {
+      VectorData->Current = Items[Write].Handle;
+      CurrentDeleted = FALSE;
+    }
+
+    Write++;
+
+  }
+
+  VectorData->GapStart = Write;
+
+  /* Else to the item before it. */
+  if ( CurrentDeleted )
+    VectorData->Current = ( Write > 0 ) ? Items[Write - 1].Handle : NULL;
+}
+
+void _System VectorTransferItem(VECTOR            Source,
+                                ADDRESS           SourceHandle,
+                                VECTOR            Target,
+                                ADDRESS           TargetHandle,
+                                Insertion_Modes   TransferMode,
+                                BOOLEAN           MakeCurrent,
+                                CARDINAL32 *      Error)
+{
+  VectorControl * SourceData = (VectorControl *) Source;
+  VectorControl * TargetData = (VectorControl *) Target;
+  VectorHandle *  TargetItem = TargetData->Current;
+  VectorItem *    SourceItem;
+  VectorItem      Item;
+
+  *Error = DLIST_SUCCESS;
+
+  if ( ItemCount(SourceData) == 0 )
+    return;
+
+  if ( TargetHandle != NULL )
+  {
+
+    TargetItem = HandleOf(TargetData, TargetHandle);
+    if ( TargetItem == NULL )
+    {
+      *Error = DLIST_BAD_HANDLE;
+      return;
+    }
+
+  }
+
+  /* Before the item is found, growing may move the array of Source. */
+  if ( !GrowItems(TargetData, 1) )
+  {
+    *Error = DLIST_OUT_OF_MEMORY;
+    return;
+  }
+
+  SourceItem = FindItem(SourceData, SourceHandle, Error);
+  if ( SourceItem == NULL )
+    return;
+
+  /* An item placed next to itself stays where it is. */
+  if ( TargetItem == SourceItem->Handle )
+  {
+    if ( MakeCurrent )
+      TargetData->Current = TargetItem;
+
+    return;
+  }
+
+  /* The handle goes with the item, it is only valid in Target then. */
+  Item = *SourceItem;
+  RemoveItem(SourceData, (CARDINAL32) (SourceItem - SourceData->Items));
+
+  /* Target may have become empty if it is Source. */
+  if ( ItemCount(TargetData) == 0 )
+    TargetItem = NULL;
+
+  PlaceItem(TargetData, &Item, TargetItem, TransferMode, MakeCurrent);
+}
+
+void _System VectorAppendVector(VECTOR       Target,
+                                VECTOR       Source,
+                                CARDINAL32 * Error)
+{
+  VectorControl * TargetData = (VectorControl *) Target;
+  VectorControl * SourceData = (VectorControl *) Source;
+  CARDINAL32      Count = ItemCount(SourceData);
+  CARDINAL32      Index;
+
+  *Error = DLIST_SUCCESS;
+
+  if ( (TargetData == SourceData) || (Count == 0) )
+    return;
+
+  /* The only allocation, nothing has moved if it fails. */
+  if ( !GrowItems(TargetData, Count) )
+  {
+    *Error = DLIST_OUT_OF_MEMORY;
+    return;
+  }
+
+  /* An empty target takes over the current item of the source. */
+  if ( ItemCount(TargetData) == 0 )
+    TargetData->Current = SourceData->Current;
+
+  MoveGap(SourceData, Count);
+  MoveGap(TargetData, ItemCount(TargetData));
+  memcpy(&TargetData->Items[TargetData->GapStart], SourceData->Items, Count * sizeof(VectorItem));
+
+  /* The handles go with their items. */
+  for ( Index = TargetData->GapStart; Index < TargetData->GapStart + Count; Index++ )
+  {
+    TargetData->Items[Index].Handle->Owner = TargetData;
+    TargetData->Items[Index].Handle->Index = Index;
+  }
+
+  TargetData->GapStart += Count;
+
+  SourceData->GapStart = 0;
+  SourceData->Current = NULL;
+}
@@ -0,0 +1,451 @@
+/*
+*
+*   This program is free software;  you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 2 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY;  without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+*   the GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program;  if not, write to the Free Software
+*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+*/
+
+/*
+* Functions: VECTOR      CreateVector
+*            void        DestroyVector
+*            BOOLEAN     ReserveVector
+*            BOOLEAN     CheckVector
+*            CARDINAL32  VectorSize
+*            ADDRESS     VectorInsertObject
+*            void        VectorDeleteItem
+*            void        VectorDeleteAllItems
+*            ADDRESS     VectorGetObject
+*            ADDRESS     VectorGetNextObject
+*            ADDRESS     VectorGetPreviousObject
+*            ADDRESS     VectorExtractObject
+*            void        VectorReplaceItem
+*            ADDRESS     VectorReplaceObject
+*            TAG         VectorGetTag
+*            ADDRESS     VectorGetHandle
+*            BOOLEAN     VectorAtEndOfList
+*            BOOLEAN     VectorAtStartOfList
+*            void        VectorNextItem
+*            void        VectorPreviousItem
+*            void        VectorGoToStartOfList
+*            void        VectorGoToEndOfList
+*            void        VectorGoToSpecifiedItem
+*            void        VectorSortList
+*            void        VectorSortListByTag
+*            void        VectorForEachItem
+*            void        VectorFindItemsByTag
+*            void        VectorPruneList
+*            void        VectorTransferItem
+*            void        VectorAppendVector
+*
+* Description:  The items of a list made by CreateVectorList.  Instead of
+*               a LinkNode per item, a vector keeps the location, size and
+*               tag of all items in one array with a gap in it, the gap
+*               buffer.  Items before the gap are at their position in the
+*               list, items after it are moved up by the size of the gap.
+*               An insert or delete moves the gap to its position first,
+*               so appending and walking the list touch the array in order
+*               and cost no allocation until the array is full.
+*
+*               Items move in the array, so handles can not be their
+*               addresses.  A handle is a small record allocated with the
+*               item, which holds the vector the item is in and its index
+*               in the array, and is updated whenever the item moves.  It
+*               stays with the item when the item moves to another vector,
+*               and it is released when the item is deleted.  A handle is
+*               only accepted by the vector that holds its item, and a
+*               LinkNode, which has its list where a handle has its
+*               vector, is never accepted.
+*
+* Notes:  dlist calls these functions for vector lists after it checked
+*         the DLIST itself, they do what the DLIST function of the same
+*         name does.  See dlist.h for the parameters and errors, only the
+*         differences are noted here.  Handles are always checked, not
+*         only in DEBUG builds.
+*
+*         Items are SmartMalloc memory like the items of other lists, see
+*         poolman.h.  Handles come from a pool of the vector in every
+*         build, not just USE_POOLMAN, a malloc per handle would double
+*         the cost of building a vector.  Building is still somewhat
+*         slower than a linked list, a handle costs as much as a LinkNode
+*         and the array is copied when it grows, walking and sorting are
+*         faster.  A vector is single threaded like the DLIST that owns
+*         it.
+*
+*/
+
+#ifndef DVECTOR_H_INCLUDED
+
+#define DVECTOR_H_INCLUDED  1
+
+#include "dlist.h"
+
+typedef ADDRESS VECTOR;
+
+#define VECTOR_INITIAL_SIZE   16     /* Default items in the first array. */
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  CreateVector                                    */
+/*                                                                   */
+/*   Descriptive Name: Creates an empty vector.                      */
+/*                                                                   */
+/*   Input: CARDINAL32 InitialSize - Items the first array holds, 0  */
+/*                                   for VECTOR_INITIAL_SIZE.        */
+/*                                                                   */
+/*   Output: If Success : The function return value will be non-NULL */
+/*                                                                   */
+/*           If Failure : The function return value will be NULL.    */
+/*                                                                   */
+/*   Error Handling:  Fails only if memory can not be allocated.     */
+/*                                                                   */
+/*   Side Effects:  None.                                            */
+/*                                                                   */
+/*   Notes:  None.                                                   */
+/*                                                                   */
+/*********************************************************************/
+VECTOR _System CreateVector(CARDINAL32 InitialSize);
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  DestroyVector                                   */
+/*                                                                   */
+/*   Descriptive Name: Releases a vector, and its items if           */
+/*                     FreeItemMemory is TRUE.                       */
+/*                                                                   */
+/*   Notes:  The DestroyList of a vector list.                       */
+/*                                                                   */
+/*********************************************************************/
+void _System DestroyVector(VECTOR Vector, BOOLEAN FreeItemMemory);
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  ReserveVector                                   */
+/*                                                                   */
+/*   Descriptive Name: Makes room for Count more items, so that the  */
+/*                     next Count inserts do not grow the array.     */
+/*                                                                   */
+/*   Notes:  Inserts still allocate a handle each.                   */
+/*                                                                   */
+/*   Output: FALSE if the memory can not be allocated, the vector is */
+/*           unchanged then.                                         */
+/*                                                                   */
+/*********************************************************************/
+BOOLEAN _System ReserveVector(VECTOR Vector, CARDINAL32 Count);
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  CheckVector                                     */
+/*                                                                   */
+/*   Descriptive Name: The CheckListIntegrity of a vector list: the  */
+/*                     gap, the handles and the current item must    */
+/*                     agree.                                        */
+/*                                                                   */
+/*********************************************************************/
+BOOLEAN _System CheckVector(VECTOR Vector);
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  VectorSize                                      */
+/*                                                                   */
+/*   Descriptive Name: The number of items in the vector, for        */
+/*                     GetListSize and ListEmpty.                    */
+/*                                                                   */
+/*********************************************************************/
+CARDINAL32 _System VectorSize(VECTOR Vector);
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  VectorInsertObject                              */
+/*                                                                   */
+/*   Notes:  InsertObject.  InsertItem copies the item first and     */
+/*           inserts the copy with this.                             */
+/*                                                                   */
+/*********************************************************************/
+ADDRESS _System VectorInsertObject(VECTOR          Vector,
+                                   CARDINAL32      ItemSize,
+                                   ADDRESS         ItemLocation,
+                                   TAG             ItemTag,
+                                   ADDRESS         TargetHandle,
+                                   Insertion_Modes Insert_Mode,
+                                   BOOLEAN         MakeCurrent,
+                                   CARDINAL32 *    Error);
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  VectorDeleteItem                                */
+/*                                                                   */
+/*********************************************************************/
+void _System VectorDeleteItem(VECTOR       Vector,
+                              BOOLEAN      FreeMemory,
+                              ADDRESS      Handle,
+                              CARDINAL32 * Error);
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  VectorDeleteAllItems                            */
+/*                                                                   */
+/*   Notes:  The array keeps its size for the next items.            */
+/*                                                                   */
+/*********************************************************************/
+void _System VectorDeleteAllItems(VECTOR       Vector,
+                                  BOOLEAN      FreeMemory,
+                                  CARDINAL32 * Error);
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  VectorGetObject                                 */
+/*                                                                   */
+/*   Notes:  GetObject, and GetItem with a memcpy of the result.     */
+/*                                                                   */
+/*********************************************************************/
+ADDRESS _System VectorGetObject(VECTOR       Vector,
+                                CARDINAL32   ItemSize,
+                                TAG          ItemTag,
+                                ADDRESS      Handle,
+                                BOOLEAN      MakeCurrent,
+                                CARDINAL32 * Error);
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  VectorGetNextObject                             */
+/*                                                                   */
+/*   Notes:  GetNextObject, and GetNextItem with a memcpy of the     */
+/*           result.                                                 */
+/*                                                                   */
+/*********************************************************************/
+ADDRESS _System VectorGetNextObject(VECTOR       Vector,
+                                    CARDINAL32   ItemSize,
+                                    TAG          ItemTag,
+                                    CARDINAL32 * Error);
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  VectorGetPreviousObject                         */
+/*                                                                   */
+/*   Notes:  GetPreviousObject, and GetPreviousItem with a memcpy of */
+/*           the result.                                             */
+/*                                                                   */
+/*********************************************************************/
+ADDRESS _System VectorGetPreviousObject(VECTOR       Vector,
+                                        CARDINAL32   ItemSize,
+                                        TAG          ItemTag,
+                                        CARDINAL32 * Error);
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  VectorExtractObject                             */
+/*                                                                   */
+/*   Notes:  ExtractObject, and ExtractItem with a memcpy and a      */
+/*           SmartFree of the result.                                */
+/*                                                                   */
+/*********************************************************************/
+ADDRESS _System VectorExtractObject(VECTOR       Vector,
+                                    CARDINAL32   ItemSize,
+                                    TAG          ItemTag,
+                                    ADDRESS      Handle,
+                                    CARDINAL32 * Error);
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  VectorReplaceItem                               */
+/*                                                                   */
+/*********************************************************************/
+void _System VectorReplaceItem(VECTOR       Vector,
+                               CARDINAL32   ItemSize,
+                               ADDRESS      ItemLocation,
+                               TAG          ItemTag,
+                               ADDRESS      Handle,
+                               BOOLEAN      MakeCurrent,
+                               CARDINAL32 * Error);
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  VectorReplaceObject                             */
+/*                                                                   */
+/*********************************************************************/
+ADDRESS _System VectorReplaceObject(VECTOR       Vector,
+                                    CARDINAL32 * ItemSize,
+                                    ADDRESS      ItemLocation,
+                                    TAG *        ItemTag,
+                                    ADDRESS      Handle,
+                                    BOOLEAN      MakeCurrent,
+                                    CARDINAL32 * Error);
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  VectorGetTag                                    */
+/*                                                                   */
+/*********************************************************************/
+TAG _System VectorGetTag(VECTOR       Vector,
+                         ADDRESS      Handle,
+                         CARDINAL32 * ItemSize,
+                         CARDINAL32 * Error);
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  VectorGetHandle                                 */
+/*                                                                   */
+/*********************************************************************/
+ADDRESS _System VectorGetHandle(VECTOR Vector, CARDINAL32 * Error);
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  VectorAtEndOfList                               */
+/*                                                                   */
+/*   Notes:  TRUE for an empty vector, like AtEndOfList.             */
+/*                                                                   */
+/*********************************************************************/
+BOOLEAN _System VectorAtEndOfList(VECTOR Vector);
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  VectorAtStartOfList                             */
+/*                                                                   */
+/*   Notes:  TRUE for an empty vector, like AtStartOfList.           */
+/*                                                                   */
+/*********************************************************************/
+BOOLEAN _System VectorAtStartOfList(VECTOR Vector);
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  VectorNextItem                                  */
+/*                                                                   */
+/*********************************************************************/
+void _System VectorNextItem(VECTOR Vector, CARDINAL32 * Error);
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  VectorPreviousItem                              */
+/*                                                                   */
+/*********************************************************************/
+void _System VectorPreviousItem(VECTOR Vector, CARDINAL32 * Error);
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  VectorGoToStartOfList                           */
+/*                                                                   */
+/*********************************************************************/
+void _System VectorGoToStartOfList(VECTOR Vector);
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  VectorGoToEndOfList                             */
+/*                                                                   */
+/*********************************************************************/
+void _System VectorGoToEndOfList(VECTOR Vector);
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  VectorGoToSpecifiedItem                         */
+/*                                                                   */
+/*********************************************************************/
+void _System VectorGoToSpecifiedItem(VECTOR       Vector,
+                                     ADDRESS      Handle,
+                                     CARDINAL32 * Error);
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  VectorSortList                                  */
+/*                                                                   */
+/*   Notes:  The array is merge sorted as it is, with a scratch      */
+/*           array of the same size.  If that can not be allocated,  */
+/*           the array is sorted by insertion.  The handles are      */
+/*           updated after the sort, they stay with their items.     */
+/*                                                                   */
+/*********************************************************************/
+void _System VectorSortList(VECTOR       Vector,
+                            INTEGER32    (* _System Compare) (ADDRESS Object1, TAG Object1Tag, ADDRESS Object2, TAG Object2Tag,CARDINAL32 * Error),
+                            CARDINAL32 * Error);
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  VectorSortListByTag                             */
+/*                                                                   */
+/*   Notes:  Radix sorted like SortListByTag, with the same fallback */
+/*           as VectorSortList.                                      */
+/*                                                                   */
+/*********************************************************************/
+void _System VectorSortListByTag(VECTOR Vector, CARDINAL32 * Error);
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  VectorForEachItem                               */
+/*                                                                   */
+/*********************************************************************/
+void _System VectorForEachItem(VECTOR       Vector,
+                               void         (* _System ProcessItem) (ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, ADDRESS ObjectHandle, ADDRESS Parameters, CARDINAL32 * Error),
+                               ADDRESS      Parameters,
+                               BOOLEAN      Forward,
+                               CARDINAL32 * Error);
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  VectorFindItemsByTag                            */
+/*                                                                   */
+/*   Notes:  A vector has no tag index, the whole array is searched  */
+/*           in list order.                                          */
+/*                                                                   */
+/*********************************************************************/
+void _System VectorFindItemsByTag(VECTOR       Vector,
+                                  TAG          ItemTag,
+                                  void         (* _System ProcessItem) (ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, ADDRESS ObjectHandle, ADDRESS Parameters, CARDINAL32 * Error),
+                                  ADDRESS      Parameters,
+                                  CARDINAL32 * Error);
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  VectorPruneList                                 */
+/*                                                                   */
+/*   Notes:  The items that are kept are moved down over the deleted */
+/*           ones in one pass, whatever the number of deletes.       */
+/*                                                                   */
+/*********************************************************************/
+void _System VectorPruneList(VECTOR       Vector,
+                             BOOLEAN      (* _System KillItem) (ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, ADDRESS ObjectHandle, ADDRESS Parameters, BOOLEAN * FreeMemory, CARDINAL32 * Error),
+                             ADDRESS      Parameters,
+                             CARDINAL32 * Error);
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  VectorTransferItem                              */
+/*                                                                   */
+/*   Notes:  TransferItem between two vector lists, or in one.  The  */
+/*           handle of the item stays valid, in Target.  Target is   */
+/*           grown before the item leaves Source, so it stays there  */
+/*           if memory runs out.                                     */
+/*                                                                   */
+/*********************************************************************/
+void _System VectorTransferItem(VECTOR            Source,
+                                ADDRESS           SourceHandle,
+                                VECTOR            Target,
+                                ADDRESS           TargetHandle,
+                                Insertion_Modes   TransferMode,
+                                BOOLEAN           MakeCurrent,
+                                CARDINAL32 *      Error);
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  VectorAppendVector                              */
+/*                                                                   */
+/*   Notes:  AppendList of two vector lists.  Target is grown for    */
+/*           all items of Source first, so either all items move or, */
+/*           if memory runs out, none.  The handles of the items     */
+/*           stay valid, in Target.                                  */
+/*                                                                   */
+/*********************************************************************/
+void _System VectorAppendVector(VECTOR       Target,
+                                VECTOR       Source,
+                                CARDINAL32 * Error);
+
+#endif
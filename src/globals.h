@@ -32,6 +32,13 @@
 
 #define LVM_GLBS_H_INCLUDED 1
 
+/* _System is the OS/2 system linkage, other platforms only have one */
+#if defined(__unix__) || defined(__APPLE__)
+#ifndef _System
+#define _System
+#endif
+#endif
+
 /* An INTEGER number is a whole number, either + or -.
 The number appended to the INTEGER key word indicates the number of bits
 used to represent an INTEGER of that type.                               */
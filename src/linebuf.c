@@ -0,0 +1,257 @@
+/****************************************************************************
+ *
+ *  linebuf.c -- Make Message File Utilities
+ *
+ *  ========================================================================
+ *
+ *  Description: Whole file line reader shared by the MKMSGF parsers
+ *               (message source, INC/H include files and @ control
+ *               files).
+ *
+ *               On systems with mmap the file is mapped read only, on
+ *               OS/2 it is read into one buffer with a single read.
+ *               Lines are found with memchr, which the C libraries
+ *               implement as a word/vector wide scan, so there is no
+ *               per byte stdio and no per line heap traffic.
+ *
+ *  ========================================================================
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#include <sys/mman.h>
+#define LINEBUF_MMAP
+#else
+#include <io.h>
+#endif
+#include "linebuf.h"
+#include "mkmsgerr.h"
+
+#ifndef O_BINARY
+#define O_BINARY 0
+#endif
+
+#define LINEBUF_STDIN (64 * 1024)
+
+/*
+ * linebufstdin( )
+ *
+ * "-" is stdin, read to the end into a buffer that doubles as it
+ * fills, a pipe has no size to map or allocate up front
+ */
+static int linebufstdin(LINEBUF *lb)
+{
+    uint32_t alloc = LINEBUF_STDIN;
+    char *grow = NULL;
+    long rd = 0;
+
+#if !defined(__unix__) && !defined(__APPLE__)
+    setmode(0, O_BINARY);
+#endif
+
+    lb->data = (char *)malloc(alloc);
+    if (lb->data == NULL)
+        return (MKMSG_MEM_ERROR1);
+
+    while ((rd = read(0, lb->data + lb->size, alloc - lb->size)) > 0)
+    {
+        lb->size += rd;
+        if (lb->size < alloc)
+            continue;
+
+        if (alloc > 0x3FFFFFFFUL)
+        {
+            LineBufClose(lb);
+            return (MKMSG_READ_ERROR);
+        }
+
+        grow = (char *)realloc(lb->data, alloc * 2);
+        if (grow == NULL)
+        {
+            LineBufClose(lb);
+            return (MKMSG_MEM_ERROR1);
+        }
+        lb->data = grow;
+        alloc *= 2;
+    }
+
+    if (rd < 0)
+    {
+        LineBufClose(lb);
+        return (MKMSG_READ_ERROR);
+    }
+
+    lb->pos = lb->data;
+
+    return (MKMSG_NOERROR);
+}
+
+/*************************************************************************
+ * Function:  LineBufOpen( )
+ *
+ * Make the whole of filename available in memory
+ *
+ * 0 "-" is stdin, read in full (linebufstdin)
+ * 1 Open the file and get its size
+ * 2 Map it, if mapping is not available or fails read it in one go
+ *
+ * Return:    returns error code or 0 for all good
+ *************************************************************************/
+
+int LineBufOpen(LINEBUF *lb, const char *filename)
+{
+    struct stat st;
+    int fd = -1;
+    long got = 0;
+
+    memset(lb, 0, sizeof(LINEBUF));
+
+    if (strcmp(filename, "-") == 0)
+        return (linebufstdin(lb));
+
+    fd = open(filename, O_RDONLY | O_BINARY);
+    if (fd == -1)
+        return (MKMSG_OPEN_ERROR);
+
+    if (fstat(fd, &st) != 0 || st.st_size < 0 || st.st_size > 0x7FFFFFFFL)
+    {
+        close(fd);
+        return (MKMSG_READ_ERROR);
+    }
+
+    lb->size = (uint32_t)st.st_size;
+
+#ifdef LINEBUF_MMAP
+    if (lb->size)
+    {
+        void *map = mmap(NULL, lb->size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map != MAP_FAILED)
+        {
+            lb->data = (char *)map;
+            lb->pos = lb->data;
+            lb->mapped = 1;
+            close(fd);
+            return (MKMSG_NOERROR);
+        }
+    }
+#endif
+
+    // +1 so an empty file still gets a valid pointer
+    lb->data = (char *)malloc(lb->size + 1);
+    if (lb->data == NULL)
+    {
+        close(fd);
+        return (MKMSG_MEM_ERROR1);
+    }
+
+    while ((uint32_t)got < lb->size)
+    {
+        long rd = read(fd, lb->data + got, lb->size - got);
+        if (rd <= 0)
+        {
+            close(fd);
+            LineBufClose(lb);
+            return (MKMSG_READ_ERROR);
+        }
+        got += rd;
+    }
+
+    close(fd);
+    lb->pos = lb->data;
+
+    return (MKMSG_NOERROR);
+}
+
+/*
+ * LineBufClose( )
+ *
+ * unmap or free the file memory
+ */
+void LineBufClose(LINEBUF *lb)
+{
+#ifdef LINEBUF_MMAP
+    if (lb->mapped)
+        munmap(lb->data, lb->size);
+    else
+#endif
+        free(lb->data);
+
+    memset(lb, 0, sizeof(LINEBUF));
+}
+
+/*
+ * LineBufEOL( )
+ *
+ * return start of the line following line, or end if line is the
+ * last line of the buffer
+ */
+char *LineBufEOL(char *line, char *end)
+{
+    char *eol = (char *)memchr(line, 0x0A, end - line);
+
+    return (eol ? eol + 1 : end);
+}
+
+/*
+ * LineBufNext( )
+ *
+ * iterate the lines of lb, NULL when all lines were returned
+ */
+char *LineBufNext(LINEBUF *lb, char **next)
+{
+    char *line = lb->pos;
+    char *end = lb->data + lb->size;
+
+    if (line == NULL || line >= end)
+        return (NULL);
+
+    lb->pos = LineBufEOL(line, end);
+    *next = lb->pos;
+
+    return (line);
+}
+
+/*
+ * LineBufCopy( )
+ *
+ * for parsers that need a C string (sscanf, strtok) - copy one line
+ * into a caller buffer, usually on the stack
+ */
+uint32_t LineBufCopy(char *line, char *next, char *dest, uint32_t destsize)
+{
+    uint32_t len = 0;
+
+    if (next > line && next[-1] == 0x0A)
+        next--;
+    if (next > line && next[-1] == 0x0D)
+        next--;
+
+    len = next - line;
+    if (len >= destsize)
+        len = destsize - 1;
+
+    memcpy(dest, line, len);
+    dest[len] = 0x00;
+
+    return (len);
+}
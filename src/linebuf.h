@@ -0,0 +1,63 @@
+/****************************************************************************
+ *
+ *  linebuf.h -- Make Message File Utilities
+ *
+ *  ========================================================================
+ *
+ *  Description: Whole file line reader. The input file is mapped (or
+ *               read with one read) into memory and handed out as line
+ *               views into that memory, nothing is copied per line.
+ *
+ *  ========================================================================
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ ***************************************************************************/
+
+#ifndef LINEBUF_H
+#define LINEBUF_H
+
+#include <stdint.h>
+
+// Input file in memory. data is read only and NOT 0x00 terminated,
+// lines are always handled as start/end pairs.
+typedef struct _LINEBUF
+{
+    char *data;     // file contents
+    uint32_t size;  // size of data in bytes
+    char *pos;      // start of the next line LineBufNext returns
+    uint8_t mapped; // 1 = data is a file mapping, 0 = data is malloc'ed
+} LINEBUF;
+
+// Map / read filename into lb, "-" reads stdin to the end. Returns
+// MKMSG error code or 0.
+int LineBufOpen(LINEBUF *lb, const char *filename);
+
+// Release the memory of lb, safe to call on a zeroed or closed LINEBUF.
+void LineBufClose(LINEBUF *lb);
+
+// Return start of the line after line (one past its 0x0A), or end if
+// line is the last line in [line, end).
+char *LineBufEOL(char *line, char *end);
+
+// Return the next line of lb and set *next to the start of the line
+// after it, NULL at end of file. The line includes its 0x0D 0x0A.
+char *LineBufNext(LINEBUF *lb, char **next);
+
+// Copy the line [line, next) without 0x0D 0x0A into dest as a 0x00
+// terminated string, truncated to destsize - 1 chars. Returns length.
+uint32_t LineBufCopy(char *line, char *next, char *dest, uint32_t destsize);
+
+#endif
@@ -34,22 +34,27 @@
 
 #define INCL_DOSNLS /* National Language Support values */
 
-#include <os2.h>
 #include <stdio.h>
+#include <stdarg.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
-#include <io.h>
-#include <sys\stat.h>
-#include <unistd.h>
-#include <malloc.h>
+#include "compat.h"
 #include "mkmsgf.h"
 #include "mkmsgerr.h"
 #include "version.h"
-
-int readheader(MESSAGEINFO *messageinfo);
-int readmessages(MESSAGEINFO *messageinfo);
-int outputheader(MESSAGEINFO *messageinfo);
+#include "msgapi.h"
+#include "outbuf.h"
+#include "workpool.h"
+
+int readheader(MESSAGEINFO *messageinfo, MSGFILE *mf);
+int readmessages(MESSAGEINFO *messageinfo, MSGFILE *mf, OUTBUF *out);
+int writemessage(MESSAGEINFO *messageinfo, MSGFILE *mf, OUTBUF *out,
+                 unsigned long current_msg, unsigned long last_message);
+int parseranges(char *list);
+int outputheader(MESSAGEINFO *messageinfo, OUTBUF *out);
+int parselanguage(char *arg);
+void displayblocks(MESSAGEINFO *messageinfo, MSGFILE *mf);
 
 // ouput display/helper functions
 void usagelong(void);
@@ -58,6 +63,80 @@ void helpshort(void);
 void helplong(void);
 void ProgError(int exnum, char *dispmsg);
 void displayinfo(MESSAGEINFO *messageinfo);
+void msgprintf(OUTBUF *log, const char *format, ...);
+
+// one file of a batch, see runbatch( )
+typedef struct _DECJOB
+{
+    MESSAGEINFO info; // per file names and header info
+    OUTBUF log;       // everything the job displays
+    char *errmsg;     // what failed
+    int rc;           // job return code
+    uint8_t done;     // job finished
+} DECJOB;
+
+typedef struct _DECBATCH
+{
+    DECJOB *jobs;
+    int count;      // number of jobs
+    int alloc;      // jobs allocated
+    int printed;    // jobs with their log printed, in order
+} DECBATCH;
+
+int decompile(MESSAGEINFO *messageinfo, int showinfo, char **errmsg);
+int isdirectory(char *name);
+int addjob(DECBATCH *batch, MESSAGEINFO *opts, char *infile, char *outdir);
+int addinput(DECBATCH *batch, MESSAGEINFO *opts, char *arg, char *outdir);
+void freebatch(DECBATCH *batch);
+void runjob(void *context, int index);
+void reportjob(DECJOB *job);
+void jobdone(void *context, int index);
+int runbatch(DECBATCH *batch, int threads);
+
+// -i header inventory output
+#define INV_CSV     1
+#define INV_JSON    2
+
+typedef struct _INVENTORY
+{
+    OUTBUF out;     // records, to stdout
+    int format;     // INV_CSV or INV_JSON
+    int count;      // records written
+    int failed;     // files that could not be read
+    int rc;         // error code of the first of them
+} INVENTORY;
+
+int invfield(INVENTORY *inv, const char *text, int len);
+int inventoryfile(INVENTORY *inv, char *filename);
+int ismsgfile(char *name);
+int inventorypath(INVENTORY *inv, char *path);
+int inventory(int format, int argc, char *argv[]);
+
+// -d message level compare
+int diffvalue(char *name, unsigned long oldval, unsigned long newval);
+int diffheader(MESSAGEINFO *oldinfo, MESSAGEINFO *newinfo);
+int diffmsgfiles(char *oldfile, char *newfile);
+
+// display output, stderr when the decompile goes to stdout
+static FILE *screen;
+
+// -m message selection, set up before any decompile and read only after
+typedef struct _MSGRANGE
+{
+    uint32_t first;
+    uint32_t last;
+} MSGRANGE;
+
+static MSGRANGE *ranges = NULL;
+static int rangecount = 0;
+
+// -l language of a multi language file, family 0 = the main language
+static uint16_t selfamily = 0;
+static uint16_t selversion = 0;
+static uint16_t selcodepage = 0;
+
+// output is written out in pieces of this size
+#define MKMSGD_OUTBUF (64 * 1024)
 
 /*************************************************************************
  * Main( )
@@ -65,7 +144,17 @@ void displayinfo(MESSAGEINFO *messageinfo);
  * Entry into the program
  *
  * Expects a valid MSG file only. Will name the output file using the input
- * file and the TXT extention if an output filename is not provided.
+ * file and the TXT extention if an output filename is not provided, an
+ * output filename of - writes to stdout. An input filename of - reads
+ * the MSG file from stdin, the output then defaults to stdout.
+ *
+ * More than two files, wildcards, a directory, -o or -j decompile a batch
+ * of files, each to <outdir>/<name>.txt, see runbatch( ).
+ *
+ * -i csv | json lists the headers of the files instead, see inventory( ).
+ * -d old.msg new.msg lists the messages that differ, see diffmsgfiles( ).
+ * -l family[,sub[,codepage]] decompiles that language of a multi
+ * language file (mkmsgf /X).
  *
  **********************************/
 
@@ -73,8 +162,18 @@ int main(int argc, char *argv[])
 {
     int rc = 0; // return code
     int ch = 0; // getopt variable
+    int threads = 1;       // -j N
+    int invformat = 0;     // -i csv | json
+    uint8_t diff = 0;      // -d old.msg new.msg
+    char *outdir = NULL;   // -o batch output directory
+    char *errmsg = NULL;   // decompile error text
+    uint8_t batch = 0;     // 1= batch of files
+    DECBATCH files;        // batch input files
 
     MESSAGEINFO messageinfo;     // holds all the info
+    memset(&messageinfo, 0, sizeof(MESSAGEINFO));
+    screen = stdout;
+
     messageinfo.verbose = 0;     // start being quiet
     messageinfo.fixlastline = 0; // try to fix last line problems
 
@@ -87,7 +186,7 @@ int main(int argc, char *argv[])
     }
 
     // Get program arguments using getopt()
-    while ((ch = getopt(argc, argv, "vVfh")) != -1)
+    while ((ch = getopt(argc, argv, "vVfhdi:j:l:m:o:")) != -1)
     {
         switch (ch)
         {
@@ -109,116 +208,938 @@ int main(int argc, char *argv[])
             exit(MKMSG_NOERROR);
             break;
 
+        case 'd':
+            diff = 1;
+            break;
+
+        case 'i':
+            if (!strcmp(optarg, "csv"))
+                invformat = INV_CSV;
+            else if (!strcmp(optarg, "json"))
+                invformat = INV_JSON;
+            else
+                ProgError(MKMSG_GETOPT_ERROR, "MKMSGD: -i needs csv or json");
+            break;
+
+        case 'j':
+            threads = atoi(optarg);
+            if (threads < 1 || threads > WORKPOOL_MAX)
+                ProgError(MKMSG_GETOPT_ERROR, "MKMSGD: -j needs 1 to 64 threads");
+            batch = (threads > 1);
+            break;
+
+        case 'l':
+            if (parselanguage(optarg) != MKMSG_NOERROR)
+                ProgError(MKMSG_GETOPT_ERROR, "MKMSGD: -l needs family[,sub[,codepage]]");
+            break;
+
+        case 'm':
+            rc = parseranges(optarg);
+            if (rc == MKMSG_MEM_ERROR1)
+                ProgError(rc, "MKMSGD: Out of memory");
+            if (rc != MKMSG_NOERROR)
+                ProgError(rc, "MKMSGD: Bad -m message list");
+            break;
+
+        case 'o':
+            outdir = optarg;
+            batch = 1;
+            break;
+
         default:
             ProgError(MKMSG_GETOPT_ERROR, "MKMSGD: Syntax error unknown option");
             break;
         }
     }
 
-    if (optind == 1 || optind == 2)
+    if (optind == argc)
     {
-        // optind 1 should be input file
-        strncpy(messageinfo.infile, argv[optind], strlen(argv[optind]));
+        prgheading(); // display program heading
+        helpshort();
+        exit(MKMSG_NOERROR);
+    }
 
-        if (access(messageinfo.infile, F_OK) != 0)
-            ProgError(MKMSG_INPUT_ERROR, "MKMSGD: Input file does not exist.");
+    // compare two MSG files
+    if (diff)
+    {
+        if (argc - optind != 2)
+            ProgError(MKMSG_GETOPT_ERROR, "MKMSGD: -d needs old.msg and new.msg");
+        return (diffmsgfiles(argv[optind], argv[optind + 1]));
+    }
 
-        _splitpath(messageinfo.infile,
-                   messageinfo.indrive,
-                   messageinfo.indir,
-                   messageinfo.infname,
-                   messageinfo.inext);
+    // header inventory only, the records go to stdout
+    if (invformat)
+    {
+        screen = stderr;
+        return (inventory(invformat, argc - optind, argv + optind));
+    }
 
-        optind++;
+    // anything more than infile [outfile] is a batch
+    if (argc - optind > 2)
+        batch = 1;
+    for (int x = optind; x < argc && !batch; x++)
+        batch = (strpbrk(argv[x], "*?") != NULL || isdirectory(argv[x]));
 
-        if (optind != argc)
-            // provide output file
-            strncpy(messageinfo.outfile, argv[optind], strlen(argv[optind]));
-        else
-            // need to make an output file
-            sprintf(messageinfo.outfile, "%s%s", messageinfo.infname, ".txt");
-    }
-    else
+    if (batch)
     {
-        prgheading(); // display program heading
-        helpshort();
-        exit(MKMSG_NOERROR);
+        memset(&files, 0, sizeof(DECBATCH));
+
+        for (int x = optind; x < argc; x++)
+        {
+            rc = addinput(&files, &messageinfo, argv[x], outdir ? outdir : ".");
+            if (rc == MKMSG_MEM_ERROR1)
+                ProgError(rc, "MKMSGD: Out of memory");
+            if (rc != MKMSG_NOERROR)
+                fprintf(screen, "MKMSGD: %s: no MSG files found\n", argv[x]);
+        }
+
+        if (files.count == 0)
+            ProgError(MKMSG_INPUT_ERROR, "MKMSGD: No input files");
+
+        rc = runbatch(&files, threads);
+
+        freebatch(&files);
+
+        return (rc);
     }
 
-    // check input == output file
-    if (!strcmp(messageinfo.infile, messageinfo.outfile))
+    // optind should be input file
+    strncpy(messageinfo.infile, argv[optind], sizeof(messageinfo.infile) - 1);
+
+    // - is stdin
+    if (strcmp(messageinfo.infile, "-") != 0 && access(messageinfo.infile, F_OK) != 0)
+        ProgError(MKMSG_INPUT_ERROR, "MKMSGD: Input file does not exist.");
+
+    _splitpath(messageinfo.infile,
+               messageinfo.indrive,
+               messageinfo.indir,
+               messageinfo.infname,
+               messageinfo.inext);
+
+    optind++;
+
+    if (optind != argc)
+        // provide output file
+        strncpy(messageinfo.outfile, argv[optind], sizeof(messageinfo.outfile) - 1);
+    else if (!strcmp(messageinfo.infile, "-"))
+        // stdin in, stdout out
+        strcpy(messageinfo.outfile, "-");
+    else
+        // need to make an output file
+        sprintf(messageinfo.outfile, "%s%s", messageinfo.infname, ".txt");
+
+    // check input == output file, stdin to stdout is fine
+    if (!strcmp(messageinfo.infile, messageinfo.outfile) && strcmp(messageinfo.infile, "-"))
         ProgError(MKMSG_IN_OUT_COMPARE, "MKMSGD: Input file same as output file");
 
+    // decompile to stdout, keep the screen output out of the pipe
+    if (!strcmp(messageinfo.outfile, "-"))
+        screen = stderr;
+
     // ************ done with args ************
 
+    rc = decompile(&messageinfo, 1, &errmsg);
+    if (rc != MKMSG_NOERROR)
+        ProgError(rc, errmsg);
+
+    // if you don't see this then I screwed up
+    fprintf(screen, "\nEnd Decompile\n");
+
+    return (MKMSG_NOERROR);
+}
+
+/*************************************************************************
+ * Function:  decompile( )
+ *
+ * Decompile one MSG file, messageinfo has the file names and options.
+ * Display output goes to messageinfo->log (NULL = screen).
+ *
+ * 1 Map the input file, with -l switch to the language block, and read
+ *   the header
+ * 2 Display info if showinfo
+ * 3 Open the output once, header and messages stream through it
+ * 4 Close up, a write error shows up at the latest here
+ *
+ * Return:    returns error code or 0 for all good, *errmsg says what
+ *            failed
+ *************************************************************************/
+
+int decompile(MESSAGEINFO *messageinfo, int showinfo, char **errmsg)
+{
+    MSGFILE file; // mapped input file
+    MSGFILE mf;   // language being decompiled
+    OUTBUF out;   // decompiled output stream
+    int rc = 0;
+    int closerc = 0;
+
+    // map the input file
+    rc = MsgFileOpen(&file, messageinfo->infile);
+    if (rc != MKMSG_NOERROR)
+    {
+        *errmsg = "MKMSGD: MSG Header read error";
+        return (rc);
+    }
+
+    // the main language is the file itself
+    if (selfamily)
+        rc = MsgFileSelect(&file, selfamily, selversion, selcodepage, &mf);
+    else
+        rc = MsgFileMem(&mf, file.file.data, file.file.size);
+    if (rc != MKMSG_NOERROR)
+    {
+        MsgFileClose(&file);
+        *errmsg = (rc == MKMSG_MSG_NOT_FOUND) ? "MKMSGD: No such language in MSG file"
+                                              : "MKMSGD: MSG Header read error";
+        return (rc);
+    }
+
     // decompile header
-    rc = readheader(&messageinfo);
+    rc = readheader(messageinfo, &mf);
     if (rc != MKMSG_NOERROR)
-        ProgError(rc, "MKMSGD: MSG Header read error");
+    {
+        MsgFileClose(&mf);
+        MsgFileClose(&file);
+        *errmsg = "MKMSGD: MSG Header read error";
+        return (rc);
+    }
 
     // display info on screen
-    displayinfo(&messageinfo);
+    if (showinfo)
+    {
+        displayinfo(messageinfo);
+        displayblocks(messageinfo, &file);
+    }
 
-    // write out header
-    rc = outputheader(&messageinfo);
+    // open the output once, header and messages stream through it
+    rc = OutBufOpen(&out, messageinfo->outfile, MKMSGD_OUTBUF);
     if (rc != MKMSG_NOERROR)
-        ProgError(rc, "MKMSGD: Error generating header");
+    {
+        MsgFileClose(&mf);
+        MsgFileClose(&file);
+        *errmsg = "MKMSGD: Output file open error";
+        return (rc);
+    }
 
-    // decompile the messages and write
-    rc = readmessages(&messageinfo);
+    // write out header
+    rc = outputheader(messageinfo, &out);
     if (rc != MKMSG_NOERROR)
-        ProgError(rc, "MKMSGD: Error read MSG messages");
+        *errmsg = "MKMSGD: Error generating header";
 
-    // if you don't see this then I screwed up
-    printf("\nEnd Decompile\n");
+    // decompile the messages
+    if (rc == MKMSG_NOERROR)
+    {
+        rc = readmessages(messageinfo, &mf, &out);
+        if (rc != MKMSG_NOERROR)
+            *errmsg = "MKMSGD: Error read MSG messages";
+    }
+
+    // write out the rest
+    closerc = OutBufClose(&out);
+    if (rc == MKMSG_NOERROR && closerc != MKMSG_NOERROR)
+    {
+        rc = closerc;
+        *errmsg = "MKMSGD: Output file write error";
+    }
+
+    MsgFileClose(&mf);
+    MsgFileClose(&file);
+
+    return (rc);
+}
+
+/*
+ * isdirectory( ) - 1 if name is an existing directory
+ */
+int isdirectory(char *name)
+{
+    struct stat st;
+
+    return (stat(name, &st) == 0 && S_ISDIR(st.st_mode));
+}
+
+/*
+ * addjob( ) - add infile to the batch, output goes to outdir
+ */
+int addjob(DECBATCH *batch, MESSAGEINFO *opts, char *infile, char *outdir)
+{
+    DECJOB *job = NULL;
+
+    if (batch->count == batch->alloc)
+    {
+        int alloc = batch->alloc ? batch->alloc * 2 : 64;
+
+        job = (DECJOB *)realloc(batch->jobs, alloc * sizeof(DECJOB));
+        if (job == NULL)
+            return (MKMSG_MEM_ERROR1);
+
+        batch->jobs = job;
+        batch->alloc = alloc;
+    }
+
+    job = &batch->jobs[batch->count++];
+    memset(job, 0, sizeof(DECJOB));
+
+    // options are the same for all files, the rest is per file
+    job->info.verbose = opts->verbose;
+    job->info.fixlastline = opts->fixlastline;
+
+    strncpy(job->info.infile, infile, sizeof(job->info.infile) - 1);
+    _splitpath(job->info.infile,
+               job->info.indrive,
+               job->info.indir,
+               job->info.infname,
+               job->info.inext);
+    snprintf(job->info.outfile, sizeof(job->info.outfile), "%s%s%s%s",
+             outdir, PATH_SEP_STR, job->info.infname, ".txt");
+
+    // two jobs must not write the same file, the later one fails
+    for (int x = 0; x < batch->count - 1; x++)
+    {
+        if (!strcmp(batch->jobs[x].info.outfile, job->info.outfile))
+        {
+            job->rc = MKMSG_IN_OUT_COMPARE;
+            job->errmsg = "MKMSGD: Output file already used in this batch";
+        }
+    }
+    if (!strcmp(job->info.infile, job->info.outfile))
+    {
+        job->rc = MKMSG_IN_OUT_COMPARE;
+        job->errmsg = "MKMSGD: Input file same as output file";
+    }
 
     return (MKMSG_NOERROR);
 }
 
+static int jobcompare(const void *a, const void *b)
+{
+    return (strcmp(((DECJOB *)a)->info.infile, ((DECJOB *)b)->info.infile));
+}
+
 /*************************************************************************
- * Function:  readheader( )
+ * Function:  addinput( )
  *
- * Reads in all the MSG file info and stores in MESSAGEINFO structure
+ * Add one command line input to the batch
  *
- * 1. Read in the MSG file header
- * 2. Check for valid signature
- * 3. Transfer header info into MESSAGEINFO structure
- * 4. Read in FILECOUNTRYINFO block into MESSAGEINFO structure
- * 5. Check for extention block and read if exists
- * 6. Calculate message start
- * 7. Calculate index offset and size
+ * 1 A directory means all *.msg files in it
+ * 2 A name with wildcards is searched, the found names get the
+ *   directory of the pattern. The matches are sorted so the order does
+ *   not depend on the directory order.
+ * 3 Anything else is taken as a file name
  *
  * Return:    returns error code or 0 for all good
  *************************************************************************/
 
-int readheader(MESSAGEINFO *messageinfo)
+int addinput(DECBATCH *batch, MESSAGEINFO *opts, char *arg, char *outdir)
 {
-    MSGHEADER *msgheader = NULL;
-    FILECOUNTRYINFO *cpheader = NULL;
-    EXTHDR *extheader = NULL;
+    char pattern[_MAX_PATH];
+    char filename[_MAX_PATH];
+    char drive[_MAX_DRIVE];
+    char dir[_MAX_DIR];
+    struct _finddata_t c_file;
+    long hFile;
+    int first = batch->count;
+    int rc = 0;
+
+    if (isdirectory(arg))
+        snprintf(pattern, sizeof(pattern), "%s%s*.msg", arg, PATH_SEP_STR);
+    else if (strpbrk(arg, "*?") != NULL)
+        snprintf(pattern, sizeof(pattern), "%s", arg);
+    else
+        return (addjob(batch, opts, arg, outdir));
+
+    _splitpath(pattern, drive, dir, NULL, NULL);
+
+    if ((hFile = _findfirst(pattern, &c_file)) == -1L)
+        return (MKMSG_INPUT_ERROR);
+
+    do
+    {
+        snprintf(filename, sizeof(filename), "%s%s%s", drive, dir, c_file.name);
+        rc = addjob(batch, opts, filename, outdir);
+    } while (rc == MKMSG_NOERROR && _findnext(hFile, &c_file) == 0);
+
+    _findclose(hFile);
+
+    qsort(batch->jobs + first, batch->count - first, sizeof(DECJOB), jobcompare);
+
+    return (rc);
+}
+
+void freebatch(DECBATCH *batch)
+{
+    for (int x = 0; x < batch->count; x++)
+        OutBufFree(&batch->jobs[x].log);
+    free(batch->jobs);
+    memset(batch, 0, sizeof(DECBATCH));
+}
+
+/*
+ * runjob( ) - WorkPoolRun job, decompile one file of the batch. The
+ * display output collects in the job log.
+ */
+void runjob(void *context, int index)
+{
+    DECJOB *job = &((DECBATCH *)context)->jobs[index];
+
+    job->info.log = &job->log;
+    if (job->rc == MKMSG_NOERROR)
+        job->rc = decompile(&job->info, job->info.verbose, &job->errmsg);
+    reportjob(job);
+}
+
+/*
+ * reportjob( ) - one line per file, the error if it failed
+ */
+void reportjob(DECJOB *job)
+{
+    if (job->rc != MKMSG_NOERROR)
+        msgprintf(job->info.log, "%s: %s (%d)\n", job->info.infile, job->errmsg, job->rc);
+    else
+        msgprintf(job->info.log, "%s -> %s  %d messages\n",
+                  job->info.infile, job->info.outfile, job->info.numbermsg);
+}
+
+/*
+ * jobdone( ) - WorkPoolRun done callback, runs under the pool lock.
+ * Print all finished job logs that are next in batch order.
+ */
+void jobdone(void *context, int index)
+{
+    DECBATCH *batch = (DECBATCH *)context;
+    DECJOB *job = NULL;
+
+    batch->jobs[index].done = 1;
+
+    while (batch->printed < batch->count && batch->jobs[batch->printed].done)
+    {
+        job = &batch->jobs[batch->printed++];
+        fwrite(job->log.data, sizeof(char), job->log.size, screen);
+        fflush(screen);
+        OutBufFree(&job->log);
+    }
+}
+
+/*************************************************************************
+ * Function:  runbatch( )
+ *
+ * Decompile all files of a batch, a failed file does not stop the rest
+ *
+ * 1 1 thread: decompile in order, output goes straight to the screen
+ *   N threads: decompile on the worker pool, each file has its own
+ *   MESSAGEINFO and log, the logs are printed in order
+ * 2 Show the count of files and failures
+ *
+ * Return:    error code of the first file that failed or 0
+ *************************************************************************/
+
+int runbatch(DECBATCH *batch, int threads)
+{
+    DECJOB *job = NULL;
+    int failed = 0;
+    int rc = 0;
+
+    if (threads <= 1)
+    {
+        for (int x = 0; x < batch->count; x++)
+        {
+            job = &batch->jobs[x];
+            if (job->rc == MKMSG_NOERROR)
+                job->rc = decompile(&job->info, job->info.verbose, &job->errmsg);
+            reportjob(job);
+        }
+    }
+    else
+        WorkPoolRun(threads, batch->count, runjob, jobdone, batch);
+
+    for (int x = 0; x < batch->count; x++)
+    {
+        if (batch->jobs[x].rc == MKMSG_NOERROR)
+            continue;
+        if (!failed++)
+            rc = batch->jobs[x].rc;
+    }
+
+    fprintf(screen, "\n%d files decompiled, %d failed\n", batch->count - failed, failed);
+
+    return (rc);
+}
 
-    // open input file
-    FILE *fp = fopen(messageinfo->infile, "rb");
-    if (fp == NULL)
-        return (MKMSG_OPEN_ERROR);
+/*
+ * invfield( ) - one text field of an inventory record, quoted and
+ * escaped for the output format
+ */
+int invfield(INVENTORY *inv, const char *text, int len)
+{
+    char esc[8];
+    int rc = 0;
+
+    if (inv->format == INV_CSV && strcspn(text, ",\"\r\n") >= (size_t)len)
+        return (OutBufAppend(&inv->out, text, len));
+
+    rc = OutBufAppend(&inv->out, "\"", 1);
+
+    for (int x = 0; x < len && rc == MKMSG_NOERROR; x++)
+    {
+        uint8_t c = (uint8_t)text[x];
+
+        if (c == '"')
+            rc = OutBufAppend(&inv->out, inv->format == INV_CSV ? "\"\"" : "\\\"", 2);
+        else if (inv->format == INV_JSON && c == '\\')
+            rc = OutBufAppend(&inv->out, "\\\\", 2);
+        else if (inv->format == INV_JSON && c < 0x20)
+        {
+            sprintf(esc, "\\u%04X", c);
+            rc = OutBufAppend(&inv->out, esc, 6);
+        }
+        else
+            rc = OutBufAppend(&inv->out, (char *)&c, 1);
+    }
+
+    if (rc == MKMSG_NOERROR)
+        rc = OutBufAppend(&inv->out, "\"", 1);
+
+    return (rc);
+}
+
+/*************************************************************************
+ * Function:  inventoryfile( )
+ *
+ * Write the inventory record of one MSG file, only the header and the
+ * country info block are read (MsgFileScan). A file that can not be
+ * read is reported on the screen and left out.
+ *
+ * Return:    returns error code or 0 for all good
+ *************************************************************************/
+
+int inventoryfile(INVENTORY *inv, char *filename)
+{
+    MSGSCAN scan;
+    char ident[4];
+    int rc = 0;
+
+    rc = MsgFileScan(filename, &scan);
+    if (rc != MKMSG_NOERROR)
+    {
+        fprintf(screen, "MKMSGD: %s: MSG Header read error (%d)\n", filename, rc);
+        if (!inv->failed++)
+            inv->rc = rc;
+        return (MKMSG_NOERROR);
+    }
+
+    memcpy(ident, scan.header.identifier, 3);
+    ident[3] = 0x00;
+
+    if (inv->format == INV_JSON)
+    {
+        rc = OutBufPrintf(&inv->out, "%s{\"file\": ", inv->count ? ",\n" : "");
+        if (rc == MKMSG_NOERROR)
+            rc = invfield(inv, filename, strlen(filename));
+        if (rc == MKMSG_NOERROR)
+            rc = OutBufPrintf(&inv->out, ", \"identifier\": ");
+        if (rc == MKMSG_NOERROR)
+            rc = invfield(inv, ident, strlen(ident));
+        if (rc == MKMSG_NOERROR)
+            rc = OutBufPrintf(&inv->out, ", \"messages\": %u, \"firstmsg\": %u, "
+                              "\"version\": %u, \"indexwidth\": %u, \"codepages\": [",
+                              scan.header.numbermsg, scan.header.firstmsg,
+                              scan.header.version, scan.header.offset16bit ? 16 : 32);
+    }
+    else
+    {
+        rc = invfield(inv, filename, strlen(filename));
+        if (rc == MKMSG_NOERROR)
+            rc = OutBufAppend(&inv->out, ",", 1);
+        if (rc == MKMSG_NOERROR)
+            rc = invfield(inv, ident, strlen(ident));
+        if (rc == MKMSG_NOERROR)
+            rc = OutBufPrintf(&inv->out, ",%u,%u,%u,%u,",
+                              scan.header.numbermsg, scan.header.firstmsg,
+                              scan.header.version, scan.header.offset16bit ? 16 : 32);
+    }
+
+    for (int x = 0; x < scan.country.codepagesnumber && x < 16 && rc == MKMSG_NOERROR; x++)
+        rc = OutBufPrintf(&inv->out, "%s%u", x ? (inv->format == INV_JSON ? ", " : " ") : "",
+                          scan.country.codepages[x]);
 
-    // buffer to read in header
-    char *header = (char *)calloc(sizeof(MSGHEADER), sizeof(char));
-    if (header == NULL)
-        return (MKMSG_MEM_ERROR1);
+    if (rc == MKMSG_NOERROR)
+        rc = OutBufPrintf(&inv->out, inv->format == INV_JSON ? "]}" : "\n");
 
-    // read header
-    int read = fread(header, sizeof(char), sizeof(MSGHEADER), fp);
-    if (ferror(fp))
-        return (MKMSG_READ_ERROR);
+    inv->count++;
 
-    // MSGHEADER point to header buffer
-    msgheader = (MSGHEADER *)header;
+    return (rc);
+}
 
-    // check header signature, return error no match
-    for (int x = 0; x < sizeof(signature); x++)
-        if (signature[x] != msgheader->magic_sig[x])
-            return (MKMSG_HEADER_ERROR);
+/*
+ * ismsgfile( ) - 1 if name ends in .msg, any case
+ */
+int ismsgfile(char *name)
+{
+    size_t len = strlen(name);
+
+    return (len > 4 && name[len - 4] == '.' &&
+            tolower(name[len - 3]) == 'm' &&
+            tolower(name[len - 2]) == 's' &&
+            tolower(name[len - 1]) == 'g');
+}
+
+static int namecompare(const void *a, const void *b)
+{
+    return (strcmp(*(char **)a, *(char **)b));
+}
+
+/*************************************************************************
+ * Function:  inventorypath( )
+ *
+ * Inventory all MSG files of path
+ *
+ * 1 A plain file name is scanned as is
+ * 2 Wildcards or a directory: list the names, sorted so the output does
+ *   not depend on the directory order
+ * 3 Scan each matching file, a directory is walked down for all *.msg
+ *   files in it and below
+ *
+ * Return:    returns error code or 0 for all good
+ *************************************************************************/
+
+int inventorypath(INVENTORY *inv, char *path)
+{
+    int walk = isdirectory(path);  // 1= walk down a directory
+    char pattern[_MAX_PATH];
+    char filename[_MAX_PATH];
+    char drive[_MAX_DRIVE];
+    char dir[_MAX_DIR];
+    struct _finddata_t c_file;
+    char **names = NULL;
+    char **grow = NULL;
+    int count = 0;
+    long hFile;
+    int rc = 0;
+
+    if (walk)
+        snprintf(pattern, sizeof(pattern), "%s%s*", path, PATH_SEP_STR);
+    else if (strpbrk(path, "*?") != NULL)
+        snprintf(pattern, sizeof(pattern), "%s", path);
+    else
+        return (inventoryfile(inv, path));
+
+    _splitpath(pattern, drive, dir, NULL, NULL);
+
+    if ((hFile = _findfirst(pattern, &c_file)) == -1L)
+        return (MKMSG_NOERROR);
+
+    do
+    {
+        if (!strcmp(c_file.name, ".") || !strcmp(c_file.name, ".."))
+            continue;
+
+        grow = (char **)realloc(names, (count + 1) * sizeof(char *));
+        if (grow == NULL || (grow[count] = strdup(c_file.name)) == NULL)
+        {
+            rc = MKMSG_MEM_ERROR1;
+            if (grow != NULL)
+                names = grow;
+            break;
+        }
+        names = grow;
+        count++;
+    } while (_findnext(hFile, &c_file) == 0);
+
+    _findclose(hFile);
+
+    if (rc == MKMSG_NOERROR)
+        qsort(names, count, sizeof(char *), namecompare);
+
+    for (int x = 0; x < count && rc == MKMSG_NOERROR; x++)
+    {
+        // too long, would not open the right file anyway
+        if (snprintf(filename, sizeof(filename), "%s%s%s", drive, dir, names[x]) >=
+            (int)sizeof(filename))
+            continue;
+
+        if (isdirectory(filename))
+        {
+            if (walk)
+                rc = inventorypath(inv, filename);
+        }
+        else if (ismsgfile(filename) || !walk)
+            rc = inventoryfile(inv, filename);
+    }
+
+    for (int x = 0; x < count; x++)
+        free(names[x]);
+    free(names);
+
+    return (rc);
+}
+
+/*************************************************************************
+ * Function:  inventory( )
+ *
+ * -i csv | json: one record per MSG file to stdout instead of
+ * decompiling, for indexing large numbers of files. Directories are
+ * walked down, wildcards only match in their own directory.
+ *
+ * Return:    error code of the first file that failed or 0
+ *************************************************************************/
+
+int inventory(int format, int argc, char *argv[])
+{
+    INVENTORY inv;
+    int rc = 0;
+
+    memset(&inv, 0, sizeof(INVENTORY));
+    inv.format = format;
+
+    rc = OutBufOpen(&inv.out, "-", MKMSGD_OUTBUF);
+    if (rc != MKMSG_NOERROR)
+        return (rc);
+
+    if (format == INV_JSON)
+        rc = OutBufAppend(&inv.out, "[\n", 2);
+    else
+        rc = OutBufPrintf(&inv.out, "file,identifier,messages,firstmsg,version,"
+                                    "indexwidth,codepages\n");
+
+    for (int x = 0; x < argc && rc == MKMSG_NOERROR; x++)
+        rc = inventorypath(&inv, argv[x]);
+
+    if (rc == MKMSG_NOERROR && format == INV_JSON)
+        rc = OutBufPrintf(&inv.out, "%s]\n", inv.count ? "\n" : "");
+
+    if (OutBufClose(&inv.out) != MKMSG_NOERROR && rc == MKMSG_NOERROR)
+        rc = MKMSG_ERRFILEWRITE;
+
+    if (rc != MKMSG_NOERROR)
+    {
+        fprintf(screen, "MKMSGD: Inventory write error (%d)\n", rc);
+        return (rc);
+    }
+
+    fprintf(screen, "%d files, %d failed\n", inv.count, inv.failed);
+
+    return (inv.rc);
+}
+
+/*
+ * diffvalue( ) - report one header value that differs, 1 if it does
+ */
+int diffvalue(char *name, unsigned long oldval, unsigned long newval)
+{
+    if (oldval == newval)
+        return (0);
+
+    msgprintf(NULL, "Header   %-20s %lu -> %lu\n", name, oldval, newval);
+    return (1);
+}
+
+/*************************************************************************
+ * Function:  diffheader( )
+ *
+ * Compare the header and country info read by readheader. Message count
+ * and first message are left to the message compare.
+ *
+ * Return:    number of values that differ
+ *************************************************************************/
+
+int diffheader(MESSAGEINFO *oldinfo, MESSAGEINFO *newinfo)
+{
+    int diffs = 0;
+    int cpdiff = 0;
+
+    if (memcmp(oldinfo->identifier, newinfo->identifier, 3))
+    {
+        msgprintf(NULL, "Header   %-20s %.3s -> %.3s\n", "identifier",
+                  (char *)oldinfo->identifier, (char *)newinfo->identifier);
+        diffs++;
+    }
+
+    diffs += diffvalue("version", oldinfo->version, newinfo->version);
+    diffs += diffvalue("index width", oldinfo->offsetid ? 16 : 32,
+                       newinfo->offsetid ? 16 : 32);
+    diffs += diffvalue("bytes per char", oldinfo->bytesperchar, newinfo->bytesperchar);
+    diffs += diffvalue("country", oldinfo->country, newinfo->country);
+    diffs += diffvalue("language family", oldinfo->langfamilyID, newinfo->langfamilyID);
+    diffs += diffvalue("language version", oldinfo->langversionID, newinfo->langversionID);
+    diffs += diffvalue("extended header", oldinfo->extenblock != 0,
+                       newinfo->extenblock != 0);
+
+    cpdiff = (oldinfo->codepagesnumber != newinfo->codepagesnumber);
+    for (int x = 0; x < oldinfo->codepagesnumber && !cpdiff; x++)
+        cpdiff = (oldinfo->codepages[x] != newinfo->codepages[x]);
+
+    if (cpdiff)
+    {
+        msgprintf(NULL, "Header   %-20s", "codepages");
+        for (int x = 0; x < oldinfo->codepagesnumber; x++)
+            msgprintf(NULL, " %u", oldinfo->codepages[x]);
+        msgprintf(NULL, " ->");
+        for (int x = 0; x < newinfo->codepagesnumber; x++)
+            msgprintf(NULL, " %u", newinfo->codepages[x]);
+        msgprintf(NULL, "\n");
+        diffs++;
+    }
+
+    if (strcmp((char *)oldinfo->filename, (char *)newinfo->filename))
+    {
+        msgprintf(NULL, "Header   %-20s %s -> %s\n", "file name",
+                  oldinfo->filename, newinfo->filename);
+        diffs++;
+    }
+
+    return (diffs);
+}
+
+/*************************************************************************
+ * Function:  diffmsgfiles( )
+ *
+ * -d option: message level compare of two MSG files, both mapped, no
+ * text conversion
+ *
+ * 1 Open both files and read their headers (readheader)
+ * 2 Compare the headers and country info
+ * 3 *** main loop over all message numbers of both files ***
+ * 3.1 Only in the old file: removed, only in the new file: added
+ * 3.2 In both: compare the compiled messages (type byte included),
+ *     first the length, then the hash, bytes only if the hashes match
+ * ** end main loop
+ * 4 Show the totals
+ *
+ * Return:    0 if the files have the same messages and header,
+ *            MKMSG_FILES_DIFFER if not, else error code
+ *************************************************************************/
+
+int diffmsgfiles(char *oldfile, char *newfile)
+{
+    MESSAGEINFO oldinfo;
+    MESSAGEINFO newinfo;
+    MSGFILE oldmf;
+    MSGFILE newmf;
+    MSGTEXT oldmsg;
+    MSGTEXT newmsg;
+    unsigned long oldlast;      // last message + 1 of each file
+    unsigned long newlast;
+    unsigned long first;        // all message numbers of both files
+    unsigned long last;
+    int inold, innew;
+    int added = 0, removed = 0, changed = 0, same = 0;
+    int diffs = 0;
+    int rc = 0;
+
+    memset(&oldinfo, 0, sizeof(MESSAGEINFO));
+    memset(&newinfo, 0, sizeof(MESSAGEINFO));
+
+    rc = MsgFileOpen(&oldmf, oldfile);
+    if (rc != MKMSG_NOERROR)
+    {
+        msgprintf(NULL, "MKMSGD: %s: MSG Header read error (%d)\n", oldfile, rc);
+        return (rc);
+    }
+
+    rc = MsgFileOpen(&newmf, newfile);
+    if (rc != MKMSG_NOERROR)
+    {
+        msgprintf(NULL, "MKMSGD: %s: MSG Header read error (%d)\n", newfile, rc);
+        MsgFileClose(&oldmf);
+        return (rc);
+    }
+
+    readheader(&oldinfo, &oldmf);
+    readheader(&newinfo, &newmf);
+
+    msgprintf(NULL, "--- %s  %.3s %u messages\n", oldfile,
+              (char *)oldinfo.identifier, oldinfo.numbermsg);
+    msgprintf(NULL, "+++ %s  %.3s %u messages\n", newfile,
+              (char *)newinfo.identifier, newinfo.numbermsg);
+
+    diffs = diffheader(&oldinfo, &newinfo);
+
+    oldlast = (unsigned long)oldinfo.firstmsg + oldinfo.numbermsg;
+    newlast = (unsigned long)newinfo.firstmsg + newinfo.numbermsg;
+
+    first = oldinfo.firstmsg < newinfo.firstmsg ? oldinfo.firstmsg : newinfo.firstmsg;
+    last = oldlast > newlast ? oldlast : newlast;
+    if (oldinfo.numbermsg == 0)
+        first = newinfo.firstmsg;
+    if (newinfo.numbermsg == 0)
+        first = oldinfo.firstmsg;
+
+    for (unsigned long number = first; number < last && rc == MKMSG_NOERROR; number++)
+    {
+        inold = (number >= oldinfo.firstmsg && number < oldlast);
+        innew = (number >= newinfo.firstmsg && number < newlast);
+
+        if (inold)
+            rc = MsgFileGet(&oldmf, number, &oldmsg);
+        if (innew && rc == MKMSG_NOERROR)
+            rc = MsgFileGet(&newmf, number, &newmsg);
+        if (rc != MKMSG_NOERROR)
+        {
+            msgprintf(NULL, "MKMSGD: %s: bad index entry for message %lu (%d)\n",
+                      inold ? oldfile : newfile, number, rc);
+            break;
+        }
+
+        if (inold && !innew)
+        {
+            msgprintf(NULL, "Removed  %.3s%04lu\n", (char *)oldinfo.identifier, number);
+            removed++;
+        }
+        else if (innew && !inold)
+        {
+            msgprintf(NULL, "Added    %.3s%04lu\n", (char *)newinfo.identifier, number);
+            added++;
+        }
+        else if (inold && innew)
+        {
+            // the type byte is right in front of the text
+            if (oldmsg.length == newmsg.length &&
+                MsgTextHash(&oldmsg) == MsgTextHash(&newmsg) &&
+                !memcmp(oldmsg.text - 1, newmsg.text - 1, oldmsg.length + 1))
+            {
+                same++;
+                continue;
+            }
+
+            msgprintf(NULL, "Changed  %.3s%04lu\n", (char *)newinfo.identifier, number);
+            changed++;
+        }
+    }
+
+    MsgFileClose(&newmf);
+    MsgFileClose(&oldmf);
+
+    if (rc != MKMSG_NOERROR)
+        return (rc);
+
+    msgprintf(NULL, "\n%d changed, %d added, %d removed, %d same, %d header differences\n",
+              changed, added, removed, same, diffs);
+
+    if (changed || added || removed || diffs)
+        return (MKMSG_FILES_DIFFER);
+
+    return (MKMSG_NOERROR);
+}
+
+/*************************************************************************
+ * Function:  readheader( )
+ *
+ * Pulls all the MSG file info from the mapped file into the MESSAGEINFO
+ * structure, MsgFileOpen has already checked the signature
+ *
+ * 1. Transfer header info into MESSAGEINFO structure
+ * 2. Transfer FILECOUNTRYINFO block into MESSAGEINFO structure
+ * 3. Check for extention block and read if exists
+ * 4. Calculate message start
+ * 5. Calculate index offset and size
+ *
+ * Return:    returns error code or 0 for all good
+ *************************************************************************/
+
+int readheader(MESSAGEINFO *messageinfo, MSGFILE *mf)
+{
+    MSGHEADER *msgheader = mf->header;
+    FILECOUNTRYINFO *cpheader = mf->country;
+    EXTHDR *extheader = NULL;
 
     // Pulls all header information into MESSAGEINFO
     for (int x = 0; x < 3; x++)
@@ -242,37 +1163,23 @@ int readheader(MESSAGEINFO *messageinfo)
     // was 0 version -- and most info did not exist - fixed below
 
     // make sure this is a version 2 MSG
-    if (messageinfo->version == 2)
+    if (cpheader != NULL)
     {
         messageinfo->countryinfo = msgheader->countryinfo;
         messageinfo->extenblock = msgheader->extenblock;
         for (int x = 0; x < 5; x++)
             messageinfo->reserved[x] = msgheader->reserved[x];
 
-        // *** Get country info
-        // re-allocate buffer to size of FILECOUNTRYINFO
-        header = (char *)realloc(header, sizeof(FILECOUNTRYINFO));
-        if (header == NULL)
-            return (MKMSG_MEM_ERROR2);
-
-        // seek to the block for read
-        fseek(fp, messageinfo->countryinfo, SEEK_SET);
-
-        // read header
-        read = fread(header, sizeof(char), sizeof(FILECOUNTRYINFO), fp);
-        if (ferror(fp))
-            return (MKMSG_READ_ERROR);
-
-        // FILECOUNTRYINFO point to header buffer
-        cpheader = (FILECOUNTRYINFO *)header;
-
         // Pulls all country information into MESSAGEINFO
         messageinfo->bytesperchar = cpheader->bytesperchar;
         messageinfo->country = cpheader->country;
         messageinfo->langfamilyID = cpheader->langfamilyID;
         messageinfo->langversionID = cpheader->langversionID;
         messageinfo->codepagesnumber = cpheader->codepagesnumber;
-        strcpy(messageinfo->filename, cpheader->filename);
+        if (messageinfo->codepagesnumber > 16)
+            messageinfo->codepagesnumber = 16;
+        memcpy(messageinfo->filename, cpheader->filename, _MAX_PATH);
+        messageinfo->filename[_MAX_PATH - 1] = 0x00;
         for (int x = 0; x < messageinfo->codepagesnumber; x++)
             messageinfo->codepages[x] = cpheader->codepages[x];
     }
@@ -284,7 +1191,11 @@ int readheader(MESSAGEINFO *messageinfo)
 
     // quick check of extended header, it's a small block but be
     // consistent. I do not have an example yet so this is kind of a stub
-    if (!messageinfo->extenblock)
+    if (messageinfo->extenblock &&
+        messageinfo->extenblock + sizeof(EXTHDR) <= mf->file.size)
+        extheader = (EXTHDR *)(mf->file.data + messageinfo->extenblock);
+
+    if (extheader == NULL)
     {
         // No ext header so set to 0
         messageinfo->extlength = 0;
@@ -292,22 +1203,6 @@ int readheader(MESSAGEINFO *messageinfo)
     }
     else
     {
-        // re-allocate buffer to size of EXTHDR
-        header = (char *)realloc(header, sizeof(EXTHDR));
-        if (header == NULL)
-            return (MKMSG_MEM_ERROR3);
-
-        // seek to the block for read
-        fseek(fp, messageinfo->extenblock, SEEK_SET);
-
-        // read header
-        read = fread(header, sizeof(char), sizeof(EXTHDR), fp);
-        if (ferror(fp))
-            return (MKMSG_READ_ERROR);
-
-        // FILECOUNTRYINFO point to header buffer
-        extheader = (EXTHDR *)header;
-
         messageinfo->extlength = extheader->hdrlen;
         messageinfo->extnumblocks = extheader->numblocks;
     }
@@ -315,40 +1210,22 @@ int readheader(MESSAGEINFO *messageinfo)
     // index starts after main header
     messageinfo->indexoffset = messageinfo->hdroffset;
 
-    // again - in versions < 2 FILECOUNTRYINFO doesnot exists
-    // so fix
-
     // get index size in bytes based on offsetid
     if (messageinfo->offsetid)
         messageinfo->indexsize = messageinfo->numbermsg * 2;
     else
         messageinfo->indexsize = messageinfo->numbermsg * 4;
 
-    // start of message area
+    // start of message area, in versions < 2 FILECOUNTRYINFO does not
+    // exist
     if (messageinfo->version == 2)
         messageinfo->msgoffset = messageinfo->countryinfo +
                                  sizeof(FILECOUNTRYINFO);
     else
         messageinfo->msgoffset = messageinfo->hdroffset + messageinfo->indexsize;
 
-    // Since we will determine a message length from the message index
-    // contents (next message offset - current message offset) there will
-    // be an issue with the last message, there is no next message offset).
-    // However, if (messageinfo->extenblock) is true then it can be used.
-    // If (messageinfo->extenblock) is false then seek to get end of file
-    // and add 1 which will be used as the (final next message offset).
-    if (messageinfo->extenblock && messageinfo->version == 2)
-        messageinfo->msgfinalindex = messageinfo->extenblock;
-    else
-    {
-        fseek(fp, 0L, SEEK_END);
-        // don't panic - I need eof + 1
-        messageinfo->msgfinalindex = (unsigned long)ftell(fp) + 1;
-    }
-
-    // close up and get out
-    fclose(fp);
-    free(header);
+    // end of the message area: the extended header or end of file
+    messageinfo->msgfinalindex = mf->msgend;
 
     return (MKMSG_NOERROR);
 }
@@ -356,360 +1233,278 @@ int readheader(MESSAGEINFO *messageinfo)
 /*************************************************************************
  * Function:  outputheader()
  *
- * Creates output file and writes out info header as comments
+ * Writes the info header as comments to the output buffer
  * Params: loaded MESSAGEINFO structure as an input
  *
  * Return:    returns error code or 0 for all good
  *
  *************************************************************************/
 
-int outputheader(MESSAGEINFO *messageinfo)
+int outputheader(MESSAGEINFO *messageinfo, OUTBUF *out)
 {
-    // write output file open for append
-    FILE *fpo = fopen(messageinfo->outfile, "wb");
-    if (fpo == NULL)
-        return (MKMSG_OPEN_ERROR);
-
-    // buffer to write out message heaeder - I just pick
-    // 140 size just because
-    char *write_buffer = (char *)calloc(140, sizeof(char));
-    if (write_buffer == NULL)
-        return (MKMSG_MEM_ERROR4);
-
-    sprintf(write_buffer, "%s\n;\n",
-            "; ********** MKMSGD Message file decompiler **********");
-    fwrite(write_buffer, strlen(write_buffer), 1, fpo);
-
-    sprintf(write_buffer, "; Input filename           %s\n",
-            messageinfo->infile);
-    fwrite(write_buffer, strlen(write_buffer), 1, fpo);
-
-    sprintf(write_buffer, "; MSG File Version:        %d\n",
-            messageinfo->version);
-    fwrite(write_buffer, strlen(write_buffer), 1, fpo);
-
-    sprintf(write_buffer, "; Component Identifier:    %c%c%c\n",
-            messageinfo->identifier[0],
-            messageinfo->identifier[1],
-            messageinfo->identifier[2]);
-    fwrite(write_buffer, strlen(write_buffer), 1, fpo);
-
-    sprintf(write_buffer, "; Number of messages:      %d\n",
-            messageinfo->numbermsg);
-    fwrite(write_buffer, strlen(write_buffer), 1, fpo);
-
-    sprintf(write_buffer, "; First message number:    %d\n;\n",
-            messageinfo->firstmsg);
-    fwrite(write_buffer, strlen(write_buffer), 1, fpo);
+    int rc = 0;
+
+    rc |= OutBufPrintf(out, "%s\n;\n",
+                       "; ********** MKMSGD Message file decompiler **********");
+    rc |= OutBufPrintf(out, "; Input filename           %s\n",
+                       messageinfo->infile);
+    rc |= OutBufPrintf(out, "; MSG File Version:        %d\n",
+                       messageinfo->version);
+    rc |= OutBufPrintf(out, "; Component Identifier:    %c%c%c\n",
+                       messageinfo->identifier[0],
+                       messageinfo->identifier[1],
+                       messageinfo->identifier[2]);
+    rc |= OutBufPrintf(out, "; Number of messages:      %d\n",
+                       messageinfo->numbermsg);
+    rc |= OutBufPrintf(out, "; First message number:    %d\n;\n",
+                       messageinfo->firstmsg);
 
     if (messageinfo->version == 2)
     {
-        sprintf(write_buffer, "%s\n;\n",
-                "; ******************* Country Info *******************");
-        fwrite(write_buffer, strlen(write_buffer), 1, fpo);
-
-        sprintf(write_buffer, "; Bytes per character:       %d\n",
-                messageinfo->bytesperchar);
-        fwrite(write_buffer, strlen(write_buffer), 1, fpo);
-
-        sprintf(write_buffer, "; Country Code:              %d\n",
-                messageinfo->country);
-        fwrite(write_buffer, strlen(write_buffer), 1, fpo);
-
-        sprintf(write_buffer, "; Language family ID:        %d\n",
-                messageinfo->langfamilyID);
-        fwrite(write_buffer, strlen(write_buffer), 1, fpo);
+        rc |= OutBufPrintf(out, "%s\n;\n",
+                           "; ******************* Country Info *******************");
+        rc |= OutBufPrintf(out, "; Bytes per character:       %d\n",
+                           messageinfo->bytesperchar);
+        rc |= OutBufPrintf(out, "; Country Code:              %d\n",
+                           messageinfo->country);
+        rc |= OutBufPrintf(out, "; Language family ID:        %d\n",
+                           messageinfo->langfamilyID);
+        rc |= OutBufPrintf(out, "; Language version ID:       %d\n",
+                           messageinfo->langversionID);
+        rc |= OutBufPrintf(out, "; Number of codepages:       %d\n",
+                           messageinfo->codepagesnumber);
 
-        sprintf(write_buffer, "; Language version ID:       %d\n",
-                messageinfo->langversionID);
-        fwrite(write_buffer, strlen(write_buffer), 1, fpo);
-
-        sprintf(write_buffer, "; Number of codepages:       %d\n",
-                messageinfo->codepagesnumber);
-        fwrite(write_buffer, strlen(write_buffer), 1, fpo);
-
-        memset(write_buffer, 0x00, _msize(write_buffer));
         for (int x = 0; x < messageinfo->codepagesnumber; x++)
-        {
-            sprintf(write_buffer, "; Codepage %d        0x%02X (%d)\n",
-                    (x + 1), messageinfo->codepages[x], messageinfo->codepages[x]);
-            fwrite(write_buffer, strlen(write_buffer), 1, fpo);
-        }
+            rc |= OutBufPrintf(out, "; Codepage %d        0x%02X (%d)\n",
+                               (x + 1), messageinfo->codepages[x], messageinfo->codepages[x]);
 
-        sprintf(write_buffer, ";\n; File name:                 %s\n",
-                messageinfo->filename);
-        fwrite(write_buffer, strlen(write_buffer), 1, fpo);
+        rc |= OutBufPrintf(out, ";\n; File name:                 %s\n",
+                           messageinfo->filename);
 
         if (messageinfo->extenblock)
         {
-            sprintf(write_buffer, "%s\n;\n",
-                    ";\n; ** Has an extended header **");
-            fwrite(write_buffer, strlen(write_buffer), 1, fpo);
-
-            sprintf(write_buffer, "; Ext header length:        %d\n",
-                    messageinfo->extlength);
-            fwrite(write_buffer, strlen(write_buffer), 1, fpo);
-
-            sprintf(write_buffer, "; Number ext blocks:        %d\n;\n",
-                    messageinfo->extnumblocks);
-            fwrite(write_buffer, strlen(write_buffer), 1, fpo);
+            rc |= OutBufPrintf(out, "%s\n;\n",
+                               ";\n; ** Has an extended header **");
+            rc |= OutBufPrintf(out, "; Ext header length:        %d\n",
+                               messageinfo->extlength);
+            rc |= OutBufPrintf(out, "; Number ext blocks:        %d\n;\n",
+                               messageinfo->extnumblocks);
         }
         else
         {
-            sprintf(write_buffer, "%s\n;\n",
-                    ";\n; ** No an extended header **");
-            fwrite(write_buffer, strlen(write_buffer), 1, fpo);
+            rc |= OutBufPrintf(out, "%s\n;\n",
+                               ";\n; ** No an extended header **");
         }
     }
-    // close up and get out
-    fclose(fpo);
-    free(write_buffer);
 
-    return (MKMSG_NOERROR);
+    return (rc ? MKMSG_WRITEHDR_ERR : MKMSG_NOERROR);
 }
 
 /*************************************************************************
- * Function:  readmessages()
+ * Function:  parseranges( )
  *
- * 1. Opens input and output message files
- * 2. Setup buffers for index, read, and write
- * 3. Read in full index
- * 4. Write out idenifier -- needs 0x0D 0x0A ending
- * 5. Setup for uint8 or uint32 index read
- * 6. Main loop
- * 6.1 Calculate message number
- * 6.2 If last message - get final pointer for read
- * 6.3 Calculate message length from index
- * 6.4 Seek to message start
- * 6.5 Resize read buffer if needed
- * 6.6 Clear read buffer with all 0x00
- * 6.7 Read in the current message
- * 6.8 Verify msg length (current_msg_len) using strlen
- * 6.9 Check for no 0x0D 0x0A end - if not add %, 0, 0x0D, 0x0A
- * 6.10 Setup scratch pointer and move past msg_type
- * 6.11 Resize write buffer if needed
- * 6.12 Generate message header and write
- * 6.13 Write message
- * 6.14 If V option print to screen
- * 7 Close files and free buffers
- * 8 Return
+ * Add a -m list to the message selection: numbers and first-last
+ * ranges separated by commas, e.g. 100-120,305. More -m options add
+ * to the list.
  *
  * Return:    returns error code or 0 for all good
- *
  *************************************************************************/
 
-int readmessages(MESSAGEINFO *messageinfo)
+int parseranges(char *list)
 {
-    // index pointers
-    uint16_t *small_index = NULL;      // used if index pointers uint16
-    uint32_t *large_index = NULL;      // used if index pointers uint32
-    char msginfo[10] = {0};            // current message header
-    char *scratchptr = NULL;           // scratch pointer
-    unsigned long msg_curr = 0;        // pointer to current index msg
-    unsigned long msg_next = 0;        // pointer to next index msg
-    unsigned long current_msg = 0;     // current msg number being processed
-    unsigned long intial_len = 0;      // save intial length
-    unsigned long current_msg_len = 0; // current msg length
-    unsigned long last_message;        // track last message
+    MSGRANGE *grow = NULL;
+    char *p = list;
+    char *end = NULL;
+    unsigned long first;
+    unsigned long last;
 
-    // open input file
-    FILE *fpi = fopen(messageinfo->infile, "rb");
-    if (fpi == NULL)
-        return (MKMSG_OPEN_ERROR);
+    do
+    {
+        if (!isdigit(*p))
+            return (MKMSG_GETOPT_ERROR);
+        first = last = strtoul(p, &end, 10);
+        p = end;
 
-    // write output file open for append
-    FILE *fpo = fopen(messageinfo->outfile, "ab");
-    if (fpo == NULL)
-        return (MKMSG_OPEN_ERROR);
+        if (*p == '-')
+        {
+            p++;
+            if (!isdigit(*p))
+                return (MKMSG_GETOPT_ERROR);
+            last = strtoul(p, &end, 10);
+            p = end;
+        }
 
-    // buffer to read in index
-    char *index_buffer = (char *)calloc(messageinfo->indexsize, sizeof(char));
-    if (index_buffer == NULL)
-        return (MKMSG_MEM_ERROR5);
+        if (first > last || last > 0xFFFF || (*p != ',' && *p != 0x00))
+            return (MKMSG_GETOPT_ERROR);
 
-    // buffer to read in a message - start with a 80 size buffer
-    // if for some reason bigger is needed realloc latter
-    char *read_buffer = (char *)calloc(80, sizeof(char));
-    if (read_buffer == NULL)
-        return (MKMSG_MEM_ERROR6);
+        grow = (MSGRANGE *)realloc(ranges, (rangecount + 1) * sizeof(MSGRANGE));
+        if (grow == NULL)
+            return (MKMSG_MEM_ERROR1);
+        ranges = grow;
+        ranges[rangecount].first = first;
+        ranges[rangecount].last = last;
+        rangecount++;
+    } while (*p++ == ',');
 
-    // buffer to write in a message - start with a 80 size buffer
-    // if for some reason bigger is needed realloc latter
-    char *write_buffer = (char *)calloc(80, sizeof(char));
-    if (write_buffer == NULL)
-        return (MKMSG_MEM_ERROR7);
+    return (MKMSG_NOERROR);
+}
+
+/*
+ * parselanguage( ) - -l family[,sub[,codepage]], sub and codepage 0 or
+ * left out match any
+ */
+int parselanguage(char *arg)
+{
+    unsigned long value[3] = {0, 0, 0};
+    char *p = arg;
+    char *end = NULL;
+    int x = 0;
+
+    do
+    {
+        if (x == 3 || !isdigit(*p))
+            return (MKMSG_GETOPT_ERROR);
+        value[x++] = strtoul(p, &end, 10);
+        p = end;
+        if (*p != ',' && *p != 0x00)
+            return (MKMSG_GETOPT_ERROR);
+    } while (*p++ == ',');
 
-    // *** get full index into buffer (index_buffer)
+    if (value[0] < 1 || value[0] > 0xFFFF || value[1] > 0xFFFF || value[2] > 0xFFFF)
+        return (MKMSG_GETOPT_ERROR);
 
-    // seek to the start of index for read
-    fseek(fpi, messageinfo->indexoffset, SEEK_SET);
+    selfamily = (uint16_t)value[0];
+    selversion = (uint16_t)value[1];
+    selcodepage = (uint16_t)value[2];
 
-    // read index into buffer
-    fread(index_buffer, sizeof(char), messageinfo->indexsize, fpi);
-    if (ferror(fpi))
-        return (MKMSG_READ_ERROR);
+    return (MKMSG_NOERROR);
+}
+
+/*************************************************************************
+ * Function:  readmessages()
+ *
+ * Decompiles the messages from the mapped MSG file into the output
+ * buffer, no seeks, reads or allocations per message
+ *
+ * 1. Write out idenifier -- needs 0x0D 0x0A ending
+ * 2. No -m: all messages from firstmsg to the last
+ * 3. -m: each range cut to the messages in the file, every message is
+ *    one index lookup so the work depends on the selection only
+ * 4. Return
+ *
+ * Return:    returns error code or 0 for all good
+ *
+ *************************************************************************/
+
+int readmessages(MESSAGEINFO *messageinfo, MSGFILE *mf, OUTBUF *out)
+{
+    unsigned long current_msg = 0;     // current msg number being processed
+    unsigned long first_message;       // first message of the file
+    unsigned long last_message;        // track last message
+    unsigned long first;               // selected range in the file
+    unsigned long last;
+    int rc = 0;
 
     // not pretty, but the old IBM MKMSGF expects this
     // line to end with 0x0D 0x0A
-    write_buffer[0] = messageinfo->identifier[0];
-    write_buffer[1] = messageinfo->identifier[1];
-    write_buffer[2] = messageinfo->identifier[2];
-    write_buffer[3] = 0x0D;
-    write_buffer[4] = 0x0A;
-    write_buffer[5] = 0x00;
-
-    fwrite(write_buffer, strlen(write_buffer), 1, fpo);
+    rc = OutBufPrintf(out, "%.3s\r\n", (char *)messageinfo->identifier);
+    if (rc != MKMSG_NOERROR)
+        return (rc);
 
-    // pick the pointer based on index uint16 or uint32
-    if (messageinfo->offsetid)
-        small_index = (uint16_t *)index_buffer;
-    else
-        large_index = (uint32_t *)index_buffer;
+    if (messageinfo->numbermsg == 0)
+        return (MKMSG_NOERROR);
 
-    // last message number
+    // first and last message number
+    first_message = messageinfo->firstmsg;
     last_message = (messageinfo->numbermsg + messageinfo->firstmsg - 1);
 
-    // **** main read - read/write loop
-    for (int count = 0; count < messageinfo->numbermsg; count++)
+    // **** main loop
+    if (rangecount == 0)
     {
-        // do the message number counting
-        current_msg = messageinfo->firstmsg + count;
-
-        // handle the uint16 and uint32 index differences
-        if (messageinfo->offsetid)
+        for (current_msg = first_message; current_msg <= last_message; current_msg++)
         {
-            msg_curr = (unsigned long)*small_index++;
-            msg_next = (unsigned long)*small_index;
+            rc = writemessage(messageinfo, mf, out, current_msg, last_message);
+            if (rc != MKMSG_NOERROR)
+                return (rc);
         }
-        else
-        {
-            msg_curr = *large_index++;
-            msg_next = *large_index;
-        }
-
-        // if we are on the last message then the msg_next
-        // needs to be the end of the message block + 1 as calculated
-        // with the fseek to end above.
-        // As a note, I am going to use msg_curr and msg_next to
-        // get the message length.
-        if (count == (messageinfo->numbermsg - 1))
-            msg_next = messageinfo->msgfinalindex;
-
-        // just calc current message length for readability
-        current_msg_len = (msg_next - msg_curr);
-        intial_len = current_msg_len; // for fix last line
-
-        // seek to the start of message to read
-        fseek(fpi, msg_curr, SEEK_SET);
-
-        // Read buffer sizing **********************************
-        //
-        // check read buffer size -- Do we need a bigger buffer?
-        // Note: the +5 size is to give me room for %0 or <CR>
-        // and I am paranoid :)
-        // I did not need to do this, but just for fun I contract
-        // the buffer
-        // I am using needed size +5 in case I need to append %0
-        // and <CR> while giving me a 0x00 final char for strlen
-        if (((current_msg_len + 5) > _msize(read_buffer)) ||
-            (_msize(read_buffer) > (current_msg_len * 4)))
-        {
-            read_buffer = (char *)realloc(read_buffer, (current_msg_len + 5));
-            if (read_buffer == NULL)
-                return (MKMSG_MEM_ERROR8);
-        }
-
-        // clear the read_buffer -- set all to 0x00 this will
-        // give me a clean strlen return
-        memset(read_buffer, 0x00, _msize(read_buffer));
-
-        // read in the message to the read buffer
-        fread(read_buffer, sizeof(char), current_msg_len, fpi);
-
-        // had a couple questionable messages (which could have been
-        // my fault) so this will give me a know string to change
-        // the right end of the string
-        current_msg_len = strlen(read_buffer);
+        return (MKMSG_NOERROR);
+    }
 
-        // As a side note - any message can use the <CR> option!
-        // If the original message ended with %0, it is then compiled
-        // without a <CR>. So we need to check each input line for
-        // 0x0D 0x0A and if does not exist then add %0 and 0x0A
+    for (int x = 0; x < rangecount; x++)
+    {
+        first = ranges[x].first > first_message ? ranges[x].first : first_message;
+        last = ranges[x].last < last_message ? ranges[x].last : last_message;
 
-        if (read_buffer[(current_msg_len - 1)] != 0x0A &&
-            read_buffer[(current_msg_len - 2)] != 0x0D)
+        if (first > last)
         {
-            read_buffer[(current_msg_len + 0)] = '%';
-            read_buffer[(current_msg_len + 1)] = '0';
-            read_buffer[(current_msg_len + 2)] = 0x0D;
-            read_buffer[(current_msg_len) + 3] = 0x0A;
-            current_msg_len += 4;
+            msgprintf(messageinfo->log, "MKMSGD: %s has no message %lu-%lu\n",
+                      messageinfo->infile, (unsigned long)ranges[x].first,
+                      (unsigned long)ranges[x].last);
+            continue;
         }
 
-        // set up scratch pointer to skip Msg_Type (1)
-        scratchptr = read_buffer;
-        *scratchptr++;
-        current_msg_len -= 1;
-
-        // Write buffer sizing **********************************
-        //
-        // check write buffer size -- Do we need a bigger buffer?
-        // Note: the +5 size is to give me room for %0 or <CR>
-        // and I am paranoid :)
-        // I did not need to do this, but just for fun I contract
-        // the buffer
-
-        // check write buffer size -- Do we need a bigger buffer?
-        if ((current_msg_len + 15) > _msize(write_buffer) ||
-            (_msize(write_buffer) > (current_msg_len * 5)))
+        for (current_msg = first; current_msg <= last; current_msg++)
         {
-            write_buffer = (char *)realloc(write_buffer, (current_msg_len + 15));
-            if (write_buffer == NULL)
-                return (MKMSG_MEM_ERROR9);
+            rc = writemessage(messageinfo, mf, out, current_msg, last_message);
+            if (rc != MKMSG_NOERROR)
+                return (rc);
         }
+    }
 
-        // clear the read_buffer -- set all to 0x00
-        memset(write_buffer, 0x00, _msize(write_buffer));
-
-        // write the message header file to the write buffer
-        // Comp_ID (3) + Msg_Num (4) + Msg_Type (1) + ": " (2) = 10
-        sprintf(msginfo, "%c%c%c%04d%c: ",
-                messageinfo->identifier[0],
-                messageinfo->identifier[1],
-                messageinfo->identifier[2],
-                current_msg,
-                read_buffer[0]);
-
-        // add the msginfo to the write buffer
-        strncpy(write_buffer, msginfo, 10);
+    return (MKMSG_NOERROR);
+}
 
-        // add the message to the write buffer
-        strncat(write_buffer, scratchptr, current_msg_len);
+/*************************************************************************
+ * Function:  writemessage()
+ *
+ * Decompile message current_msg
+ *
+ * 1 Get the message from the index (MsgFileGet)
+ * 2 Cut the message at a 0x00 and check for no 0x0D 0x0A end - if not
+ *   add %, 0, 0x0D, 0x0A (MsgFileSourceEnd, mkmsgf -T uses it too)
+ * 3 Write message header and message
+ * 4 If V option print to screen
+ *
+ * Return:    returns error code or 0 for all good
+ *
+ *************************************************************************/
 
-        // if -f option try to fix last line issues
-        if ((current_msg == last_message) && messageinfo->fixlastline)
-        {
-            printf("Last Message  Initial %d  Current %d\n", intial_len, current_msg_len);
-        }
+int writemessage(MESSAGEINFO *messageinfo, MSGFILE *mf, OUTBUF *out,
+                 unsigned long current_msg, unsigned long last_message)
+{
+    MSGTEXT msg;                       // current message
+    const char *noend = NULL;          // "%0\r\n" if the message has no CR LF
+    int rc = 0;
 
-        // write the record to the output file
-        // just a note here: The write_buffer is larger than
-        // needed (see +15 above) and I memset to fill with 0x00
-        // given this, we will get the write size using strlen()
-        // which returns a size up to the 0x00
-        fwrite(write_buffer, strlen(write_buffer), 1, fpo);
+    rc = MsgFileGet(mf, current_msg, &msg);
+    if (rc != MKMSG_NOERROR)
+        return (rc);
+
+    // cut at a 0x00, %0 and 0x0D 0x0A if the message has no CR LF end
+    noend = MsgFileSourceEnd(&msg);
+
+    // Comp_ID (3) + Msg_Num (4) + Msg_Type (1) + ": " (2) = 10
+    // and the message
+    rc = OutBufPrintf(out, "%.3s%04lu%c: ",
+                      (char *)messageinfo->identifier, current_msg, msg.type);
+    if (rc == MKMSG_NOERROR)
+        rc = OutBufAppend(out, msg.text, msg.length);
+    if (rc == MKMSG_NOERROR)
+        rc = OutBufAppend(out, noend, strlen(noend));
+    if (rc != MKMSG_NOERROR)
+        return (rc);
 
-        // print to screen if you really want it
-        if (messageinfo->verbose == 2)
-            printf("%s", write_buffer);
+    // if -f option try to fix last line issues
+    if ((current_msg == last_message) && messageinfo->fixlastline)
+    {
+        msgprintf(messageinfo->log, "Last Message  Initial %u  Current %u\n",
+                  msg.length + 1, msg.length + (uint32_t)strlen(noend));
     }
 
-    // close up and get out
-    fclose(fpo);
-    fclose(fpi);
-    free(read_buffer);
-    free(write_buffer);
-    free(index_buffer);
+    // print to screen if you really want it
+    if (messageinfo->verbose == 2)
+        msgprintf(messageinfo->log, "%.3s%04lu%c: %.*s%s", (char *)messageinfo->identifier,
+                  current_msg, msg.type, (int)msg.length, msg.text, noend);
 
     return (MKMSG_NOERROR);
 }
@@ -725,20 +1520,37 @@ void usagelong(void)
 
 void helpshort(void)
 {
-    printf("\nMKMSGD [-v] infile.msg [outfile.[txt] ]\n\n");
+    printf("\nMKMSGD [-v] [-m list] [-l lang] infile.msg | - [outfile.[txt] | -]\n");
+    printf("MKMSGD [-v] [-m list] [-j N] [-o outdir] file.msg|*.msg|dir ...\n");
+    printf("MKMSGD -i csv|json file.msg|*.msg|dir ...\n");
+    printf("MKMSGD -d old.msg new.msg\n\n");
 }
 
 void helplong(void)
 {
     printf("\nUse MKMSGD as follows:\n");
-    printf("        [-v] infile.msg [outfile.[txt] ]\n");
+    printf("        [-v] [-m list] infile.msg [outfile.[txt] | -]\n");
+    printf("        outfile - writes the decompile to stdout, infile - reads\n");
+    printf("        the MSG file from stdin (output defaults to stdout)\n");
+    printf("        -m list - only these messages, e.g. -m 100-120,305\n");
+    printf("        -l family[,sub[,codepage]] - that language of a file\n");
+    printf("        compiled with mkmsgf /X, e.g. -l 7,1,850\n");
+    printf("        [-v] [-m list] [-j N] [-o outdir] file.msg|*.msg|dir ...\n");
+    printf("        batch: each file to outdir/name.txt (default .),\n");
+    printf("        a directory means all *.msg in it, -j N decompiles\n");
+    printf("        on N threads, a failed file does not stop the rest\n");
+    printf("        -i csv|json file.msg|*.msg|dir ...\n");
+    printf("        header inventory to stdout, one record per file,\n");
+    printf("        directories are searched for *.msg all the way down\n");
+    printf("        -d old.msg new.msg\n");
+    printf("        added, removed and changed messages and header changes\n");
 }
 
 void prgheading(void)
 {
     printf("\nOperating System/2 Make Message File Decompiler (MKMSGD)\n");
     printf("Version %s  Michael Greene <mikeos2@gmail.com>\n", SYSLVERSION);
-    printf("Compiled with Open Watcom %d.%d  %s\n", OWMAJOR, OWMINOR, __DATE__);
+    printf("Compiled with %s %d.%d  %s\n", CCNAME, CCMAJOR, CCMINOR, __DATE__);
 }
 
 /*************************************************************************
@@ -750,56 +1562,110 @@ void prgheading(void)
 
 void displayinfo(MESSAGEINFO *messageinfo)
 {
-    printf("\n*********** Header Info ***********\n\n");
+    msgprintf(messageinfo->log, "\n*********** Header Info ***********\n\n");
 
-    printf("Input filename         %s\n", messageinfo->infile);
-    printf("Component Identifier:  %c%c%c\n", messageinfo->identifier[0],
+    msgprintf(messageinfo->log, "Input filename         %s\n", messageinfo->infile);
+    msgprintf(messageinfo->log, "Component Identifier:  %c%c%c\n", messageinfo->identifier[0],
            messageinfo->identifier[1], messageinfo->identifier[2]);
-    printf("Number of messages:    %d\n", messageinfo->numbermsg);
-    printf("First message number:  %d\n", messageinfo->firstmsg);
-    printf("OffsetID:              %d  (Offset %s)\n", messageinfo->offsetid,
+    msgprintf(messageinfo->log, "Number of messages:    %d\n", messageinfo->numbermsg);
+    msgprintf(messageinfo->log, "First message number:  %d\n", messageinfo->firstmsg);
+    msgprintf(messageinfo->log, "OffsetID:              %d  (Offset %s)\n", messageinfo->offsetid,
            (messageinfo->offsetid ? "uint16_t" : "uint32_t"));
-    printf("MSG File Version:      %d\n", messageinfo->version);
-    printf("Header offset:         0x%02X (%d)\n",
+    msgprintf(messageinfo->log, "MSG File Version:      %d\n", messageinfo->version);
+    msgprintf(messageinfo->log, "Header offset:         0x%02X (%d)\n",
            messageinfo->hdroffset, messageinfo->hdroffset);
-    printf("Country Info:          0x%02X (%d)\n",
+    msgprintf(messageinfo->log, "Country Info:          0x%02X (%d)\n",
            messageinfo->countryinfo, messageinfo->countryinfo);
-    printf("Extended Header:       0x%02X (%lu)\n",
+    msgprintf(messageinfo->log, "Extended Header:       0x%02X (%lu)\n",
            messageinfo->extenblock, messageinfo->extenblock);
-    printf("Reserved area:         ");
+    msgprintf(messageinfo->log, "Reserved area:         ");
     for (int x = 0; x < 5; x++)
-        printf("%02X ", messageinfo->reserved[x]);
-    printf("\n");
+        msgprintf(messageinfo->log, "%02X ", messageinfo->reserved[x]);
+    msgprintf(messageinfo->log, "\n");
 
     if (messageinfo->reserved[0] == 0x4D &&
         messageinfo->reserved[1] == 0x4B &&
         messageinfo->reserved[2] == 0x47)
-        printf("Built with MKMSGF clone (signature):  %s\n", messageinfo->reserved);
+        msgprintf(messageinfo->log, "Built with MKMSGF clone (signature):  %s\n", messageinfo->reserved);
 
     if (messageinfo->version == 2)
     {
-        printf("\n*********** Country Info  ***********\n\n");
-        printf("Bytes per character:       %d\n", messageinfo->bytesperchar);
-        printf("Country Code:              %d\n", messageinfo->country);
-        printf("Language family ID:        %d\n", messageinfo->langfamilyID);
-        printf("Language version ID:       %d\n", messageinfo->langversionID);
-        printf("Number of codepages:       %d\n", messageinfo->codepagesnumber);
+        msgprintf(messageinfo->log, "\n*********** Country Info  ***********\n\n");
+        msgprintf(messageinfo->log, "Bytes per character:       %d\n", messageinfo->bytesperchar);
+        msgprintf(messageinfo->log, "Country Code:              %d\n", messageinfo->country);
+        msgprintf(messageinfo->log, "Language family ID:        %d\n", messageinfo->langfamilyID);
+        msgprintf(messageinfo->log, "Language version ID:       %d\n", messageinfo->langversionID);
+        msgprintf(messageinfo->log, "Number of codepages:       %d\n", messageinfo->codepagesnumber);
         for (int x = 0; x < messageinfo->codepagesnumber; x++)
-            printf("0x%02X (%d)  ", messageinfo->codepages[x], messageinfo->codepages[x]);
-        printf("\n");
-        printf("File name:                 %s\n\n", messageinfo->filename);
+            msgprintf(messageinfo->log, "0x%02X (%d)  ", messageinfo->codepages[x], messageinfo->codepages[x]);
+        msgprintf(messageinfo->log, "\n");
+        msgprintf(messageinfo->log, "File name:                 %s\n\n", messageinfo->filename);
         if (messageinfo->extenblock)
         {
-            printf("** Has an extended header **\n");
-            printf("Ext header length:        %d\n", messageinfo->extlength);
-            printf("Number ext blocks:        %d\n\n", messageinfo->extnumblocks);
+            msgprintf(messageinfo->log, "** Has an extended header **\n");
+            msgprintf(messageinfo->log, "Ext header length:        %d\n", messageinfo->extlength);
+            msgprintf(messageinfo->log, "Number ext blocks:        %d\n\n", messageinfo->extnumblocks);
         }
         else
-            printf("** No an extended header **\n\n");
+            msgprintf(messageinfo->log, "** No an extended header **\n\n");
     }
     return;
 }
 
+/*************************************************************************
+ * Function:  displayblocks()
+ *
+ * Display the language variant blocks of a multi language file, the
+ * header info above is of the language that is decompiled
+ *
+ *************************************************************************/
+
+void displayblocks(MESSAGEINFO *messageinfo, MSGFILE *mf)
+{
+    EXTBLOCK *block = NULL;
+
+    if (mf->numblocks == 0)
+        return;
+
+    msgprintf(messageinfo->log, "*********** Languages ***********\n\n");
+
+    if (mf->country != NULL)
+        msgprintf(messageinfo->log, "Main:      language %d,%d\n",
+                  mf->country->langfamilyID, mf->country->langversionID);
+
+    for (int x = 0; x < mf->numblocks; x++)
+    {
+        block = &mf->blocks[x];
+        msgprintf(messageinfo->log, "Block %-3d  language %d,%d  %lu bytes at 0x%08lX",
+                  x + 1, block->country.langfamilyID, block->country.langversionID,
+                  (unsigned long)block->size,
+                  (unsigned long)(mf->msgend + block->offset));
+        for (int y = 0; y < block->country.codepagesnumber && y < 16; y++)
+            msgprintf(messageinfo->log, " cp %d", block->country.codepages[y]);
+        msgprintf(messageinfo->log, "\n");
+    }
+
+    if (selfamily)
+        msgprintf(messageinfo->log, "\nDecompiling language %d,%d\n",
+                  messageinfo->langfamilyID, messageinfo->langversionID);
+    msgprintf(messageinfo->log, "\n");
+}
+
+/*
+ * msgprintf( ) - display output to the log, or the screen if log is NULL
+ */
+void msgprintf(OUTBUF *log, const char *format, ...)
+{
+    va_list args;
+
+    va_start(args, format);
+    if (log == NULL)
+        vfprintf(screen, format, args);
+    else
+        OutBufVPrintf(log, format, args);
+    va_end(args);
+}
+
 /* ProgError( )
  *
  * stardard message print
@@ -818,13 +1684,13 @@ void ProgError(int exnum, char *dispmsg)
 
     if (exnum < 0)
     {
-        printf("%s", buffer);
+        fprintf(screen, "%s", buffer);
         return;
     }
     else
     {
         helpshort();
-        printf("%s", buffer);
+        fprintf(screen, "%s", buffer);
         exit(exnum);
     }
 }
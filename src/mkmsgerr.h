@@ -39,6 +39,7 @@
 #define MKMSG_BAD_TYPE          004 // Bad message type
 #define MKMSG_LANG_OUT_RANGE    005 // Language family is outside of valid range
 #define MKMSG_SUBID_OUT_RANGE   006 // Sub id is outside of valid codepage range
+#define MKMSG_IDENT_ERROR       007 // MKMSGF: Bad or missing component identifier
 #define MKMSG_INPUT_ERROR       100 // MKMSG: Bad input file for decompile
 #define MKMSG_OPEN_ERROR        101 // MKMSG: Error open decompile input file
 #define MKMSG_OFFID_ERR         102 // Error open file offsetid routine
@@ -57,6 +58,12 @@
 #define MKMSG_MEM_ERROR7        206 // MKMSG: Decompile mem allocate error
 #define MKMSG_MEM_ERROR8        207 // MKMSG: Decompile mem allocate error
 #define MKMSG_MEM_ERROR9        208 // MKMSG: Decompile mem allocate error
+#define MKMSG_INDEX_OVERFLOW    300 // MKMSGF: Messages too big for 16 bit index
+#define MKMSG_MSG_NOT_FOUND     301 // MSGAPI: Message number not in MSG file
+#define MKMSG_VERIFY_ERROR      302 // MKMSGF: Message does not round trip (/T)
+#define MKMSG_FILES_DIFFER      303 // MKMSGD: -d MSG files differ
+#define MKMSG_COUNTRY_OVERFLOW  304 // MKMSGF: Too many messages for the 16 bit country info offset
+#define MKMSG_VARIANT_DUP       305 // MKMSGF: /X language and codepage already in the file
 
 
 #endif
@@ -42,151 +42,133 @@
 
 #define INCL_DOSNLS /* National Language Support values */
 
-#include <os2.h>
 #include <stdio.h>
+#include <stdarg.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
-#if !defined(_LINUX_SOURCE)
-#include <io.h>
-#endif
-#include <fcntl.h>
-#include <sys/stat.h>
-#include <unistd.h>
-#include <malloc.h>
+#include "compat.h"
 #include "mkmsgf.h"
 #include "mkmsgerr.h"
 #include "version.h"
 #include "dlist.h"
-
-#if __WATCOMC__ <= 1290
-int getline (char **lineptr, unsigned int *n, FILE *stream);
-
-/* getline.c -- Replacement for GNU C library function getline ()
-
-   Copyright (C) 1992 Free Software Foundation, Inc.
-
-   This program is free software; you can redistribute it and/or
-   modify it under the terms of the GNU General Public License as
-   published by the Free Software Foundation; either version 2 of the
-   License, or (at your option) any later version.
-
-   This program is distributed in the hope that it will be useful, but
-   WITHOUT ANY WARRANTY; without even the implied warranty of
-   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
-   General Public License for more details.
-
-   You should have received a copy of the GNU General Public License
-   along with this program; if not, write to the Free Software
-   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA. */
-
-
-#define MAX_CANON 64
-
-/* Read up to (and including) a newline from STREAM into *LINEPTR
-   (and NUL-terminate it). *LINEPTR is a pointer returned from malloc (or
-   NULL), pointing to *N characters of space.  It is realloc'd as
-   necessary.  Returns the number of characters read (not including the
-   null terminator), or -1 on error or EOF.  */
-
-int
-getline (lineptr, n, stream)
-  char **lineptr;
-  unsigned int *n;
-  FILE *stream;
-{
-  int nchars_avail;
-  char *read_pos;
-
-  if (!lineptr || !n || !stream)
-    return -1;
-
-  nchars_avail = *n;
-
-  if (!*lineptr)
-    {
-      if (!(*lineptr = malloc (MAX_CANON)))
-	return -1;
-
-      *n = nchars_avail = MAX_CANON;
-    }
-
-  read_pos = *lineptr;
-
-  for (;;)
-    {
-      register char c = getc (stream);
-
-      /* We always want at least one char left in buffer since we
-	 always (unless we get an error while reading the first char)
-	 NUL-terminate the line buffer. */
-
-      if (nchars_avail < 1)
-	{
-	  if (*n > MAX_CANON)
-	    {
-	      nchars_avail = *n;
-	      *n *= 2;
-	    }
-	  else
-	    {
-	      nchars_avail = MAX_CANON;
-	      *n += MAX_CANON;
-	    }
-
-	  *lineptr = realloc (*lineptr, *n);
-	  read_pos = *lineptr + (*n - nchars_avail);
-	}
-
-      /* EOF or error */
-      if (feof (stream) || ferror (stream))
-
-	/* Return partial line, if any */
-	if (read_pos == *lineptr)
-	  return -1;
-	else
-	  break;
-
-      *read_pos++ = c;
-      nchars_avail--;
-
-      /* Return line if NL */
-      if (c == '\n')
-	break;
-    }
-
-  /* Done - NUL terminate and return number of chars read */
-  *read_pos = '\0';
-  return (*n - nchars_avail);
-}
-
-#endif
+#include "linebuf.h"
+#include "outbuf.h"
+#include "cmdopt.h"
+#include "workpool.h"
+#include "msgcache.h"
+#include "msgapi.h"
 
 int parseincludes(MESSAGEINFO *messageinfo);
 int setupheader(MESSAGEINFO *messageinfo);
+void cachekey(MESSAGEINFO *messageinfo, CACHEKEY *key);
+uint32_t formatbody(MSGENTRY *entry, char *body);
+int buildmsgimage(MESSAGEINFO *messageinfo, OUTBUF *image);
 int writemsgfile(MESSAGEINFO *messageinfo);
+int buildvariant(MESSAGEINFO *messageinfo, char *arg, MESSAGEINFO *variant, OUTBUF *image);
+int writemultifile(MESSAGEINFO *messageinfo, char **variants, int count);
+int verifymsgfile(MESSAGEINFO *messageinfo);
+void showbytes(OUTBUF *log, char *label, char *data, uint32_t len, uint32_t offset);
 int writeasmfile(MESSAGEINFO *messageinfo);
-int writeheader(MESSAGEINFO *messageinfo);
+int writeheader(MESSAGEINFO *messageinfo, char *dest);
+int writecountryblock(MESSAGEINFO *messageinfo, char *dest);
+int patchbody(OUTBUF *ob, MSGFILE *mf, MSGENTRY *entry, uint32_t number);
+uint32_t patchlength(MSGFILE *mf, MSGENTRY *entry, uint32_t number);
+void putindex(char *index, uint32_t x, uint32_t offset, int offset16);
+int patchshared(char *target);
+int patchmsgfile(MESSAGEINFO *messageinfo, char *target);
 int DecodeLangOpt(char *dargs, MESSAGEINFO *messageinfo);
 
 // ouput display/helper functions
-void usagelong(void);
-void prgheading(void);
-void helpshort(void);
-void helplong(void);
-void ProgError(int exnum, char *dispmsg);
+void usagelong(OUTBUF *log);
+void prgheading(OUTBUF *log);
+void helpshort(OUTBUF *log);
+void helplong(OUTBUF *log);
+int ProgError(OUTBUF *log, int exnum, char *dispmsg);
+void msgprintf(OUTBUF *log, const char *format, ...);
+int isfilearg(char *arg);
+
+// language codes, see mkmsgf.h
+struct suppinfo langinfo[] = {
+    {"ARA", 1, 2, "Arabic", "Arab Countries"},
+    {"BGR", 2, 1, "Bulgarian", "Bulgaria"},
+    {"CAT", 3, 1, "Catalan", "Spain"},
+    {"CHT", 4, 1, "Traditional Chinese", "R.O.C."},
+    {"CHS", 4, 2, "Simplified Chinese", "P.R.C."},
+    {"CSY", 5, 1, "Czech", "Czechoslovakia"},
+    {"DAN", 6, 1, "Danish", "Denmark"},
+    {"DEU", 7, 1, "German", "Germany"},
+    {"DES", 7, 2, "Swiss German", "Switzerland"},
+    {"EEL", 8, 1, "Greek", "Greece"},
+    {"ENU", 9, 1, "US English", "United States"},
+    {"ENG", 9, 2, "UK English", "United Kingdom"},
+    {"ESP", 10, 1, "Castilian Spanish", "Spain"},
+    {"ESM", 10, 2, "Mexican Spanish", "Mexico"},
+    {"FIN", 11, 1, "Finnish", "Finland"},
+    {"FRA", 12, 1, "French", "France"},
+    {"FRB", 12, 2, "Belgian French", "Belgium"},
+    {"FRC", 12, 3, "Canadian French", "Canada"},
+    {"FRS", 12, 4, "Swiss French", "Switzerland"},
+    {"HEB", 13, 1, "Hebrew", "Israel"},
+    {"HUN", 14, 1, "Hungarian", "Hungary"},
+    {"ISL", 15, 1, "Icelandic", "Iceland"},
+    {"ITA", 16, 1, "Italian", "Italy"},
+    {"ITS", 16, 2, "Swiss Italian", "Switzerland"},
+    {"JPN", 17, 1, "Japanese", "Japan"},
+    {"KOR", 18, 1, "Korean", "Korea"},
+    {"NLD", 19, 1, "Dutch", "Netherlands"},
+    {"NLB", 19, 2, "Belgian Dutch", "Belgium"},
+    {"NOR", 20, 1, "Norwegian - Bokmal", "Norway"},
+    {"NON", 20, 2, "Norwegian - Nynorsk", "Norway"},
+    {"PLK", 21, 1, "Polish", "Poland"},
+    {"PTB", 22, 1, "Brazilian Portugues", "Brazil"},
+    {"PTG", 22, 2, "Portuguese", "Portugal"},
+    {"RMS", 23, 1, "Rhaeto-Romanic", "Switzerland"},
+    {"ROM", 24, 1, "Romanian", "Romania"},
+    {"RUS", 25, 1, "Russian", "Russia"},
+    {"SHL", 26, 1, "Croato-Serbian", "Yugoslavia"},
+    {"SHC", 26, 2, "Serbo-Croatian", "Yugoslavia"},
+    {"SKY", 27, 1, "Slovakian", "Czechoslovakia"},
+    {"SQI", 28, 1, "Albanian", "Albania"},
+    {"SVE", 29, 1, "Swedish", "Sweden"},
+    {"THA", 30, 1, "Thai", "Thailand"},
+    {"TRK", 31, 1, "Turkish", "Turkey"},
+    {"URD", 32, 1, "Urdu", "Pakistan"},
+    {"BAH", 33, 1, "Bahasa", "Indonesia"},
+    {"SLO", 34, 1, "Slovene", "Slovenia"},
+    {"MAX", 0, 0, "NONE", "NONE"},
+};
+
+// fake extended header appended by -F
+uint8_t extfake[4] = {0x2E, 0x01, 0x00, 0x00};
+
+// display output without a job log, stderr when the output is stdout,
+// only set by the main thread
+static FILE *screen;
+
+// 1= compiling the lines of a control file, no stdin / stdout files
+static uint8_t controlfile = 0;
 void displayinfo(MESSAGEINFO *messageinfo);
 
-int processparams(int argc, char *argv[])
+int processparams(int argc, char *argv[], OUTBUF *log, char *cachedir)
 {
     unsigned long rc = 0; // return code
     unsigned long dlrc = 0; // return code
     int ch = 0; // getopt variable
+    CMDOPT co;  // option parser state, one per command line
 
     // input/output file names and options
     // uint8_t os2ldr = 0;           // here but not used
     uint8_t ibm_format_input = 0; // 1= IBM compatabile input args
     uint8_t outfile_provided = 0; // output file in args
+    uint8_t helponly = 0;         // 1= help displayed, nothing to compile
+    uint8_t cachehit = 0;         // 1= output taken from the cache
+    uint8_t verify = 0;           // 1= /T round trip check, no output
+    char *patchfile = NULL;       // /U MSG file to patch
+    char *variants[MAX_LANG_VARIANTS]; // /X language variants
+    int variantcount = 0;
+    CACHEKEY key;                 // cache key of this compile
+    char *cacheext = NULL;        // cache entry type
 
     // getopt options
     uint8_t verbose = 0;   // verbose output
@@ -202,6 +184,14 @@ int processparams(int argc, char *argv[])
     messageinfo.identifier[3] = 0;
     messageinfo.asm_format_output = 0; // 1= include is ASM INC
     messageinfo.c_format_output = 0; // 1= include is C H
+    messageinfo.indexwidth = 0;        // 0= pick uint16/uint32 index
+    messageinfo.msgtable = NULL;
+    messageinfo.cachedir = cachedir;   // -k on the line overrides
+    messageinfo.msgids = NULL;
+    messageinfo.log = log;
+    memset(&messageinfo.source, 0, sizeof(LINEBUF));
+
+    CmdOptInit(&co);
 
     /* *********************************************************************
      * The following is to just keep the input options getopt and IBM mkmsgf
@@ -212,20 +202,20 @@ int processparams(int argc, char *argv[])
     // is the input file first? yes, make compatable with IBM program
     // so if the first option does not start with / or - then assume it
     // is a filename
-    if ((*argv[1] != '-') && (*argv[1] != '/')) // first arg prefix - or / ?
+    if (isfilearg(argv[1])) // first arg prefix - or / ?
     {
-        strncpy(messageinfo.infile, argv[optind], sizeof(messageinfo.infile)-1);
-        optind++;
+        strncpy(messageinfo.infile, argv[co.optind], sizeof(messageinfo.infile)-1);
+        co.optind++;
 
         ++ibm_format_input; // set ibm format
 
         // we know IBM format so check for output file
         if (argc > 2)
         {
-            if ((*argv[2] != '-') && (*argv[2] != '/')) // first arg prefix - or / ?
+            if (isfilearg(argv[2])) // first arg prefix - or / ?
             {
-                strncpy(messageinfo.outfile, argv[optind], sizeof(messageinfo.outfile)-1);
-                optind++;
+                strncpy(messageinfo.outfile, argv[co.optind], sizeof(messageinfo.outfile)-1);
+                co.optind++;
 
                 ++outfile_provided; // have output file
             }
@@ -235,14 +225,15 @@ int processparams(int argc, char *argv[])
     // just cuz - zero out a couple vars
     messageinfo.codepagesnumber = 0;
 
-    // Get program arguments using getopt()
-    while ((ch = getopt(argc, argv, "d:D:eEp:P:l:L:VvHhI:i:AaCcQq")) != -1)
+    // Get program arguments, errors end the loop with rc set
+    while (rc == MKMSG_NOERROR && !helponly &&
+           (ch = CmdOptGet(&co, argc, argv, "d:D:eEp:P:l:L:VvHhI:i:AaCcQqTtu:U:w:W:k:K:x:X:")) != -1)
     {
         switch (ch)
         {
         case 'd':
         case 'D':
-            ProgError(MKMSG_GETOPT_ERROR, "MKMSGF: Sorry, DBCS not supported");
+            rc = ProgError(log, MKMSG_GETOPT_ERROR, "MKMSGF: Sorry, DBCS not supported");
             break;
 
         case 'e':
@@ -254,18 +245,19 @@ int processparams(int argc, char *argv[])
         case 'P':
             if (messageinfo.codepagesnumber < 16)
             {
-                messageinfo.codepages[messageinfo.codepagesnumber++] = atoi(optarg);
+                messageinfo.codepages[messageinfo.codepagesnumber++] = atoi(co.optarg);
             }
             else
-                ProgError(MKMSG_GETOPT_ERROR, "MKMSGF: More than 16 codepages entered");
+                rc = ProgError(log, MKMSG_GETOPT_ERROR, "MKMSGF: More than 16 codepages entered");
             break;
 
         case 'l':
         case 'L':
             // only going to process first L option - only one allowed
             if (proclang)
-                ProgError(MKMSG_GETOPT_ERROR, "MKMSGF: Syntax error L option");
-            proclang = DecodeLangOpt(optarg, &messageinfo);
+                rc = ProgError(log, MKMSG_GETOPT_ERROR, "MKMSGF: Syntax error L option");
+            else
+                proclang = DecodeLangOpt(co.optarg, &messageinfo);
             break;
 
         case 'v':
@@ -277,9 +269,9 @@ int processparams(int argc, char *argv[])
         case '?':
         case 'h':
         case 'H':
-            prgheading();
-            usagelong();
-            exit(0);
+            prgheading(log);
+            usagelong(log);
+            ++helponly;
             break;
 
             // Undocumented IBM flags
@@ -290,7 +282,8 @@ int processparams(int argc, char *argv[])
 			break;
         case 'i': // include path, only for A and C
         case 'I':
-			messageinfo.include=strdup(optarg);
+			free(messageinfo.include);
+			messageinfo.include=strdup(co.optarg);
 			break;
         case 'c': // the real mkmsgf outputs asm file and parses .H files
         case 'C':
@@ -304,8 +297,38 @@ int processparams(int argc, char *argv[])
                 ++dispquiet;
             break;
 
+        case 't': // compile, decompile and compare in memory
+        case 'T':
+            verify = 1;
+            break;
+
+        case 'u': // patch the messages into an existing MSG file
+        case 'U':
+            patchfile = co.optarg;
+            break;
+
+        case 'w': // force index width, default is smallest that fits
+        case 'W':
+            messageinfo.indexwidth = atoi(co.optarg);
+            if (messageinfo.indexwidth != 16 && messageinfo.indexwidth != 32)
+                rc = ProgError(log, MKMSG_GETOPT_ERROR, "MKMSGF: Index width must be 16 or 32");
+            break;
+
+        case 'k': // compile cache directory
+        case 'K':
+            messageinfo.cachedir = co.optarg;
+            break;
+
+        case 'x': // language variant: file,family,sub[,codepage...]
+        case 'X':
+            if (variantcount < MAX_LANG_VARIANTS)
+                variants[variantcount++] = co.optarg;
+            else
+                rc = ProgError(log, MKMSG_GETOPT_ERROR, "MKMSGF: Too many /X language variants");
+            break;
+
         default:
-            ProgError(MKMSG_GETOPT_ERROR, "MKMSGF: Syntax error unknown option");
+            rc = ProgError(log, MKMSG_GETOPT_ERROR, "MKMSGF: Syntax error unknown option");
             break;
         }
     }
@@ -316,20 +339,27 @@ int processparams(int argc, char *argv[])
 
     // check for input file - getopt compatable cmd line
     // we either have in/out files or it is error
-    if ((argc == optind) && !ibm_format_input)
-        ProgError(MKMSG_NOINPUT_ERROR, "MKMSGF: no input file");
+    if (rc == MKMSG_NOERROR && !helponly &&
+        (argc == co.optind) && !ibm_format_input)
+        rc = ProgError(log, MKMSG_NOINPUT_ERROR, "MKMSGF: no input file");
+
+    if (rc != MKMSG_NOERROR || helponly)
+    {
+        free(messageinfo.include);
+        return (rc);
+    }
 
     // if ibm_format_input is false then using new format
     // so we need to get input file and maybe the output file
     if (!ibm_format_input)
     {
-        strncpy(messageinfo.infile, argv[optind], sizeof(messageinfo.infile)-1);
-        optind++;
+        strncpy(messageinfo.infile, argv[co.optind], sizeof(messageinfo.infile)-1);
+        co.optind++;
 
-        if (argc != optind)
+        if (argc != co.optind)
         {
-            strncpy(messageinfo.outfile, argv[optind], sizeof(messageinfo.outfile)-1);
-            optind++;
+            strncpy(messageinfo.outfile, argv[co.optind], sizeof(messageinfo.outfile)-1);
+            co.optind++;
 
             ++outfile_provided; // have output file
         }
@@ -340,11 +370,12 @@ int processparams(int argc, char *argv[])
      * 3. If no output file, generate out file name
      */
 
-    // setup and check the input / output files
-    if (access(messageinfo.infile, F_OK) != 0)
+    // setup and check the input / output files, - is stdin
+    if (strcmp(messageinfo.infile, "-") != 0 && access(messageinfo.infile, F_OK) != 0)
 	{
-		printf(messageinfo.infile);
-        ProgError(MKMSG_INPUT_ERROR, "MKMSGF: Input file does not exist.");
+		msgprintf(log, "%s", messageinfo.infile);
+        free(messageinfo.include);
+        return (ProgError(log, MKMSG_INPUT_ERROR, "MKMSGF: Input file does not exist."));
 	}
 
     // splitup input file
@@ -358,86 +389,419 @@ int processparams(int argc, char *argv[])
     {
         for (int x = 0; x < _MAX_PATH; x++)
             messageinfo.outfile[x] = 0x00;
-		if (messageinfo.asm_format_output||messageinfo.c_format_output)
+        // stdin in, stdout out
+        if (!strcmp(messageinfo.infile, "-"))
+            strcpy(messageinfo.outfile, "-");
+		else if (messageinfo.asm_format_output||messageinfo.c_format_output)
 			sprintf(messageinfo.outfile, "%s%s", messageinfo.infname, ".asm");
 		else
         sprintf(messageinfo.outfile, "%s%s", messageinfo.infname, ".msg");
     }
-    // check input == output file
-    if (!strcmp(messageinfo.infile, messageinfo.outfile))
-        ProgError(MKMSG_IN_OUT_COMPARE, "MKMSGF: Input file same as output file");
+    // check input == output file, stdin to stdout is fine
+    if (!strcmp(messageinfo.infile, messageinfo.outfile) && strcmp(messageinfo.infile, "-"))
+    {
+        free(messageinfo.include);
+        return (ProgError(log, MKMSG_IN_OUT_COMPARE, "MKMSGF: Input file same as output file"));
+    }
+
+    // control file jobs share stdin / stdout, /U patches a real file
+    if ((controlfile && (!strcmp(messageinfo.infile, "-") || !strcmp(messageinfo.outfile, "-"))) ||
+        (patchfile != NULL && !strcmp(patchfile, "-")))
+    {
+        free(messageinfo.include);
+        return (ProgError(log, MKMSG_GETOPT_ERROR, "MKMSGF: - (stdin/stdout) not allowed here"));
+    }
+
+    // output to stdout, keep the display out of it. Only a job without
+    // a log displays on the screen, that is the command line job on the
+    // main thread, -j jobs never touch screen
+    if (log == NULL && !strcmp(messageinfo.outfile, "-"))
+        screen = stderr;
+
+    if ((verify || patchfile) &&
+        (messageinfo.asm_format_output || messageinfo.c_format_output))
+    {
+        free(messageinfo.include);
+        return (ProgError(log, MKMSG_GETOPT_ERROR, "MKMSGF: /T and /U only work for MSG output"));
+    }
+
+    if (variantcount && (verify || patchfile ||
+        messageinfo.asm_format_output || messageinfo.c_format_output))
+    {
+        free(messageinfo.include);
+        return (ProgError(log, MKMSG_GETOPT_ERROR, "MKMSGF: /X only works for MSG output"));
+    }
+
+    cacheext = (messageinfo.asm_format_output||messageinfo.c_format_output) ? "asm" : "msg";
 
     // ************ done with args ************
 
-    // decompile header/ input file info
-    rc = setupheader(&messageinfo);
+    // map input file
+    rc = LineBufOpen(&messageinfo.source, messageinfo.infile);
     if (rc != MKMSG_NOERROR)
-        ProgError(rc, "MKMSGF: MSG header setup error");
+        ProgError(log, rc, "MKMSGF: Input file read error");
 
-    // display info on screen
-    displayinfo(&messageinfo);
-
-	if (messageinfo.asm_format_output||messageinfo.c_format_output)
+    // ASM/C output needs the message IDs from the include files
+	if (rc == MKMSG_NOERROR &&
+		(messageinfo.asm_format_output||messageinfo.c_format_output))
 	{
-		messageinfo.msgids=CreateList();
+		// symbols are only read and freed with the list, names and
+		// link nodes go into the arena of the list
+		messageinfo.msgids=CreateArenaList(0);
+		if (messageinfo.msgids == NULL)
+		{
+			rc = MKMSG_MEM_ERROR1;
+			ProgError(log, rc, "MKMSGF: Message ID list allocate error");
+		}
 
-		rc = parseincludes(&messageinfo);
-		if (rc != MKMSG_NOERROR)
+		if (rc == MKMSG_NOERROR)
 		{
-			DestroyList(&messageinfo.msgids, TRUE, &dlrc);
-			if (dlrc != DLIST_SUCCESS)
-			{
-				ProgError(rc, "MKMSGF: DLIST destroy error");
-			}
-			ProgError(rc, "MKMSGF: INC file read error");
+			rc = parseincludes(&messageinfo);
+			if (rc != MKMSG_NOERROR)
+				ProgError(log, rc, "MKMSGF: INC file read error");
 		}
-		rc = writeasmfile(&messageinfo);
-		if (rc != MKMSG_NOERROR)
+
+		// ASM labels are looked up by message number, without the index
+		// FindItemsByTag walks the list and finds the same labels in the
+		// same order
+		if (rc == MKMSG_NOERROR)
 		{
-			DestroyList(&messageinfo.msgids, TRUE, &dlrc);
+			CreateTagIndex(messageinfo.msgids, &dlrc);
 			if (dlrc != DLIST_SUCCESS)
-			{
-				ProgError(rc, "MKMSGF: DLIST destroy error");
-			}
-			ProgError(rc, "MKMSGF: ASM file write error");
+				ProgError(log, -1, "MKMSGF: No message ID index, labels are searched in the list");
 		}
+	}
+
+    // same input as a previous compile? then take its output, the key
+    // does not cover /X input files, the cache only works with files
+    if (messageinfo.cachedir != NULL && !strcmp(messageinfo.outfile, "-"))
+        messageinfo.cachedir = NULL;
+
+    if (rc == MKMSG_NOERROR && messageinfo.cachedir != NULL &&
+        !verify && !patchfile && !variantcount)
+    {
+        cachekey(&messageinfo, &key);
+        if (CacheFetch(messageinfo.cachedir, key, cacheext, messageinfo.outfile) == MKMSG_NOERROR)
+        {
+            msgprintf(log, "%s: cached\n", messageinfo.outfile);
+            cachehit = 1;
+        }
+    }
+
+    // decompile header/ input file info
+    // read input and build message table
+    if (rc == MKMSG_NOERROR && !cachehit)
+    {
+        rc = setupheader(&messageinfo);
+        if (rc == MKMSG_INDEX_OVERFLOW)
+            ProgError(log, rc, "MKMSGF: Messages do not fit a 16 bit index (-W 16)");
+        else if (rc == MKMSG_COUNTRY_OVERFLOW)
+            ProgError(log, rc, "MKMSGF: Too many messages, the country info offset is 16 bits (16376 messages at most)");
+        else if (rc != MKMSG_NOERROR)
+            ProgError(log, rc, "MKMSGF: MSG header setup error");
+        else
+            // display info on screen
+            displayinfo(&messageinfo);
+
+        if (rc != MKMSG_NOERROR)
+        {
+            // nothing to write
+        }
+        else if (patchfile)
+        {
+            rc = patchmsgfile(&messageinfo, patchfile);
+            if (rc != MKMSG_NOERROR)
+                ProgError(log, rc, "MKMSGF: MSG file patch error");
+        }
+        else if (verify)
+        {
+            rc = verifymsgfile(&messageinfo);
+            if (rc != MKMSG_NOERROR)
+                ProgError(log, rc, "MKMSGF: MSG file verify error");
+        }
+        else if (variantcount)
+        {
+            rc = writemultifile(&messageinfo, variants, variantcount);
+            if (rc == MKMSG_VARIANT_DUP)
+                ProgError(log, rc, "MKMSGF: Language variant with the same language and codepage as another");
+            else if (rc == MKMSG_LANG_OUT_RANGE || rc == MKMSG_SUBID_OUT_RANGE)
+                ProgError(log, rc, "MKMSGF: Language variant with an unknown language");
+            else if (rc != MKMSG_NOERROR)
+                ProgError(log, rc, "MKMSGF: MSG file write error");
+        }
+        else if (messageinfo.asm_format_output||messageinfo.c_format_output)
+        {
+            rc = writeasmfile(&messageinfo);
+            if (rc != MKMSG_NOERROR)
+                ProgError(log, rc, "MKMSGF: ASM file write error");
+        }
+        else
+        {
+            rc = writemsgfile(&messageinfo);
+            if (rc != MKMSG_NOERROR)
+                ProgError(log, rc, "MKMSGF: MSG file write error");
+        }
+
+        // a failed cache store only costs the next compile
+        if (rc == MKMSG_NOERROR && messageinfo.cachedir != NULL &&
+            !verify && !patchfile && !variantcount)
+            if (CacheStore(messageinfo.cachedir, key, cacheext, messageinfo.outfile) != MKMSG_NOERROR)
+                ProgError(log, -1, "MKMSGF: Could not store output in cache");
+    }
+
+	if (messageinfo.msgids != NULL)
+	{
 		DestroyList(&messageinfo.msgids, TRUE, &dlrc);
 		if (dlrc != DLIST_SUCCESS)
 		{
-			ProgError(rc, "MKMSGF: DLIST destroy error");
+			ProgError(log, rc, "MKMSGF: DLIST destroy error");
 		}
-	} else {
-    rc = writeheader(&messageinfo);
+	}
 
-    if (rc != MKMSG_NOERROR)
-        ProgError(rc, "MKMSGF: MSG Header write error");
+    free(messageinfo.msgtable);
+    free(messageinfo.include);
+    LineBufClose(&messageinfo.source);
 
-		rc = writemsgfile(&messageinfo);
-		
+    // if you don't see this then I screwed up
+	if (rc == MKMSG_NOERROR)
+		msgprintf(log, "\nEnd compile\n");
+
+	return(rc);
+}
+
+/*************************************************************************
+ * Control file (@file) support
+ *
+ * Each line of the control file is one mkmsgf command line. The whole
+ * control file is parsed into a job list first, each job has its own
+ * copy of the line, its own argv and its own output log. With -j N the
+ * jobs are compiled on N threads, the job logs are printed in control
+ * file order as soon as all jobs before them are done.
+ *************************************************************************/
+
+typedef struct _CTLJOB
+{
+    char *line;     // copy of the control file line, argv points into it
+    int argc;
+    char **argv;
+    OUTBUF log;     // everything the job displays
+    int rc;         // job return code
+    uint8_t done;   // job finished
+} CTLJOB;
+
+typedef struct _CTLFILE
+{
+    CTLJOB *jobs;
+    int count;      // number of jobs
+    int printed;    // jobs with their log printed, in order
+    char *cachedir; // -k for all jobs
+} CTLFILE;
+
+/*
+ * splitargs( )
+ *
+ * split a control file line at spaces/tabs in place into argv,
+ * argv[0] is the program name. Returns argc.
+ */
+int splitargs(char *line, char *argv0, char **argv, int maxargs)
+{
+    int argc = 0;
+    char *p = line;
+
+    argv[argc++] = argv0;
+
+    while (*p && argc < maxargs - 1)
+    {
+        while (*p == ' ' || *p == '\t')
+            *p++ = 0x00;
+        if (*p == 0x00)
+            break;
+
+        argv[argc++] = p;
+
+        while (*p && *p != ' ' && *p != '\t')
+            p++;
+    }
+    argv[argc] = NULL;
+
+    return (argc);
+}
+
+/*************************************************************************
+ * Function:  readcontrolfile( )
+ *
+ * Read the control file into a job list, empty lines are skipped
+ *
+ * Return:    returns error code or 0 for all good
+ *************************************************************************/
+
+int readcontrolfile(char *filename, char *argv0, CTLFILE *ctl)
+{
+    enum { kMaxArgs = 64 };
+    LINEBUF ctlsrc;
+    CTLJOB *job = NULL;
+    char *start = NULL;
+    char *next = NULL;
+    int tablesize = 0;
+    int rc = 0;
+
+    ctl->jobs = NULL;
+    ctl->count = 0;
+    ctl->printed = 0;
+
+    rc = LineBufOpen(&ctlsrc, filename);
     if (rc != MKMSG_NOERROR)
-		{
-        ProgError(rc, "MKMSGF: MSG file write error");
-		}
-	}
+        return (rc);
 
-    // if you don't see this then I screwed up
-    printf("\nEnd compile\n");
+    while ((start = LineBufNext(&ctlsrc, &next)) != NULL)
+    {
+        if (ctl->count == tablesize)
+        {
+            tablesize = tablesize ? tablesize * 2 : 64;
+            job = (CTLJOB *)realloc(ctl->jobs, tablesize * sizeof(CTLJOB));
+            if (job == NULL)
+            {
+                LineBufClose(&ctlsrc);
+                return (MKMSG_MEM_ERROR1);
+            }
+            ctl->jobs = job;
+        }
+
+        job = &ctl->jobs[ctl->count];
+        memset(job, 0, sizeof(CTLJOB));
 
-	return(0);
+        job->line = (char *)malloc(next - start + 1);
+        job->argv = (char **)malloc(kMaxArgs * sizeof(char *));
+        if (job->line == NULL || job->argv == NULL)
+        {
+            free(job->line);
+            free(job->argv);
+            LineBufClose(&ctlsrc);
+            return (MKMSG_MEM_ERROR1);
+        }
+
+        if (LineBufCopy(start, next, job->line, next - start + 1) == 0)
+        {
+            free(job->line);
+            free(job->argv);
+            continue;
+        }
+
+        // the command line is shown before the job output
+        OutBufInit(&job->log, 0);
+        OutBufPrintf(&job->log, "%s\n", job->line);
+
+        job->argc = splitargs(job->line, argv0, job->argv, kMaxArgs);
+        if (job->argc < 2)
+        {
+            OutBufFree(&job->log);
+            free(job->line);
+            free(job->argv);
+            continue;
+        }
+
+        ctl->count++;
+    }
+
+    LineBufClose(&ctlsrc);
+
+    return (MKMSG_NOERROR);
+}
+
+/*
+ * runjob( ) - WorkPoolRun job callback, compile one control file line
+ */
+void runjob(void *context, int index)
+{
+    CTLJOB *job = &((CTLFILE *)context)->jobs[index];
+
+    job->rc = processparams(job->argc, job->argv, &job->log, ((CTLFILE *)context)->cachedir);
+}
+
+/*
+ * jobdone( ) - WorkPoolRun done callback, runs under the pool lock.
+ * Print all finished job logs that are next in control file order.
+ */
+void jobdone(void *context, int index)
+{
+    CTLFILE *ctl = (CTLFILE *)context;
+    CTLJOB *job = NULL;
+
+    ctl->jobs[index].done = 1;
+
+    while (ctl->printed < ctl->count && ctl->jobs[ctl->printed].done)
+    {
+        job = &ctl->jobs[ctl->printed++];
+        fwrite(job->log.data, sizeof(char), job->log.size, stdout);
+        fflush(stdout);
+        OutBufFree(&job->log);
+    }
 }
 
 /*************************************************************************
- * Main( )
+ * Function:  runcontrolfile( )
  *
- * Entry into the program
+ * Compile all jobs of a control file
  *
- * Expects a valid txt filey. Will name the output file using the input
- * file and the MSG extention if an output filename is not provided.
+ * 1 Read control file into the job list
+ * 2 1 thread: compile in order, output goes straight to the screen and
+ *   the first error stops the run
+ *   N threads: compile all jobs on the worker pool, output in order
+ * 3 Return code is the one of the first job that failed
  *
- **********************************/
+ * Return:    returns error code or 0 for all good
+ *************************************************************************/
+
+int runcontrolfile(char *filename, char *argv0, int threads, char *cachedir)
+{
+    CTLFILE ctl;
+    CTLJOB *job = NULL;
+    int rc = 0;
+
+    rc = readcontrolfile(filename, argv0, &ctl);
+    if (rc != MKMSG_NOERROR)
+    {
+        ProgError(NULL, rc, "MKMSGF: Control file read error");
+        return (rc);
+    }
+    ctl.cachedir = cachedir;
+    controlfile = 1;
+
+    if (threads <= 1)
+    {
+        for (int x = 0; x < ctl.count && rc == MKMSG_NOERROR; x++)
+        {
+            job = &ctl.jobs[x];
+            fwrite(job->log.data, sizeof(char), job->log.size, stdout);
+            fflush(stdout);
+            rc = processparams(job->argc, job->argv, NULL, cachedir);
+        }
+    }
+    else
+    {
+        WorkPoolRun(threads, ctl.count, runjob, jobdone, &ctl);
+
+        for (int x = 0; x < ctl.count && rc == MKMSG_NOERROR; x++)
+            rc = ctl.jobs[x].rc;
+    }
+
+    for (int x = 0; x < ctl.count; x++)
+    {
+        OutBufFree(&ctl.jobs[x].log);
+        free(ctl.jobs[x].line);
+        free(ctl.jobs[x].argv);
+    }
+    free(ctl.jobs);
+
+    return (rc);
+}
 
 int main(int argc, char *argv[])
 {
+    char *ctlfile = NULL; // @ control file
+    int threads = 1;      // -j N
+    char *cachedir = NULL; // -k dir for all control file lines
+
     // these I found in the disassembled code, here for reference
     // but not used - just for reference
     // uint8_t *mkmsgfprog = getenv("MKMSGF_PROG");
@@ -445,158 +809,274 @@ int main(int argc, char *argv[])
     //    if (!strncmp(mkmsgfprog, "OS2LDR", 6))
     //        os2ldr = 1;
 
+    screen = stdout;
+
     // no args - print usage and exit
     if (argc == 1)
     {
-        prgheading(); // display program heading
-        helpshort();
+        prgheading(NULL); // display program heading
+        helpshort(NULL);
         exit(MKMSG_NOERROR);
     }
 
-	// Control file
-	if ((*argv[1] == '@'))
+	// Control file, the only other options allowed are -j N and -k dir
+	for (int x = 1; x < argc; x++)
+		if (*argv[x] == '@')
+			ctlfile = argv[x] + 1;
+
+	if (ctlfile != NULL)
 	{
-		char *line=NULL;
-		unsigned int line_size=sizeof(line);
-		char *fakeargv[10];	// 10 args
-		char *param;
-		int fakeargc;
-		FILE* file = fopen(argv[1]+1, "r");
-
-		while (!feof(file))
+		for (int x = 1; x < argc; x++)
 		{
-			getline(&line, &line_size, file);
-			if (feof(file)) break;
-			printf("%s\n", line);
-			flushall();
-			enum { kMaxArgs = 64 };
-			int fakeargc = 0;
-			char *fakeargv[kMaxArgs];
-			
-			fakeargv[fakeargc++] = argv[0];
-
-			char *p2 = strtok(line, " ");
-			while (p2 && fakeargc < kMaxArgs-1)
+			if (*argv[x] == '@')
+				continue;
+
+			if (CmdOptSwitch(*argv[x]) && (argv[x][1] == 'j' || argv[x][1] == 'J'))
 			{
-				fakeargv[fakeargc++] = p2;
-				p2 = strtok(0, " ");
+				if (argv[x][2])
+					threads = atoi(&argv[x][2]);
+				else if (x + 1 < argc)
+					threads = atoi(argv[++x]);
+				else
+					threads = 0;
+
+				if (threads < 1 || threads > WORKPOOL_MAX)
+					exit(ProgError(NULL, MKMSG_GETOPT_ERROR, "MKMSGF: -j needs 1 to 64 jobs"));
 			}
-			fakeargv[fakeargc] = 0;
-			processparams(fakeargc, fakeargv);
-			optind=1;
+			else if (CmdOptSwitch(*argv[x]) && (argv[x][1] == 'k' || argv[x][1] == 'K'))
+			{
+				if (argv[x][2])
+					cachedir = &argv[x][2];
+				else if (x + 1 < argc)
+					cachedir = argv[++x];
+				else
+					exit(ProgError(NULL, MKMSG_GETOPT_ERROR, "MKMSGF: -k needs a directory"));
+			}
+			else
+				exit(ProgError(NULL, MKMSG_GETOPT_ERROR, "MKMSGF: Syntax error with @ control file"));
 		}
-		fclose(file);
-        exit(MKMSG_NOERROR);
+
+        exit(runcontrolfile(ctlfile, argv[0], threads, cachedir));
 	}
 
 	// single file
-	processparams(argc, argv);
-    exit(MKMSG_NOERROR);
+    exit(processparams(argc, argv, NULL, NULL));
+}
+
+/*
+ * cachekeyitem( ) - ForEachItem callback, add one include symbol
+ */
+void cachekeyitem(ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, ADDRESS ObjectHandle, ADDRESS Parameters, CARDINAL32 * Error)
+{
+    uint32_t tag = ObjectTag;
+
+    (void) ObjectSize;
+    (void) ObjectHandle;
+
+    CacheKeyAdd((CACHEKEY *)Parameters, Object, strlen((char *)Object) + 1);
+    CacheKeyAdd((CACHEKEY *)Parameters, &tag, sizeof(tag));
+    *Error = DLIST_SUCCESS;
+}
+
+/*************************************************************************
+ * Function:  cachekey( )
+ *
+ * Compile cache key, a hash of everything the output depends on
+ *
+ * 1 Program version, a new version may compile differently
+ * 2 Options that change the output and the output file name, which
+ *   is stored in the MSG file
+ * 3 Source file bytes
+ * 4 Message ID symbols from the include files (ASM/C output)
+ *
+ *************************************************************************/
+
+void cachekey(MESSAGEINFO *messageinfo, CACHEKEY *key)
+{
+    unsigned long rc = 0;
+    uint16_t opts[8];
+
+    CacheKeyInit(key);
+
+    CacheKeyAdd(key, SYSLVERSION, sizeof(SYSLVERSION));
+
+    opts[0] = messageinfo->langfamilyID;
+    opts[1] = messageinfo->langversionID;
+    opts[2] = messageinfo->bytesperchar;
+    opts[3] = messageinfo->fakeextend;
+    opts[4] = messageinfo->asm_format_output;
+    opts[5] = messageinfo->c_format_output;
+    opts[6] = messageinfo->indexwidth;
+    opts[7] = messageinfo->codepagesnumber;
+    CacheKeyAdd(key, opts, sizeof(opts));
+    CacheKeyAdd(key, messageinfo->codepages,
+                messageinfo->codepagesnumber * sizeof(uint16_t));
+    CacheKeyAdd(key, messageinfo->outfile, strlen(messageinfo->outfile) + 1);
+
+    CacheKeyAdd(key, messageinfo->source.data, messageinfo->source.size);
+
+    if (messageinfo->msgids != NULL)
+        ForEachItem(messageinfo->msgids, &cachekeyitem, (ADDRESS)key, TRUE, &rc);
 }
 
 /*************************************************************************
  * Function:  setupheader( )
  *
- * Gets and stores header info in MESSAGEINFO structure
+ * Reads the input file once, builds the message table and stores
+ * header info in MESSAGEINFO structure
  *
- * 1. Open input file
+ * 1. Input file is already mapped into messageinfo->source
  * 2. Read past comments
- * 3. Get identifer and save file read position
- * 1. Get start message number
- * 2. Get number of messages
- * 3. determine index pointer and size uint8/uint32
+ * 3. Get identifer
+ * 4. Build message table, one entry for each message: number, type
+ *    and the lines of the message (continuation lines included)
+ * 5. Get start message number and number of messages
+ * 6. Get compiled length of each message
+ * 7. determine index pointer and size uint16/uint32 from the real end
+ *    offset of the last message
  *
  * Return:    returns error code or 0 for all good
  *************************************************************************/
 
 int setupheader(MESSAGEINFO *messageinfo)
 {
-    size_t buffer_size = 0;
-    char *read_buffer = NULL;
     char msgnum[5] = {0};
-    int first = 1;
+    char *line = NULL;        // current line
+    char *next = NULL;        // line after current line
+    char *srcend = NULL;      // end of input buffer
+    MSGENTRY *entry = NULL;   // message being collected
+    uint32_t tablesize = 0;   // allocated message table entries
+    uint32_t msgbytes = 0;    // size of all compiled messages
+    uint32_t end16 = 0;       // end of messages with a uint16 index
 
-    messageinfo->msgstartline = 0;
+    messageinfo->msgtable = NULL;
 
-    // open input file
-    FILE *fpi = fopen(messageinfo->infile, "rb");
-    if (fpi == NULL)
-        return (MKMSG_OPEN_ERROR);
+    srcend = messageinfo->source.data + messageinfo->source.size;
 
-    // get identifer and save, keep track of identifer line
-    // number
-    while (TRUE)
+    // get identifer and save, skip comments
+    for (line = messageinfo->source.data; line < srcend; line = next)
     {
-        size_t n = 0;
-        char *line = NULL;
-
-        getline(&line, &n, fpi);
+        next = LineBufEOL(line, srcend);
 
         if (line[0] != ';')
-        {
-            if (strlen(line) > 5) // identifer (3) + 0x0D 0x0A (2)
-                exit(99);
-            messageinfo->identifier[0] = line[0];
-            messageinfo->identifier[1] = line[1];
-            messageinfo->identifier[2] = line[2];
-
-            fgetpos(fpi, &messageinfo->msgstartline);
             break;
-        }
     }
 
+    // identifer (3) + 0x0D 0x0A (2)
+    if (line >= srcend || (next - line) > 5 || (next - line) < 3)
+        return (MKMSG_IDENT_ERROR);
+
+    messageinfo->identifier[0] = line[0];
+    messageinfo->identifier[1] = line[1];
+    messageinfo->identifier[2] = line[2];
+    messageinfo->identifier[3] = 0x00;
+
     // make sure number of messages is 0
     messageinfo->numbermsg = 0;
 
-    // Get message start number and number of messages
-    while (TRUE)
+    // Build the message table - the rest of the file is read only
+    // this one time
+    for (line = next; line < srcend; line = next)
     {
-        // this should be the first message line
-        getline(&read_buffer, &buffer_size, fpi);
+        next = LineBufEOL(line, srcend);
 
-        // if end of file get out of loop
-        if (feof(fpi))
-            break;
+        // skip comments
+        if (line[0] == ';')
+            continue;
 
-        if (strncmp(messageinfo->identifier, read_buffer, 3) == 0)
+        // check if ID which indicates message start
+        if ((next - line) > 7 &&
+            strncmp((char *)messageinfo->identifier, line, 3) == 0)
         {
-            messageinfo->numbermsg++;
-
-            if (first) // first message - get start number
+            // is the message type valid
+            if (line[7] != 'E' && line[7] != 'H' &&
+                line[7] != 'I' && line[7] != 'P' &&
+                line[7] != 'W' && line[7] != '?')
+                return (MKMSG_BAD_TYPE);
+
+            // grow message table if needed
+            if (messageinfo->numbermsg == tablesize)
             {
-                first = 0;
-                sprintf(msgnum, "%c%c%c%c",
-                        read_buffer[3],
-                        read_buffer[4],
-                        read_buffer[5],
-                        read_buffer[6]);
-
-                messageinfo->firstmsg = atoi(msgnum);
+                // far more than the country info offset allows
+                if (tablesize == 0xFFFF)
+                    return (MKMSG_COUNTRY_OVERFLOW);
+
+                tablesize = tablesize ? tablesize * 2 : 256;
+                if (tablesize > 0xFFFF)
+                    tablesize = 0xFFFF;
+
+                entry = (MSGENTRY *)realloc(messageinfo->msgtable,
+                                            tablesize * sizeof(MSGENTRY));
+                if (entry == NULL)
+                    return (MKMSG_MEM_ERROR2);
+
+                messageinfo->msgtable = entry;
             }
+
+            entry = &messageinfo->msgtable[messageinfo->numbermsg++];
+
+            sprintf(msgnum, "%c%c%c%c", line[3], line[4], line[5], line[6]);
+            entry->number = atoi(msgnum);
+            entry->type = line[7];
+            entry->start = line;
+        }
+        else if (entry == NULL)
+        {
+            // nothing before the first message belongs to a message
+            continue;
         }
-    }
 
-    fclose(fpi);
-    free(read_buffer);
+        // message runs at least to the end of this line
+        entry->end = next;
+    }
 
-    // calculate whether to use uint16 or uint32 for index
-    int handle = open(messageinfo->infile, O_RDONLY | O_TEXT);
-    if (handle == -1)
-        return (MKMSG_OFFID_ERR);
+    if (messageinfo->numbermsg)
+        messageinfo->firstmsg = messageinfo->msgtable[0].number;
     else
+        messageinfo->firstmsg = 0;
+
+    // compiled length of each message, summed up for the message area
+    for (int count = 0; count < messageinfo->numbermsg; count++)
     {
-        if (_filelength(handle) <= 40000) // using 50K as pointer tripwire
-            messageinfo->offsetid = 1;
-        else
-            messageinfo->offsetid = 0;
-        close(handle);
+        entry = &messageinfo->msgtable[count];
+        entry->length = formatbody(entry, NULL);
+        msgbytes += entry->length;
     }
+
+    // calculate whether to use uint16 or uint32 for index - uint16 if
+    // the end of the last message behind a uint16 index still fits in
+    // 16 bits, unless forced by the -w option
+    end16 = sizeof(MSGHEADER) + messageinfo->numbermsg * 2 +
+            sizeof(FILECOUNTRYINFO) + msgbytes;
+
+    switch (messageinfo->indexwidth)
+    {
+    case 16:
+        if (end16 > 0xFFFF)
+            return (MKMSG_INDEX_OVERFLOW);
+        messageinfo->offsetid = 1;
+        break;
+
+    case 32:
+        messageinfo->offsetid = 0;
+        break;
+
+    default:
+        messageinfo->offsetid = (end16 <= 0xFFFF);
+        break;
+    }
+
     // size in bytes of index
     if (messageinfo->offsetid)
         messageinfo->indexsize = messageinfo->numbermsg * 2;
     else
         messageinfo->indexsize = messageinfo->numbermsg * 4;
 
+    // the header points to the country info block with 16 bits, behind
+    // a 32 bit index that is 16376 messages at most
+    if (sizeof(MSGHEADER) + messageinfo->indexsize > 0xFFFF)
+        return (MKMSG_COUNTRY_OVERFLOW);
+
     // assign header values for standard v2 MSG file
     messageinfo->version = 0x0002;                     // set version
     messageinfo->hdroffset = 0x001F;                   // header offset
@@ -607,731 +1087,1293 @@ int setupheader(MESSAGEINFO *messageinfo)
     messageinfo->reserved[3] = 0x00;
     messageinfo->reserved[4] = 0x00;
 
-    // hdrsize/offset + the size of index will locate the country info
-    messageinfo->countryinfo = messageinfo->hdroffset +
-                               messageinfo->indexsize;
+    // hdrsize/offset + the size of index will locate the country info
+    messageinfo->countryinfo = messageinfo->hdroffset +
+                               messageinfo->indexsize;
+
+    // messages start after the FILECOUNTRYINFO block
+    messageinfo->msgoffset = messageinfo->countryinfo +
+                             sizeof(FILECOUNTRYINFO);
+    messageinfo->msgfinalindex = messageinfo->msgoffset + msgbytes;
+
+    // remains 0 for now
+    messageinfo->extenblock = 0;
+
+    // TEMP stuff, stdout output has no name
+    strncpy((char *)messageinfo->filename,
+            strcmp(messageinfo->outfile, "-") ? messageinfo->outfile : "",
+            sizeof(messageinfo->filename)-1);
+    messageinfo->country = 0;
+
+    return (MKMSG_NOERROR);
+}
+
+/*
+ * appendline( )
+ *
+ * Add one message line to a compiled message. text is the line text,
+ * next the start of the following line. The message line needs to end
+ * 0x0D 0x0A, if the text input file was done in a modern text editor
+ * the ending is probably just 0x0A so it is replaced. A line ending
+ * with %0 gets no line ending at all.
+ * If dest is NULL only the length is returned.
+ */
+uint32_t appendline(char *text, char *next, char *dest)
+{
+    char *stop = next;
+    uint32_t len = 0;
+
+    if (text > next)
+        text = next;
+
+    // strip 0x0A or 0x0D 0x0A
+    if (stop > text && stop[-1] == 0x0A)
+        stop--;
+    if (stop > text && stop[-1] == 0x0D)
+        stop--;
+
+    len = stop - text;
+
+    // %0 line - remove %0 and no 0x0D 0x0A
+    if (len >= 2 && stop[-2] == '%' && stop[-1] == '0')
+    {
+        len -= 2;
+        if (dest)
+            memcpy(dest, text, len);
+        return (len);
+    }
+
+    if (dest)
+    {
+        memcpy(dest, text, len);
+        dest[len] = 0x0D;
+        dest[len + 1] = 0x0A;
+    }
+
+    return (len + 2);
+}
+
+/*************************************************************************
+ * Function:  formatbody( )
+ *
+ * Builds the compiled form of one message from the message table: the
+ * message type followed by the message lines. Comment lines inside the
+ * message are skipped.
+ *
+ * 1 Message type to front of message
+ * 2 ? message - no text, just 0x0D 0x0A
+ * 3 Mandatory space after : is skipped, if missing text starts after :
+ * 4 Add continuation lines
+ *
+ * If body is NULL nothing is written and only the length is returned.
+ *
+ * Return:    length in bytes of the compiled message
+ *************************************************************************/
+
+uint32_t formatbody(MSGENTRY *entry, char *body)
+{
+    uint32_t len = 0;
+    char *line = entry->start;
+    char *next = NULL;
+    char *text = NULL;
+
+    // message type goes to front of message
+    if (body)
+        body[len] = entry->type;
+    len++;
+
+    for (; line < entry->end; line = next)
+    {
+        next = LineBufEOL(line, entry->end);
+
+        if (line == entry->start)
+        {
+            if (entry->type == '?')
+                text = next;
+            else if ((next - line) > 9 && line[9] == 0x20)
+                text = &line[10];
+            else
+                text = &line[9];
+        }
+        else if (line[0] == ';')
+            continue;
+        else
+            text = line;
+
+        len += appendline(text, next, body ? body + len : NULL);
+    }
+
+    return (len);
+}
+
+/*************************************************************************
+ * Function:  writeasmfile( )
+ *
+ * Writes the ASM output from the message table built by setupheader
+ *
+ * 1 Set up the output buffer, the file is only written once it is
+ *   complete (OutBufCommit) so an error leaves no partial output
+ * 2 *** start main loop - one pass for each message ***
+ * 2.1 Check for the mandatory space after : exit if not present
+ * 2.2 Build the message text (formatbody) and skip the message type
+ * 2.3 Write message labels and length, all symbols of the message
+ *     (FindItemsByTag on the include symbols) get a label, the first
+ *     one names the length and end label
+ * 2.4 Write message text, 0x0D 0x0A written as 0DH, 0AH
+ * 2.5 Write message end label
+ * ** end main loop
+ * 3 Write the buffer to the output file
+ *
+ *
+ * Return:    returns error code or 0 for all good
+ *************************************************************************/
+
+// ASM output of one compile, see asmprintf and labelitem
+typedef struct _ASMOUT
+{
+    OUTBUF ob;      // ASM output
+    int rc;         // first output error, later output is dropped
+    char *first;    // first symbol of the message, NULL if none yet
+} ASMOUT;
+
+/*
+ * asmprintf( ) - printf into the ASM output, keeps the first error
+ */
+static void asmprintf(ASMOUT *out, const char *format, ...)
+{
+    va_list args;
+
+    if (out->rc != MKMSG_NOERROR)
+        return;
+
+    va_start(args, format);
+    out->rc = OutBufVPrintf(&out->ob, format, args);
+    va_end(args);
+}
+
+/*
+ * labelitem( ) - FindItemsByTag callback, write the label of one include
+ * symbol of the message
+ */
+void labelitem(ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, ADDRESS ObjectHandle, ADDRESS Parameters, CARDINAL32 * Error)
+{
+    ASMOUT *out = (ASMOUT *)Parameters;
+
+    (void) ObjectTag;
+    (void) ObjectSize;
+    (void) ObjectHandle;
+
+    asmprintf(out, "\tPUBLIC TXT_%s\r\nTXT_%s\tLABEL\tWORD\r\n",
+              (char *)Object, (char *)Object);
+
+    if (out->first == NULL)
+        out->first = (char *)Object;
+
+    *Error = DLIST_SUCCESS;
+}
+
+int writeasmfile(MESSAGEINFO *messageinfo)
+{
+    MSGENTRY *entry = NULL;
+    ASMOUT out;               // output and labels of the current message
+    char *label = NULL;       // first symbol of the message
+    CARDINAL32 dlrc = 0;
+    uint32_t body_size = 0;
+    uint32_t current_msg_len = 0;
+    char *body = NULL;
+    char *readptr = NULL;
+    int outlen = 0;
+    int indb = 0;
+    int rc = MKMSG_NOERROR;
+
+    // about the size of the text plus labels and DB lines
+    out.rc = OutBufInit(&out.ob, messageinfo->msgfinalindex * 2);
+    if (out.rc != MKMSG_NOERROR)
+        return (out.rc);
+
+    for (int count = 0; count < messageinfo->numbermsg && out.rc == MKMSG_NOERROR; count++)
+    {
+        entry = &messageinfo->msgtable[count];
+
+        // check if followed instructions with a space after colon
+        if (entry->type != '?' &&
+            ((entry->end - entry->start) < 10 || entry->start[9] != 0x20))
+        {
+            OutBufFree(&out.ob);
+            free(body);
+            return (MKMSG_BAD_TYPE);
+        }
+
+        // buffer to build message - grow if needed
+        current_msg_len = entry->length;
+        if (current_msg_len > body_size)
+        {
+            readptr = (char *)realloc(body, current_msg_len);
+            if (readptr == NULL)
+            {
+                OutBufFree(&out.ob);
+                free(body);
+                return (MKMSG_MEM_ERROR2);
+            }
+            body = readptr;
+            body_size = current_msg_len;
+        }
+        formatbody(entry, body);
+
+        // skip message type
+        readptr = body + 1;
+        current_msg_len--;
+
+        // Write out message labels
+        out.first = NULL;
+        FindItemsByTag(messageinfo->msgids, entry->number, &labelitem, (ADDRESS)&out, &dlrc);
+        label = out.first;
+
+        // Write out message length
+        if (label)
+            asmprintf(&out, "\tDW\tEND_%s - TXT_%s - 2\r\n", label, label);
+
+        // write out the current message
+        asmprintf(&out, "\tDB\t'%c%c%c%04d: '\r\n",
+            messageinfo->identifier[0], messageinfo->identifier[1],
+            messageinfo->identifier[2], entry->number);
+
+        indb = 0;
+        while (current_msg_len)
+        {
+            if (current_msg_len > 1 && strncmp("\r\n", readptr, 2) == 0)
+            {
+                if (indb)
+                    asmprintf(&out, "', 0DH, 0AH\r\n");
+                else
+                    asmprintf(&out, "\tDB\t0DH, 0AH\r\n");
+                indb = 0;
+                readptr += 2;
+                current_msg_len -= 2;
+                continue;
+            }
+
+            if (!indb)
+            {
+                asmprintf(&out, "\tDB\t'");
+                indb = 1;
+                outlen = 0;
+            }
+            else if (outlen >= ASM_MSG_SIZE)
+            {
+                asmprintf(&out, "'\r\n\tDB\t'");
+                outlen = 0;
+            }
+
+            if (out.rc == MKMSG_NOERROR)
+                out.rc = OutBufAppend(&out.ob, readptr, 1);
+            readptr++;
+            current_msg_len--;
+            outlen++;
+        }
+        if (indb)
+            asmprintf(&out, "'\r\n");
+
+        // Write out message end label and NULL
+        if (label)
+            asmprintf(&out, "END_%s\tLABEL\tWORD\r\n\tDB\t0\n\r", label);
+    }
+
+    // write the whole output, - is stdout
+    rc = out.rc;
+    if (rc == MKMSG_NOERROR)
+        rc = OutBufCommit(&out.ob, messageinfo->outfile);
+
+    if (rc == MKMSG_NOERROR)
+        msgprintf(messageinfo->log, "Done\n");
+
+    OutBufFree(&out.ob);
+    free(body);
+
+    return (rc);
+}
+
+/*************************************************************************
+ * Function:  buildmsgimage( )
+ *
+ * Builds the MSG file image in memory from the message table built by
+ * setupheader, used for the output file and for /T verify.
+ *
+ * 1 Size of the image is known from setupheader
+ * 2 Set extended header pointer if /E option
+ * 3 Allocate the image, header, index and country info go first
+ * 4 *** start main loop ***
+ * 4.1 Fill in the index entry -- the index is uint16 or uint32 based
+ *     on setupheader
+ * 4.2 Build message (formatbody) in place -- see formatbody for the
+ *     fixes done to each line
+ * ** end main loop
+ * 5 Add fake extended header if /E option
+ *
+ *
+ * Return:    returns error code or 0 for all good
+ *************************************************************************/
+
+int buildmsgimage(MESSAGEINFO *messageinfo, OUTBUF *image)
+{
+    MSGENTRY *entry = NULL;
+    char *index_entry = NULL;
+    char *body = NULL;
+
+    // check the wiki for a description of the extended
+    // header -- it goes right after the last message
+    if (messageinfo->fakeextend)
+        messageinfo->extenblock = messageinfo->msgfinalindex;
+
+    if (OutBufInit(image, messageinfo->msgfinalindex + sizeof(extfake)) != MKMSG_NOERROR)
+        return (MKMSG_MEM_ERROR1);
+
+    writeheader(messageinfo, OutBufAlloc(image, messageinfo->hdroffset));
+    index_entry = OutBufAlloc(image, messageinfo->indexsize);
+    writecountryblock(messageinfo, OutBufAlloc(image, sizeof(FILECOUNTRYINFO)));
+
+    for (int count = 0; count < messageinfo->numbermsg; count++)
+    {
+        entry = &messageinfo->msgtable[count];
+
+        // handle the uint16 and uint32 index differences, the index
+        // is not aligned so copy it in
+        if (messageinfo->offsetid)
+        {
+            uint16_t offset16 = (uint16_t)image->size;
+            memcpy(index_entry, &offset16, sizeof(offset16));
+            index_entry += sizeof(offset16);
+        }
+        else
+        {
+            memcpy(index_entry, &image->size, sizeof(image->size));
+            index_entry += sizeof(image->size);
+        }
+
+        // build the current message straight into the image
+        body = OutBufAlloc(image, entry->length);
+        formatbody(entry, body);
+    }
+
+    // tack on the fake ext header if passed -e option
+    if (messageinfo->fakeextend)
+        OutBufAppend(image, extfake, sizeof(extfake));
+
+    return (MKMSG_NOERROR);
+}
+
+/*************************************************************************
+ * Function:  writemsgfile( )
+ *
+ * Writes the MSG file: the complete image is built in memory
+ * (buildmsgimage) and written with a single write, the output file
+ * only appears once it is complete.
+ *
+ * Return:    returns error code or 0 for all good
+ *************************************************************************/
+
+int writemsgfile(MESSAGEINFO *messageinfo)
+{
+    OUTBUF image;
+    int rc = MKMSG_NOERROR;
+
+    rc = buildmsgimage(messageinfo, &image);
+    if (rc != MKMSG_NOERROR)
+        return (rc);
+
+    rc = OutBufCommit(&image, messageinfo->outfile);
+
+    if (rc == MKMSG_NOERROR)
+        msgprintf(messageinfo->log, "Done\n");
+
+    OutBufFree(&image);
+
+    return (rc);
+}
+
+/*************************************************************************
+ * Function:  buildvariant( )
+ *
+ * Compiles one /X language variant to a MSG image. arg is
+ * file,family,sub[,codepage...], the variant gets the output name and
+ * index width of the main file
+ *
+ * 1 Split off the input file name, the rest is a /L option followed by
+ *   the codepages
+ * 2 Read the input and build the message table (setupheader), the
+ *   component identifier has to be the one of the main file
+ * 3 Build the image
+ *
+ * Return:    returns error code or 0 for all good
+ *************************************************************************/
+
+int buildvariant(MESSAGEINFO *messageinfo, char *arg, MESSAGEINFO *variant, OUTBUF *image)
+{
+    char *lang = strchr(arg, ',');
+    char *cp = NULL;
+    int rc = MKMSG_NOERROR;
+
+    variant->log = messageinfo->log;
+    variant->bytesperchar = 1;
+    variant->indexwidth = messageinfo->indexwidth;
+    strcpy(variant->outfile, messageinfo->outfile);
+
+    if (lang == NULL || lang == arg || (size_t)(lang - arg) >= sizeof(variant->infile))
+        return (MKMSG_GETOPT_ERROR);
+    memcpy(variant->infile, arg, lang - arg);
+    lang++;
+
+    rc = DecodeLangOpt(lang, variant);
+    if (rc != 1)
+        return (rc);
+
+    // codepages follow family,sub
+    cp = strchr(lang, ',');
+    for (cp = cp ? strchr(cp + 1, ',') : NULL; cp != NULL; cp = strchr(cp + 1, ','))
+    {
+        if (variant->codepagesnumber == 16)
+            return (MKMSG_GETOPT_ERROR);
+        variant->codepages[variant->codepagesnumber++] = atoi(cp + 1);
+    }
+
+    rc = LineBufOpen(&variant->source, variant->infile);
+    if (rc == MKMSG_NOERROR)
+        rc = setupheader(variant);
+    if (rc == MKMSG_NOERROR &&
+        memcmp(variant->identifier, messageinfo->identifier, 3) != 0)
+        rc = MKMSG_IDENT_ERROR;
+    if (rc == MKMSG_NOERROR)
+        rc = buildmsgimage(variant, image);
+
+    return (rc);
+}
+
+/*
+ * samevariant( ) - 1 if MsgFileSelect could not tell a and b apart: same
+ * language and a shared codepage, no codepages matches every codepage
+ */
+static int samevariant(MESSAGEINFO *a, MESSAGEINFO *b)
+{
+    if (a->langfamilyID != b->langfamilyID ||
+        a->langversionID != b->langversionID)
+        return (0);
+    if (!a->codepagesnumber || !b->codepagesnumber)
+        return (1);
+
+    for (int x = 0; x < a->codepagesnumber; x++)
+        for (int y = 0; y < b->codepagesnumber; y++)
+            if (a->codepages[x] == b->codepages[y])
+                return (1);
+
+    return (0);
+}
+
+/*************************************************************************
+ * Function:  writemultifile( )
+ *
+ * Writes a MSG file with /X language variants. The input file is the
+ * main language, it is read with a plain MsgFileOpen. Each variant is
+ * a complete MSG image behind the extended header, MsgFileSelect picks
+ * one by language and codepage.
+ *
+ * 1 Build the variant images, each language and codepage only once
+ * 2 Main image, the extended header goes right after its messages
+ * 3 EXTHDR and one EXTBLOCK per variant, then the variant images
+ * 4 Write it all with a single write
+ *
+ * Return:    returns error code or 0 for all good
+ *************************************************************************/
+
+int writemultifile(MESSAGEINFO *messageinfo, char **variants, int count)
+{
+    MESSAGEINFO *vinfo = NULL;   // one per variant
+    OUTBUF *vimage = NULL;       // variant MSG images
+    OUTBUF image;                // the whole file
+    EXTHDR exthdr;
+    EXTBLOCK *block = NULL;
+    uint32_t offset = 0;
+    int rc = MKMSG_NOERROR;
+    int x = 0;
+
+    memset(&image, 0, sizeof(OUTBUF));
+
+    vinfo = (MESSAGEINFO *)calloc(count, sizeof(MESSAGEINFO));
+    vimage = (OUTBUF *)calloc(count, sizeof(OUTBUF));
+    if (vinfo == NULL || vimage == NULL)
+        rc = MKMSG_MEM_ERROR1;
+
+    for (x = 0; x < count && rc == MKMSG_NOERROR; x++)
+    {
+        rc = buildvariant(messageinfo, variants[x], &vinfo[x], &vimage[x]);
+
+        for (int y = -1; y < x && rc == MKMSG_NOERROR; y++)
+            if (samevariant((y < 0) ? messageinfo : &vinfo[y], &vinfo[x]))
+                rc = MKMSG_VARIANT_DUP;
+
+        if (rc == MKMSG_VARIANT_DUP)
+            msgprintf(messageinfo->log, "\n/X %s: language %d,%d is already in the file for the same codepage\n",
+                      variants[x], vinfo[x].langfamilyID, vinfo[x].langversionID);
+        else if (rc == MKMSG_LANG_OUT_RANGE || rc == MKMSG_SUBID_OUT_RANGE)
+            msgprintf(messageinfo->log, "\n/X %s: language %d,%d is not a known language\n",
+                      variants[x], vinfo[x].langfamilyID, vinfo[x].langversionID);
+        else if (rc != MKMSG_NOERROR)
+            msgprintf(messageinfo->log, "\n/X %s: language variant error\n", variants[x]);
+        else
+            msgprintf(messageinfo->log, "Language %d,%d: %s, %d messages\n",
+                      vinfo[x].langfamilyID, vinfo[x].langversionID,
+                      vinfo[x].infile, vinfo[x].numbermsg);
+    }
+
+    // main image, /E is not needed, the real extended header follows
+    if (rc == MKMSG_NOERROR)
+    {
+        messageinfo->fakeextend = 0;
+        messageinfo->extenblock = messageinfo->msgfinalindex;
+        rc = buildmsgimage(messageinfo, &image);
+    }
+
+    if (rc == MKMSG_NOERROR)
+    {
+        exthdr.hdrlen = sizeof(EXTBLOCK);
+        exthdr.numblocks = count;
+        rc = OutBufAppend(&image, &exthdr, sizeof(EXTHDR));
+    }
+
+    // block table first, the images follow in the same order
+    if (rc == MKMSG_NOERROR)
+    {
+        block = (EXTBLOCK *)OutBufAlloc(&image, count * sizeof(EXTBLOCK));
+        if (block == NULL)
+            rc = MKMSG_MEM_ERROR1;
+    }
+
+    if (rc == MKMSG_NOERROR)
+    {
+        offset = sizeof(EXTHDR) + count * sizeof(EXTBLOCK);
+        for (x = 0; x < count; x++)
+        {
+            writecountryblock(&vinfo[x], (char *)&block[x].country);
+            block[x].offset = offset;
+            block[x].size = vimage[x].size;
+            offset += vimage[x].size;
+        }
+    }
+
+    for (x = 0; x < count && rc == MKMSG_NOERROR; x++)
+        rc = OutBufAppend(&image, vimage[x].data, vimage[x].size);
 
-    // messages start after the FILECOUNTRYINFO block
-    messageinfo->msgoffset = messageinfo->countryinfo +
-                             sizeof(FILECOUNTRYINFO);
+    if (rc == MKMSG_NOERROR)
+        rc = OutBufCommit(&image, messageinfo->outfile);
 
-    // remains 0 for now
-    messageinfo->extenblock = 0;
+    if (rc == MKMSG_NOERROR)
+        msgprintf(messageinfo->log, "Done, %d languages\n", count + 1);
 
-    // TEMP stuff
-    strncpy(messageinfo->filename,
-            messageinfo->outfile,
-            sizeof(messageinfo->filename)-1);
-    messageinfo->country = 0;
+    for (x = 0; vinfo != NULL && vimage != NULL && x < count; x++)
+    {
+        free(vinfo[x].msgtable);
+        LineBufClose(&vinfo[x].source);
+        OutBufFree(&vimage[x]);
+    }
 
-    return (MKMSG_NOERROR);
+    free(vinfo);
+    free(vimage);
+    OutBufFree(&image);
+
+    return (rc);
+}
+
+/*
+ * showbytes( ) - display up to 40 bytes of data from offset on, control
+ * characters escaped so CR LF and %0 differences are visible
+ */
+void showbytes(OUTBUF *log, char *label, char *data, uint32_t len, uint32_t offset)
+{
+    uint32_t start = offset > 10 ? offset - 10 : 0;
+
+    msgprintf(log, "  %-10s \"", label);
+    for (uint32_t x = start; x < len && x < start + 40; x++)
+    {
+        uint8_t c = (uint8_t)data[x];
+
+        if (c == 0x0D)
+            msgprintf(log, "\\r");
+        else if (c == 0x0A)
+            msgprintf(log, "\\n");
+        else if (c < 0x20 || c == 0x7F)
+            msgprintf(log, "\\x%02X", c);
+        else
+            msgprintf(log, "%c", c);
+    }
+    msgprintf(log, "\"%s\n", start + 40 < len ? "..." : "");
 }
 
 /*************************************************************************
- * Function:  writeasmfile( )
+ * Function:  verifymsgfile( )
  *
- * Reads in all the MSG file info and stores in MESSAGEINFO structure
+ * /T option: compile the input into a MSG image in memory, decompile it
+ * again the way MKMSGD does and compile that text once more. Every
+ * message must come back with its number and the same compiled bytes.
+ * Nothing is written to disk.
  *
- * 1 Open input file in read and out put file in update mode
- * 2 Allocate read buffer
- * 3 Set input file positions
- * 4 *** start main loop ***
- * 4.1 Clear read buffer
- * 4.2 Get current read poistion and store in index
- * 4.3 Read in message line
- * 4.4 Check for comment - if true read next line -> 5.1
- * 4.5 Line starts with msg ID? Yes new message else -> 5.9
- * 4.6 Check if valid msg type - E, I, W, H, P, ? --> error if not
- * 4.7 Increment message tracking number
- * 4.8.1 Check for ? message if true then generate full ? message to save
- *     time else process E, I, W, H, P msg types and set scratch pointer
- * 4.8.2.1 Check for the mandatory space after : exit if not present
- * 4.8.2.2 Move msg type to space and set scratch pointer
- * 4.9 Continuation line -- set scratch pointer
- *
- * 5 Get message length
- * 6 Check/fix 0x0D 0x0A ending of line
- * 7 Check and fix for %0 lines
- * 8 Write message line to output file
+ * 1 Build the image (buildmsgimage) and open it with msgapi
+ * 2 *** start main loop - one pass for each message ***
+ * 2.1 Message from the image index, its number must be the source number
+ *     (message numbers have to count up by one from the first)
+ * 2.2 Source text like MKMSGD writes it (MsgFileSourceEnd does the
+ *     0x00 and %0 / CR LF handling for both)
+ * 2.3 Compile the text again (formatbody) and compare to the image
  * ** end main loop
- * 9 Seek to index start and write index
- *
+ * 3 Report the first message that differs
  *
  * Return:    returns error code or 0 for all good
  *************************************************************************/
-typedef
-struct tagParam
-{
-	int num;
-	FILE * f;
-	int type;
-	int skip;
-} Param;
 
-void handleitem(ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, ADDRESS ObjectHandle, ADDRESS Parameters, CARDINAL32 * Error)
+int verifymsgfile(MESSAGEINFO *messageinfo)
 {
-	
-	
-	if (((Param *)Parameters)->num==ObjectTag)
-	{
-		char line[81]={0};
-		if (((Param *)Parameters)->type==0)
-		  fprintf(((Param *)Parameters)->f, "\tPUBLIC TXT_%s\r\nTXT_%s\tLABEL\tWORD\r\n", Object, Object);
-		if ((((Param *)Parameters)->type==1)&(((Param *)Parameters)->skip==0))
-		{
-		  fprintf(((Param *)Parameters)->f, "\tDW\tEND_%s - TXT_%s - 2\r\n", Object, Object);
-		  ((Param *)Parameters)->skip=1;
-		}
-		if ((((Param *)Parameters)->type==2)&(((Param *)Parameters)->skip==0))
-		{
-		  fprintf(((Param *)Parameters)->f, "END_%s\tLABEL\tWORD\r\n\tDB\t0\n\r", Object);
-		  ((Param *)Parameters)->skip=1;
-		}
-	}
+    OUTBUF image;       // compiled input
+    OUTBUF source;      // one message decompiled
+    OUTBUF again;       // that message compiled again
+    MSGFILE mf;
+    MSGTEXT msg;
+    MSGENTRY entry;
+    MSGENTRY *orig = NULL;
+    const char *noend = NULL;
+    char *compiled = NULL;
+    char *recompiled = NULL;
+    uint32_t complen = 0;
+    uint32_t at = 0;
+    int rc = MKMSG_NOERROR;
+
+    rc = buildmsgimage(messageinfo, &image);
+    if (rc != MKMSG_NOERROR)
+        return (rc);
 
-}
+    OutBufInit(&source, 1024);
+    OutBufInit(&again, 1024);
 
-int writeasmfile(MESSAGEINFO *messageinfo)
-{
-    // open input file
-    FILE *fpi = fopen(messageinfo->infile, "rb");
-    if (fpi == NULL)
-        return (MKMSG_OPEN_ERROR);
-
-    // write output file open for write
-    FILE *fpo = fopen(messageinfo->outfile, "wb");
-    if (fpo == NULL)
-        return (MKMSG_OPEN_ERROR);
-
-    // buffer to read in a message - use a 256 byte buffer which
-    // is overkill but not a big deal - I do not expect lines >256
-    // in length
-    size_t read_buff_size = 0;
-    char *read_buffer = (char *)calloc(256, sizeof(char));
-    if (read_buffer == NULL)
-        return (MKMSG_MEM_ERROR2);
-
-    // return to previous position
-    fsetpos(fpi, &messageinfo->msgstartline); // input after id line
-
-    int current_msg_len = 0;
-    int msg_num_check = messageinfo->firstmsg;
-    char *readptr = NULL;
+    rc = MsgFileMem(&mf, image.data, image.size);
 
-    while (TRUE)
+    for (int count = 0; count < messageinfo->numbermsg && rc == MKMSG_NOERROR; count++)
     {
-        // clear the read_buffer -- set all to 0x00 this will
-        // give me a clean strlen return
-        memset(read_buffer, 0x00, _msize(read_buffer));
+        orig = &messageinfo->msgtable[count];
 
-        // here is the line read in
-        getline(&read_buffer, &read_buff_size, fpi);
-        if (feof(fpi))
+        rc = MsgFileGet(&mf, messageinfo->firstmsg + count, &msg);
+        if (rc != MKMSG_NOERROR)
             break;
 
-        // find message start - skip comments
-        // this is the main loop if not a comment line
-        if (read_buffer[0] != ';')
+        if (orig->number != msg.number)
         {
-            // check if ID which indicates message start
-            if (strncmp(messageinfo->identifier, read_buffer, 3) == 0)
-            {
-                // First check - is the message type valid
-                if (read_buffer[7] != 'E' && read_buffer[7] != 'H' &&
-                    read_buffer[7] != 'I' && read_buffer[7] != 'P' &&
-                    read_buffer[7] != 'W' && read_buffer[7] != '?')
-                {
-                    fclose(fpi);
-                    fclose(fpo);
-                    free(read_buffer);
-                    ProgError(MKMSG_BAD_TYPE, "MKMSGF: Bad message type.");
-                }
-
-
-                // shortcut and make sure the format is correct
-                // for ? messages
-                if (read_buffer[7] == '?')
-                {
-                    memset(read_buffer, 0x00, _msize(read_buffer));
-                    read_buffer[0] = 0x0D;
-                    read_buffer[1] = 0x0A;
-                    read_buffer[2] = 0x00;
-
-                    readptr = read_buffer;
-                }
-                else
-                {
-                    // check if followed instructions with a space after colon
-                    // I assume this was why (maybe not) -- just copy the ID
-                    // to the space position and change pointer to the new start
-                    if (read_buffer[9] != 0x20)
-                        return (MKMSG_BAD_TYPE);
-                    else
-                    {
-                        // move message type to front of message
-                        // and set buffer position
-                        //read_buffer[9] = read_buffer[7];
-                        readptr = &read_buffer[10];
-						//readptr = read_buffer;
-                    }
-                }
-            }
-            else // no ID - continues previous line
-            {
-                // this is a continuation line so just
-                // set the readptr
-                readptr = read_buffer;
-            }
-
-            current_msg_len = strlen(readptr);
-
-            // Second check - check and setup correct message ending
-            // - the message ending needs to be 0x0D 0x0A, if the text
-            // input file was done in a modern text editor the ending
-            // is probably just 0x0A so add 0x0D 0x0A 0x00
+            msgprintf(messageinfo->log, "\nVerify: message %s%04u decompiles as %s%04u\n",
+                      messageinfo->identifier, orig->number,
+                      messageinfo->identifier, msg.number);
+            rc = MKMSG_VERIFY_ERROR;
+            break;
+        }
 
-            if (readptr[(current_msg_len - 1)] != 0x0A &&
-                readptr[(current_msg_len - 2)] != 0x0D)
-            {
-                readptr[(current_msg_len - 1)] = 0x0D;
-                readptr[(current_msg_len)] = 0x0A;
-                readptr[(current_msg_len + 1)] = 0x00;
+        // compiled message, type byte included
+        compiled = msg.text - 1;
+        complen = msg.length + 1;
+
+        source.size = 0;
+        noend = MsgFileSourceEnd(&msg);
+        rc = OutBufPrintf(&source, "%.3s%04u%c: ", messageinfo->identifier,
+                          msg.number, msg.type);
+        if (rc == MKMSG_NOERROR)
+            rc = OutBufAppend(&source, msg.text, msg.length);
+        if (rc == MKMSG_NOERROR)
+            rc = OutBufAppend(&source, noend, strlen(noend));
+        if (rc != MKMSG_NOERROR)
+            break;
 
-                // new length
-                current_msg_len = strlen(readptr);
-            }
+        entry.start = source.data;
+        entry.end = source.data + source.size;
+        entry.number = msg.number;
+        entry.type = msg.type;
+        entry.length = formatbody(&entry, NULL);
 
-            // At this point the message is ready in reference to where
-            // readptr points and each line ends 0x0D 0x0A 0x00
+        again.size = 0;
+        recompiled = OutBufAlloc(&again, entry.length);
+        if (recompiled == NULL)
+        {
+            rc = MKMSG_MEM_ERROR1;
+            break;
+        }
+        formatbody(&entry, recompiled);
 
-            // Third and final check - fix end if it is a %0 line
-            // if ends in [ % 0 0x0D 0x0A 0x00] remove all four
-            // poistions and make 0x00 - all four just as a easy
-            // way to spot problems in a hex dump
-            if (readptr[(current_msg_len - 3)] == '0' &&
-                readptr[(current_msg_len - 4)] == '%')
-            {
-                readptr[(current_msg_len - 1)] = 0x00;
-                readptr[(current_msg_len - 2)] = 0x00;
-                readptr[(current_msg_len - 3)] = 0x00;
-                readptr[(current_msg_len - 4)] = 0x00;
+        if (entry.length == complen && !memcmp(recompiled, compiled, complen))
+            continue;
 
-                // new length -- up to first 0x00
-                current_msg_len = strlen(readptr);
-            }
+        for (at = 0; at < complen && at < entry.length; at++)
+            if (recompiled[at] != compiled[at])
+                break;
 
-			// Write out message labels
-			Param p;
-			unsigned long rc;
-			p.num=msg_num_check;
-			p.f=fpo;
-			p.type=0;
-			ForEachItem(messageinfo->msgids,
-				&handleitem,
-				(ADDRESS)&p,
-				TRUE,
-				&rc);
-
-			// Write out message length
-			p.type=1;
-			p.skip=0;
-			ForEachItem(messageinfo->msgids,
-				&handleitem,
-				(ADDRESS)&p,
-				TRUE,
-				&rc);
-
-            // write out the current message
-			fprintf(fpo, "\tDB\t'%c%c%c%04d: '\r\n\tDB\t'",
-			messageinfo->identifier[0], messageinfo->identifier[1],
-			messageinfo->identifier[2], msg_num_check);
-			int outlen=1;
-            while (*readptr)
-			{
-				if (outlen>ASM_MSG_SIZE) 
-				{
-					fprintf(fpo,"'\r\n\tDB\t'");
-					outlen=0;
-				}
-
-				if (strncmp("\r\n", readptr, 2) == 0)				
-				{
-					fprintf(fpo, "', 0DH, 0AH\r\n");
-					readptr++;
-					outlen=-1;
-				}
-				else 
-				{
-					fputc(*readptr, fpo);
-				}
-				readptr++;
-				outlen++;
-			}
-			if (outlen) fprintf(fpo,"'\r\n");
-
-			// Write out message end label and NULL
-			p.type=2;
-			p.skip=0;
-			ForEachItem(messageinfo->msgids,
-				&handleitem,
-				(ADDRESS)&p,
-				TRUE,
-				&rc);
-
-			msg_num_check++;
-        }
+        msgprintf(messageinfo->log, "\nVerify: message %s%04u differs at byte %u\n",
+                  messageinfo->identifier, msg.number, at);
+        showbytes(messageinfo->log, "compiled", compiled, complen, at);
+        showbytes(messageinfo->log, "decompiled", source.data, source.size, 0);
+        showbytes(messageinfo->log, "recompiled", recompiled, entry.length, at);
+        rc = MKMSG_VERIFY_ERROR;
     }
 
+    if (rc == MKMSG_NOERROR)
+        msgprintf(messageinfo->log, "Verify: %u messages round trip\n", messageinfo->numbermsg);
 
-    printf("Done\n");
+    MsgFileClose(&mf);
+    OutBufFree(&again);
+    OutBufFree(&source);
+    OutBufFree(&image);
 
-    // close up and get out
-    fclose(fpo);
-    fclose(fpi);
-    free(read_buffer); 
-
-    return (MKMSG_NOERROR);
+    return (rc);
 }
 
 /*************************************************************************
- * Function:  writemsgfile( )
- *
- * Reads in all the MSG file info and stores in MESSAGEINFO structure
- *
- * 1 Open input file in read and out put file in update mode
- * 2 Allocate index and read buffer
- * 3 Set input and output file positions
- * 4 Set index pointer based on uint8/uint32 sizes
- * 5 *** start main loop ***
- * 5.1 Clear read buffer
- * 5.2 Get current read poistion and store in index
- * 5.3 Read in message line
- * 5.4 Check for comment - if true read next line -> 5.1
- * 5.5 Line starts with msg ID? Yes new message else -> 5.9
- * 5.6 Check if valid msg type - E, I, W, H, P, ? --> error if not
- * 5.7 Increment message tracking number
- * 5.8.1 Check for ? message if true then generate full ? message to save
- *     time else process E, I, W, H, P msg types and set scratch pointer
- * 5.8.2.1 Check for the mandatory space after : exit if not present
- * 5.8.2.2 Move msg type to space or colon and set scratch pointer
- * 5.9 Continuation line -- set scratch pointer
- *
- * 6 Get message length
- * 7 Check/fix 0x0D 0x0A ending of line
- * 8 Check and fix for %0 lines
- * 9 Write message line to output file
- * ** end main loop
- * 10 Seek to index start and write index
+ * Function:  writecountryblock( )
  *
+ * Fills in the FILECOUNTRYINFO block of the image from MESSAGEINFO
+ * structure, dest is zeroed and sizeof(FILECOUNTRYINFO) bytes
  *
  * Return:    returns error code or 0 for all good
  *************************************************************************/
 
-int writemsgfile(MESSAGEINFO *messageinfo)
+int writecountryblock(MESSAGEINFO *messageinfo, char *dest)
 {
-    // open input file
-    FILE *fpi = fopen(messageinfo->infile, "rb");
-    if (fpi == NULL)
-        return (MKMSG_OPEN_ERROR);
-
-    // write output file open for update
-    FILE *fpo = fopen(messageinfo->outfile, "r+b");
-    if (fpo == NULL)
-        return (MKMSG_OPEN_ERROR);
-
-    // buffer to read in index - this reserves memory of the
-    // size calculated earlier to hold the index which is
-    // dumped to the file at end of message write
-    char *index_buffer = (char *)calloc(messageinfo->indexsize, sizeof(char));
-    if (index_buffer == NULL)
-        return (MKMSG_MEM_ERROR1);
+    FILECOUNTRYINFO *cntryheader = (FILECOUNTRYINFO *)dest;
 
-    // buffer to read in a message - use a 256 byte buffer which
-    // is overkill but not a big deal - I do not expect lines >256
-    // in length
-    size_t read_buff_size = 0;
-    char *read_buffer = (char *)calloc(256, sizeof(char));
-    if (read_buffer == NULL)
-        return (MKMSG_MEM_ERROR2);
+    cntryheader->bytesperchar = messageinfo->bytesperchar;
+    cntryheader->country = messageinfo->country;
+    cntryheader->langfamilyID = messageinfo->langfamilyID;
+    cntryheader->langversionID = messageinfo->langversionID;
+    cntryheader->codepagesnumber = messageinfo->codepagesnumber;
 
-    // return to previous position
-    fsetpos(fpi, &messageinfo->msgstartline); // input after id line
-    fsetpos(fpo, &messageinfo->msgoffset);    // move to start msg area
+    for (int x = 0; x < cntryheader->codepagesnumber; x++)
+        cntryheader->codepages[x] = messageinfo->codepages[x];
 
-    int msg_num_check = 0;
-    int current_msg_len = 0;
-    char *readptr = NULL;
-    fpos_t index_position;
+    strncpy((char *)cntryheader->filename,
+            (char *)messageinfo->filename,
+            sizeof(cntryheader->filename)-1);
 
-    // index pointers
-    uint16_t *small_index = NULL; // used if index pointers uint16
-    uint32_t *large_index = NULL; // used if index pointers uint32
+    cntryheader->filler = 0x00;
 
-    // pick the pointer based on index uint16 or uint32
-    if (messageinfo->offsetid)
-        small_index = (uint16_t *)index_buffer;
-    else
-        large_index = (uint32_t *)index_buffer;
+    return (0);
+}
 
-    while (!feof(fpi))
-    {
-        // clear the read_buffer -- set all to 0x00 this will
-        // give me a clean strlen return
-        memset(read_buffer, 0x00, _msize(read_buffer));
+/*************************************************************************
+ * Function:  writeheader( )
+ *
+ * Fills in the MSG file header of the image from MESSAGEINFO structure
+ *
+ * 1 Load signature
+ * 2 Transfer header info from MESSAGEINFO structure
+ * 3 Copy header to the image
+ *
+ *
+ * Return:    returns error code or 0 for all good
+ *************************************************************************/
 
-        // get current position in outfile -- onentry will be
-        // set to first message after fsetpos above
-        fgetpos(fpo, &index_position);
+int writeheader(MESSAGEINFO *messageinfo, char *dest)
+{
+    MSGHEADER msgheader;
 
-        // handle the uint16 and uint32 index differences
-        if (messageinfo->offsetid)
-            small_index[msg_num_check] = (uint16_t)index_position;
-        else
-            large_index[msg_num_check] = (uint32_t)index_position;
+    memset(&msgheader, 0x00, sizeof(MSGHEADER));
 
-        // here is the line read in
-        getline(&read_buffer, &read_buff_size, fpi);
-        if (!getline(&read_buffer, &read_buff_size, fpi) & feof(fpi))
-            break;
+    // load MKMSG signature
+    for (int x = 0; x < 8; x++)
+        msgheader.magic_sig[x] = signature[x];
 
-        // find message start - skip comments
-        // this is the main loop if not a comment line
-        if (read_buffer[0] != ';')
-        {
-            // check if ID which indicates message start
-            if (strncmp(messageinfo->identifier, read_buffer, 3) == 0)
-            {
-                // First check - is the message type valid
-                if (read_buffer[7] != 'E' && read_buffer[7] != 'H' &&
-                    read_buffer[7] != 'I' && read_buffer[7] != 'P' &&
-                    read_buffer[7] != 'W' && read_buffer[7] != '?')
-                {
-                    fclose(fpi);
-                    fclose(fpo);
-                    free(read_buffer);
-                    free(index_buffer);
-                    ProgError(1, "MKMSGF: Bad message type."); // fix error
-                }
-
-                // keep track of messages processed
-                msg_num_check += 1;
-
-                // shortcut and make sure the format is correct
-                // for ? messages
-                if (read_buffer[7] == '?')
-                {
-                    memset(read_buffer, 0x00, _msize(read_buffer));
-                    read_buffer[0] = '?';
-                    read_buffer[1] = 0x0D;
-                    read_buffer[2] = 0x0A;
-                    read_buffer[3] = 0x00;
-
-                    readptr = read_buffer;
-                }
-                else
-                {
-                    // check if followed instructions with a space after colon
-                    // I assume this was why (maybe not) -- just copy the ID
-                    // to the space position and change pointer to the new start
-                    if (read_buffer[9] != 0x20)
-					{
-                        read_buffer[8] = read_buffer[7];
-                        readptr = &read_buffer[8];
-//                        return (MKMSG_BAD_TYPE);
-					}
-                    else
-                    {
-                        // move message type to front of message
-                        // and set buffer position
-                        read_buffer[9] = read_buffer[7];
-                        readptr = &read_buffer[9];
-                    }
-                }
-            }
-            else // no ID - continues previous line
-            {
-                // this is a continuation line so just
-                // set the readptr
-                readptr = read_buffer;
-            }
+    for (int x = 0; x < 3; x++)
+        msgheader.identifier[x] = messageinfo->identifier[x];
 
-            current_msg_len = strlen(readptr);
+    msgheader.numbermsg = messageinfo->numbermsg;
+    msgheader.firstmsg = messageinfo->firstmsg;
+    msgheader.offset16bit = messageinfo->offsetid;
+    msgheader.version = messageinfo->version;
+    msgheader.hdroffset = messageinfo->hdroffset;
+    msgheader.countryinfo = messageinfo->countryinfo;
+    msgheader.extenblock = messageinfo->extenblock;
 
-            // Second check - check and setup correct message ending
-            // - the message ending needs to be 0x0D 0x0A, if the text
-            // input file was done in a modern text editor the ending
-            // is probably just 0x0A so add 0x0D 0x0A 0x00
+    for (int x = 0; x < 5; x++)
+        msgheader.reserved[x] = messageinfo->reserved[x];
 
-            if (current_msg_len && readptr[(current_msg_len - 1)] != 0x0A &&
-                readptr[(current_msg_len - 2)] != 0x0D)
-            {
-                readptr[(current_msg_len - 1)] = 0x0D;
-                readptr[(current_msg_len)] = 0x0A;
-                readptr[(current_msg_len + 1)] = 0x00;
+    memcpy(dest, &msgheader, messageinfo->hdroffset);
 
-                // new length
-                current_msg_len = strlen(readptr);
-            }
+    return (0);
+}
 
-            // At this point the message is ready in reference to where
-            // readptr points and each line ends 0x0D 0x0A 0x00
+/*
+ * patchbody( ) - append message number of the patched file to ob: the
+ * new message if the patch has one, else the old one as is
+ */
+int patchbody(OUTBUF *ob, MSGFILE *mf, MSGENTRY *entry, uint32_t number)
+{
+    MSGTEXT msg;
+    char *body = NULL;
+    int rc = 0;
 
-            // Third and final check - fix end if it is a %0 line
-            // if ends in [ % 0 0x0D 0x0A 0x00] remove all four
-            // poistions and make 0x00 - all four just as a easy
-            // way to spot problems in a hex dump
-            if (readptr[(current_msg_len - 3)] == '0' &&
-                readptr[(current_msg_len - 4)] == '%')
-            {
-                readptr[(current_msg_len - 1)] = 0x00;
-                readptr[(current_msg_len - 2)] = 0x00;
-                readptr[(current_msg_len - 3)] = 0x00;
-                readptr[(current_msg_len - 4)] = 0x00;
+    if (entry != NULL)
+    {
+        body = OutBufAlloc(ob, entry->length);
+        if (body == NULL)
+            return (MKMSG_MEM_ERROR1);
+        formatbody(entry, body);
+        return (MKMSG_NOERROR);
+    }
 
-                // new length -- up to first 0x00
-                current_msg_len = strlen(readptr);
-            }
+    rc = MsgFileGet(mf, number, &msg);
+    if (rc != MKMSG_NOERROR)
+        return (rc);
 
-            // write out the current message
-            fwrite(readptr, sizeof(char), current_msg_len, fpo);
-			
-        }
-    }
+    // type byte is in front of the text
+    return (OutBufAppend(ob, msg.text - 1, msg.length + 1));
+}
 
-    // position to index start and write index -- I could
-    // used fwrite - just decided to write index like this:
-    fseek(fpo, messageinfo->indexoffset, SEEK_SET);
-    for (int x = 0; x < messageinfo->indexsize; x++)
-        fputc(index_buffer[x], fpo);
+/*
+ * patchlength( ) - compiled length of message number of the patched file
+ */
+uint32_t patchlength(MSGFILE *mf, MSGENTRY *entry, uint32_t number)
+{
+    MSGTEXT msg;
 
-    // check the wiki for a description of the extended
-    // header -- add header if passed -e option
-    // So this is step by step just to make sure it
-    // is correct - there is nothing like doing somethng
-    // not needed and screwing (bug) the entire program
-    if (messageinfo->fakeextend)
+    if (entry != NULL)
+        return (entry->length);
+
+    if (MsgFileGet(mf, number, &msg) != MKMSG_NOERROR)
+        return (0);
+
+    return (msg.length + 1);
+}
+
+/*
+ * putindex( ) - store index entry x, the index is not aligned
+ */
+void putindex(char *index, uint32_t x, uint32_t offset, int offset16)
+{
+    if (offset16)
     {
-        // close
-        fclose(fpo);
+        uint16_t offset16 = (uint16_t)offset;
+        memcpy(index + x * 2, &offset16, sizeof(offset16));
+    }
+    else
+        memcpy(index + x * 4, &offset, sizeof(offset));
+}
+
+/*
+ * patchshared( ) - 1 if target has more than one link, a -K compile
+ * links its output to the cache entry and writing into the file would
+ * change the cached copy too
+ */
+int patchshared(char *target)
+{
+    struct stat st;
 
-        // write output file open for append
-        FILE *fpo = fopen(messageinfo->outfile, "r+b");
-        if (fpo == NULL)
-            return (MKMSG_OPEN_ERROR);
+    return (stat(target, &st) == 0 && st.st_nlink > 1);
+}
 
-        // move to end of file
-        fseek(fpo, 0L, SEEK_END);
+/*************************************************************************
+ * Function:  patchmsgfile( )
+ *
+ * /U option: replace messages of an existing MSG file with the messages
+ * of the input file (setupheader has built the message table) and add
+ * messages that follow the last one.
+ *
+ * 1 Map the MSG file, the component identifier must match
+ * 2 Put each input message in its slot, new numbers have to follow the
+ *   last message without a gap
+ * 3 Same number of messages, the index width still fits and the file
+ *   has no other links (patchshared): patch in place. Messages before the first changed one stay where they are,
+ *   the messages from there on (and the extended header behind them)
+ *   are rewritten up to the point where the old messages are back at
+ *   their old offset, only the index entries that moved are written,
+ *   the file is cut to its new size. The header is only written if
+ *   the extended header moved.
+ * 4 Else rebuild the file: added messages grow the index, or the
+ *   messages no longer fit a uint16 index and it becomes uint32, or the
+ *   file is linked to a cache entry. Header and country info are kept,
+ *   the file is replaced in one go (OutBufCommit), which also breaks
+ *   the link
+ *
+ * The in place patch is not atomic, a failed write leaves a broken
+ * file behind.
+ *
+ * Return:    returns error code or 0 for all good
+ *************************************************************************/
 
-        // save location
-        uint32_t extenblock = (uint32_t)ftell(fpo);
+int patchmsgfile(MESSAGEINFO *messageinfo, char *target)
+{
+    MSGFILE mf;
+    MSGTEXT msg;
+    MSGHEADER header;           // header of the patched file
+    MSGENTRY **slot = NULL;     // new message per number, NULL = keep old
+    OUTBUF image;               // rebuilt file or rewritten messages
+    char *index = NULL;         // index of the patched file
+    uint32_t oldcount = 0;      // messages in the file
+    uint32_t newcount = 0;      // messages after the patch
+    uint32_t first = 0;         // first changed message slot
+    uint32_t last = 0;          // last changed message slot
+    uint32_t start = 0;         // its offset, nothing before it moves
+    uint32_t offset = 0;
+    uint32_t hdroffset = 0;
+    uint32_t countrysize = 0;   // 0 for version 0 files
+    uint32_t extsize = 0;       // extended header behind the messages
+    uint32_t width = 0;         // index entry size
+    uint32_t lo = 0, hi = 0;    // index entries that changed
+    int offset16 = 0;
+    int newheader = 0;          // 1= extended header moved
+    int keep = 0;               // 1= messages at the end did not move
+    int fd = -1;
+    int rc = 0;
+
+    rc = MsgFileOpen(&mf, target);
+    if (rc != MKMSG_NOERROR)
+        return (rc);
 
-        // tack on the fake ext header
-        for (int x = 0; x < 4; x++)
-            fputc(extfake[x], fpo);
+    if (memcmp(mf.header->identifier, messageinfo->identifier, 3))
+    {
+        MsgFileClose(&mf);
+        return (MKMSG_IDENT_ERROR);
+    }
 
-        fclose(fpo);
+    oldcount = mf.header->numbermsg;
+    newcount = oldcount;
+    first = 0xFFFFFFFF;
 
-        // write output file open for update
-        fpo = fopen(messageinfo->outfile, "r+b");
-        if (fpo == NULL)
-            return (MKMSG_OPEN_ERROR);
+    for (int count = 0; count < messageinfo->numbermsg; count++)
+    {
+        MSGENTRY *entry = &messageinfo->msgtable[count];
+        uint32_t x = entry->number - mf.header->firstmsg;
+
+        if (entry->number < mf.header->firstmsg)
+            rc = MKMSG_MSG_NOT_FOUND;
+        else if (x + 1 > newcount)
+            newcount = x + 1;
+
+        if (x < first)
+            first = x;
+        if (x > last)
+            last = x;
+    }
 
-        // move to position in header
-        fseek(fpo, 0x16L, SEEK_SET);
+    if (rc == MKMSG_NOERROR && newcount > 0xFFFF)
+        rc = MKMSG_INDEX_OVERFLOW;
 
-        // write out extenblock
-        fwrite(&extenblock, sizeof(uint32_t), 1, fpo);
+    if (rc == MKMSG_NOERROR && newcount)
+    {
+        slot = (MSGENTRY **)calloc(newcount, sizeof(MSGENTRY *));
+        if (slot == NULL)
+            rc = MKMSG_MEM_ERROR1;
     }
 
-    printf("Done\n");
+    // a later message of the same number wins
+    for (int count = 0; count < messageinfo->numbermsg && rc == MKMSG_NOERROR; count++)
+        slot[messageinfo->msgtable[count].number - mf.header->firstmsg] =
+            &messageinfo->msgtable[count];
 
-    // close up and get out
-    fclose(fpo);
-    fclose(fpi);
-    free(read_buffer);
-    free(index_buffer);  // why it traps???
+    for (uint32_t x = oldcount; x < newcount && rc == MKMSG_NOERROR; x++)
+        if (slot[x] == NULL)
+            rc = MKMSG_MSG_NOT_FOUND;
 
-    return (MKMSG_NOERROR);
-}
+    if (rc != MKMSG_NOERROR || messageinfo->numbermsg == 0)
+    {
+        free(slot);
+        MsgFileClose(&mf);
+        return (rc);
+    }
 
+    hdroffset = mf.header->hdroffset ? mf.header->hdroffset : sizeof(MSGHEADER);
+    countrysize = mf.country ? sizeof(FILECOUNTRYINFO) : 0;
+    extsize = mf.file.size - mf.msgend;
+    offset16 = mf.header->offset16bit;
+    memcpy(&header, mf.header, sizeof(MSGHEADER));
 
-int writecountryblock(MESSAGEINFO *messageinfo, FILE * fpo)
-{
-    FILECOUNTRYINFO *cntryheader = NULL;
+    // where the first changed message starts now
+    start = mf.msgend;
+    if (first < oldcount)
+    {
+        rc = MsgFileGet(&mf, mf.header->firstmsg + first, &msg);
+        start = (msg.text - 1) - mf.file.data;
+    }
 
-    // generate and write empty country block
-    char *write_buffer = (char *)calloc(1, sizeof(FILECOUNTRYINFO));
-    if (write_buffer == NULL)
-        return (MKMSG_MEM_ERROR5);
+    // end of the messages if nothing in front of start moves
+    offset = start;
+    for (uint32_t x = first; x < newcount; x++)
+        offset += patchlength(&mf, slot[x], mf.header->firstmsg + x);
 
-    memset(write_buffer, 0x00, _msize(write_buffer));
-    cntryheader = (FILECOUNTRYINFO *)write_buffer;
+    OutBufInit(&image, offset - start + extsize);
 
-    cntryheader->bytesperchar = messageinfo->bytesperchar;
-    cntryheader->country = messageinfo->country;
-    cntryheader->langfamilyID = messageinfo->langfamilyID;
-    cntryheader->langversionID = messageinfo->langversionID;
-    cntryheader->codepagesnumber = messageinfo->codepagesnumber;
+    if (rc != MKMSG_NOERROR)
+    {
+        // bad index entry in the file
+        MsgFileClose(&mf);
+    }
+    else if (newcount == oldcount && (!offset16 || offset <= 0xFFFF) &&
+             !patchshared(target))
+    {
+        /*
+         * patch in place
+         */
+        width = offset16 ? 2 : 4;
+
+        index = (char *)malloc(newcount * width);
+        if (index == NULL)
+            rc = MKMSG_MEM_ERROR1;
+        else
+            memcpy(index, mf.index, newcount * width);
 
-    for (int x = 0; x < cntryheader->codepagesnumber; x++)
-        cntryheader->codepages[x] = messageinfo->codepages[x];
+        lo = newcount;
+        hi = 0;
+        offset = start;
+        for (uint32_t x = first; x < newcount && rc == MKMSG_NOERROR; x++)
+        {
+            putindex(index, x, offset, offset16);
+            if (memcmp(index + x * width, mf.index + x * width, width))
+            {
+                if (x < lo)
+                    lo = x;
+                hi = x + 1;
+            }
+            else if (x > last)
+            {
+                // past the last change and back in place, the rest stays
+                keep = 1;
+                break;
+            }
 
-    strncpy(cntryheader->filename,
-            messageinfo->filename,
-            sizeof(cntryheader->filename)-1);
+            rc = patchbody(&image, &mf, slot[x], mf.header->firstmsg + x);
+            offset = start + image.size;
+        }
 
-    cntryheader->filler = 0x00;
+        if (keep)
+            offset = mf.msgend;
+        else if (rc == MKMSG_NOERROR && extsize)
+            rc = OutBufAppend(&image, mf.file.data + mf.msgend, extsize);
+        if (header.extenblock && header.extenblock != offset)
+        {
+            header.extenblock = offset;
+            newheader = 1;
+        }
 
-    fwrite(cntryheader, sizeof(char), sizeof(FILECOUNTRYINFO), fpo);
+        MsgFileClose(&mf);
 
-    free(write_buffer);
+        if (rc == MKMSG_NOERROR)
+        {
+            fd = open(target, O_RDWR | O_BINARY);
+            if (fd == -1)
+                rc = MKMSG_OPEN_ERROR;
+        }
 
-    return (0);
-}
+        if (rc == MKMSG_NOERROR && lo < hi &&
+            (lseek(fd, hdroffset + lo * width, SEEK_SET) == -1 ||
+             write(fd, index + lo * width, (hi - lo) * width) != (int)((hi - lo) * width)))
+            rc = MKMSG_ERRFILEWRITE;
+
+        if (rc == MKMSG_NOERROR &&
+            (lseek(fd, start, SEEK_SET) == -1 ||
+             write(fd, image.data, image.size) != (int)image.size ||
+             (!keep && chsize(fd, start + image.size) != 0)))
+            rc = MKMSG_ERRFILEWRITE;
+
+        if (rc == MKMSG_NOERROR && newheader &&
+            (lseek(fd, 0, SEEK_SET) == -1 ||
+             write(fd, &header, sizeof(MSGHEADER)) != sizeof(MSGHEADER)))
+            rc = MKMSG_ERRFILEWRITE;
+
+        if (fd != -1)
+            close(fd);
+
+        if (rc == MKMSG_NOERROR)
+            msgprintf(messageinfo->log, "Patched %u messages in place, %u bytes from %.3s%04u\n",
+                      messageinfo->numbermsg, image.size,
+                      (char *)messageinfo->identifier, header.firstmsg + first);
+    }
+    else
+    {
+        /*
+         * rebuild: header, index, country info, messages, extended header
+         */
+        offset = 0;
+        for (uint32_t x = 0; x < newcount; x++)
+            offset += patchlength(&mf, slot[x], mf.header->firstmsg + x);
+
+        offset16 = (hdroffset + newcount * 2 + countrysize + offset <= 0xFFFF);
+        width = offset16 ? 2 : 4;
+
+        if (hdroffset + newcount * width > 0xFFFF)
+            rc = MKMSG_COUNTRY_OVERFLOW;
+
+        header.numbermsg = newcount;
+        header.offset16bit = offset16;
+        if (countrysize)
+            header.countryinfo = hdroffset + newcount * width;
+        if (header.extenblock)
+            header.extenblock = hdroffset + newcount * width + countrysize + offset;
+
+        if (rc == MKMSG_NOERROR && OutBufAppend(&image, &header, sizeof(MSGHEADER)) != MKMSG_NOERROR)
+            rc = MKMSG_MEM_ERROR1;
+
+        // anything between header and index is kept
+        if (rc == MKMSG_NOERROR && hdroffset > sizeof(MSGHEADER))
+            rc = OutBufAppend(&image, mf.file.data + sizeof(MSGHEADER), hdroffset - sizeof(MSGHEADER));
+
+        if (rc == MKMSG_NOERROR)
+        {
+            index = OutBufAlloc(&image, newcount * width);
+            if (index == NULL)
+                rc = MKMSG_MEM_ERROR1;
+        }
+        if (rc == MKMSG_NOERROR && countrysize)
+            rc = OutBufAppend(&image, mf.country, countrysize);
 
-/*************************************************************************
- * Function:  writeheader( )
- *
- * Reads in all the MSG file info and stores in MESSAGEINFO structure
- *
- * 1 Open input file in read and out put file in update mode
- * 2 Allocate index and read buffer
- * 3 Set input and output file positions
- * 4 Set index pointer based on uint8/uint32 sizes
- *
- *
- * Return:    returns error code or 0 for all good
- *************************************************************************/
+        for (uint32_t x = 0; x < newcount && rc == MKMSG_NOERROR; x++)
+        {
+            // the image may move, index is an offset into it
+            putindex(image.data + hdroffset, x, image.size, offset16);
+            rc = patchbody(&image, &mf, slot[x], mf.header->firstmsg + x);
+        }
+        index = NULL;
 
-int writeheader(MESSAGEINFO *messageinfo)
-{
-    MSGHEADER *msgheader = NULL;
+        if (rc == MKMSG_NOERROR && extsize)
+            rc = OutBufAppend(&image, mf.file.data + mf.msgend, extsize);
 
-    // write output file open for append
-    FILE *fpo = fopen(messageinfo->outfile, "wb");
-    if (fpo == NULL)
-        return (MKMSG_OPEN_ERROR);
+        MsgFileClose(&mf);
 
-    // buffer to write in a message - start with a 80 size buffer
-    // if for some reason bigger is needed realloc latter
-    char *write_buffer = (char *)calloc(messageinfo->hdroffset, sizeof(char));
-    if (write_buffer == NULL)
-        return (MKMSG_MEM_ERROR3); // fix
+        if (rc == MKMSG_NOERROR)
+            rc = OutBufCommit(&image, target);
 
-    msgheader = (MSGHEADER *)write_buffer;
+        if (rc == MKMSG_NOERROR)
+            msgprintf(messageinfo->log, "Patched %u messages, file rebuilt with %u messages, uint%u index\n",
+                      messageinfo->numbermsg, newcount, offset16 ? 16 : 32);
+    }
 
-    // load MKMSG signature
-    for (int x = 0; x < 8; x++)
-        msgheader->magic_sig[x] = signature[x];
+    free(index);
+    free(slot);
+    OutBufFree(&image);
 
-    for (int x = 0; x < 3; x++)
-        msgheader->identifier[x] = messageinfo->identifier[x];
+    return (rc);
+}
 
-    msgheader->numbermsg = messageinfo->numbermsg;
-    msgheader->firstmsg = messageinfo->firstmsg;
-    msgheader->offset16bit = messageinfo->offsetid;
-    msgheader->version = messageinfo->version;
-    msgheader->hdroffset = messageinfo->hdroffset;
-    msgheader->countryinfo = messageinfo->countryinfo;
-    msgheader->extenblock = messageinfo->extenblock;
+// Symbols of one include file, appended to msgids with one AppendItems
+typedef struct _SYMBATCH
+{
+    OUTBUF names;  // 0x00 terminated names, back to back
+    OUTBUF sizes;  // CARDINAL32 size of each name
+    OUTBUF tags;   // TAG of each name, the message number
+} SYMBATCH;
 
-    for (int x = 0; x < 3; x++)
-        msgheader->reserved[x] = messageinfo->reserved[x];
+/*
+ * symbatchinit( ) - start an empty batch
+ */
+static void symbatchinit(SYMBATCH *batch)
+{
+    OutBufInit(&batch->names, 0);
+    OutBufInit(&batch->sizes, 0);
+    OutBufInit(&batch->tags, 0);
+}
+
+/*
+ * symbatchfree( ) - release the batch
+ */
+static void symbatchfree(SYMBATCH *batch)
+{
+    OutBufFree(&batch->names);
+    OutBufFree(&batch->sizes);
+    OutBufFree(&batch->tags);
+}
 
-    fwrite(msgheader, sizeof(char), messageinfo->hdroffset, fpo);
+/*
+ * symbatchadd( ) - collect one symbol, returns MKMSG error code or 0
+ */
+static int symbatchadd(SYMBATCH *batch, char *id, int num)
+{
+    CARDINAL32 size = strlen(id) + 1;
+    TAG tag = num;
+    int rc;
 
-    // generate and write empty index
-    write_buffer = (char *)realloc(write_buffer, messageinfo->indexsize);
-    if (write_buffer == NULL)
-        return (MKMSG_MEM_ERROR4);
+    rc = OutBufAppend(&batch->names, id, size);
+    if (rc == MKMSG_NOERROR)
+        rc = OutBufAppend(&batch->sizes, &size, sizeof(size));
+    if (rc == MKMSG_NOERROR)
+        rc = OutBufAppend(&batch->tags, &tag, sizeof(tag));
 
-    memset(write_buffer, 0x00, _msize(write_buffer));
-    fwrite(write_buffer, sizeof(char), messageinfo->indexsize, fpo);
+    return (rc);
+}
 
-	writecountryblock(messageinfo, fpo);
+/*
+ * symbatchappend( ) - append the collected symbols to list, returns MKMSG
+ * error code or 0
+ */
+static int symbatchappend(SYMBATCH *batch, DLIST list)
+{
+    CARDINAL32 rc = DLIST_SUCCESS;
 
-    fclose(fpo);
-    free(write_buffer);
+    AppendItems(list, batch->sizes.size / sizeof(CARDINAL32), batch->names.data,
+                (CARDINAL32 *)batch->sizes.data, (TAG *)batch->tags.data, &rc);
 
-    return (0);
+    return (rc == DLIST_SUCCESS ? MKMSG_NOERROR : MKMSG_MEM_ERROR1);
 }
 
 int parseincfile(MESSAGEINFO *messageinfo, char *s)
 {
-	FILE *fpi;
-	char *line=NULL;
-	unsigned int line_size=sizeof(line);
+	LINEBUF src;
+	SYMBATCH batch;
+	char line[256];
+	char *start;
+	char *next;
 	char id[81]={0};
 	char equ[4]={0};
 	int num;
-	unsigned long rc;
+	int rc = MKMSG_NOERROR;
 
-    // open input file
-    fpi = fopen(s, "rb");
-    if (fpi == NULL)
-        return (MKMSG_OPEN_ERROR);
+	// map input file
+	if (LineBufOpen(&src, s) != MKMSG_NOERROR)
+		return (MKMSG_OPEN_ERROR);
 
-	while (!feof(fpi))
+	symbatchinit(&batch);
+	while (rc == MKMSG_NOERROR && (start = LineBufNext(&src, &next)) != NULL)
 	{
-		getline(&line, &line_size, fpi);
-		if (feof(fpi)) break;
-		if (line_size)
+		if (LineBufCopy(start, next, line, sizeof(line)))
 		{
 			if (3==sscanf(line, "%80s %3s %d", id, equ, &num ))
-			{
-				InsertItem (messageinfo->msgids,
-							81,
-							id,
-							num,
-							NULL,
-							AppendToList,
-							FALSE,
-							&rc);
-			}
+				rc = symbatchadd(&batch, id, num);
 		}
 	}
 
-	fclose(fpi);
-    return (0);
+	LineBufClose(&src);
+	if (rc == MKMSG_NOERROR)
+		rc = symbatchappend(&batch, messageinfo->msgids);
+	symbatchfree(&batch);
+	return (rc);
 }
 
 int parsehfile(MESSAGEINFO *messageinfo, char *s)
 {
-	FILE *fpi;
-	char *line=NULL;
-	unsigned int line_size=sizeof(line);
+	LINEBUF src;
+	SYMBATCH batch;
+	char line[256];
+	char *start;
+	char *next;
 	char id[81]={0};
 	char define[10]={0};
 	int num;
-	unsigned long rc;
+	int rc = MKMSG_NOERROR;
 
-    // open input file
-    fpi = fopen(s, "rb");
-    if (fpi == NULL)
-        return (MKMSG_OPEN_ERROR);
+	// map input file
+	if (LineBufOpen(&src, s) != MKMSG_NOERROR)
+		return (MKMSG_OPEN_ERROR);
 
-	while (!feof(fpi))
+	symbatchinit(&batch);
+	while (rc == MKMSG_NOERROR && (start = LineBufNext(&src, &next)) != NULL)
 	{
-		getline(&line, &line_size, fpi);
-		if (feof(fpi)) break;
-		if (line_size)
+		if (LineBufCopy(start, next, line, sizeof(line)))
 		{
 			if (3==sscanf(line, "%9s %80s %d", define, id, &num ))
-			{
-				InsertItem (messageinfo->msgids,
-							81,
-							id,
-							num,
-							NULL,
-							AppendToList,
-							FALSE,
-							&rc);
-			}
+				rc = symbatchadd(&batch, id, num);
 		}
 	}
 
-	fclose(fpi);
-    return (0);
+	LineBufClose(&src);
+	if (rc == MKMSG_NOERROR)
+		rc = symbatchappend(&batch, messageinfo->msgids);
+	symbatchfree(&batch);
+	return (rc);
 }
 
 /*************************************************************************
@@ -1353,7 +2395,7 @@ int parseincludes(MESSAGEINFO *messageinfo)
 	
 	if (messageinfo->include) strcat(dup, messageinfo->include);
 	ev=getenv("INCLUDE");
-	if (ev) strcat(dup, ";");
+	if (ev) strcat(dup, PATH_LIST_STR);
 	if (ev) strcat(dup, ev);
 	if (!strlen(dup))
 	{
@@ -1362,10 +2404,10 @@ int parseincludes(MESSAGEINFO *messageinfo)
 
 	char *s = dup;
 	char *p = NULL;
+	int rc = MKMSG_NOERROR;
 
-	if (dup)
 	do {
-		p = strchr(s, ';');
+		p = strchr(s, PATH_LIST_SEP);
 		if (p != NULL) {
 			p[0] = 0;
 		}
@@ -1384,33 +2426,38 @@ int parseincludes(MESSAGEINFO *messageinfo)
 			strcpy(searchfiles[1], "UTILMD*.H");
 		}
 
-		for (size_t i = 0; i < sizeof(searchfiles) / sizeof(searchfiles[0]); i++)
+		for (size_t i = 0; rc == MKMSG_NOERROR && i < sizeof(searchfiles) / sizeof(searchfiles[0]); i++)
 		{
 			filename[0]=0;
 			strcat(filename, s);
-			strcat(filename, "\\");
+			strcat(filename, PATH_SEP_STR);
 			strcat(filename, searchfiles[i]);
 
-			printf("test=%s\n",filename);
+			msgprintf(messageinfo->log, "test=%s\n",filename);
 			struct _finddata_t c_file;
-			int hFile;
+			long hFile;
 
-			if( (hFile = _findfirst( filename, &c_file )) == -1L )
+			if( (hFile = _findfirst( filename, &c_file )) != -1L )
 			{
 				do {
-					char buffer[30];
-
-					if (messageinfo->asm_format_output)	parseincfile(messageinfo, c_file.name);
-					if (messageinfo->c_format_output)	parsehfile(messageinfo, c_file.name);
-				} while( _findnext( hFile, &c_file ) == 0 );
+					// found name has no path
+					filename[0]=0;
+					strcat(filename, s);
+					strcat(filename, PATH_SEP_STR);
+					strcat(filename, c_file.name);
+
+					if (messageinfo->asm_format_output)	rc = parseincfile(messageinfo, filename);
+					if (messageinfo->c_format_output)	rc = parsehfile(messageinfo, filename);
+				} while( rc == MKMSG_NOERROR && _findnext( hFile, &c_file ) == 0 );
 			_findclose( hFile );
 			}
 		}
    
 		s = p + 1;
-	} while (p != NULL);
+	} while (rc == MKMSG_NOERROR && p != NULL);
 
-    return (0);
+    // the first file that could not be read or stored stops the search
+    return (rc);
 }
 
 /* DecodeLangOpt( )
@@ -1423,14 +2470,14 @@ int DecodeLangOpt(char *dargs, MESSAGEINFO *messageinfo)
 
     if (strchr(dargs, ',') == NULL)
     {
-        ProgError(-1, "MKMSGF: No sub id using 1 default");
+        ProgError(messageinfo->log, -1, "MKMSGF: No sub id using 1 default");
         messageinfo->langversionID = 1;
         messageinfo->langfamilyID = atoi(dargs);
     }
     else
     {
-        messageinfo->langfamilyID = atoi(strtok(dargs, ","));
-        messageinfo->langversionID = atoi(strtok(NULL, ","));
+        messageinfo->langfamilyID = atoi(dargs);
+        messageinfo->langversionID = atoi(strchr(dargs, ',') + 1);
     }
 
     // Language family > 1 and < 35
@@ -1453,43 +2500,59 @@ int DecodeLangOpt(char *dargs, MESSAGEINFO *messageinfo)
 /*
  * User message functions
  */
-void usagelong(void)
+void usagelong(OUTBUF *log)
 {
-    helpshort();
-    helplong();
+    helpshort(log);
+    helplong(log);
 }
 
-void helpshort(void)
+void helpshort(OUTBUF *log)
 {
-    printf("\nMKMSGF infile[.ext] outfile[.ext] [-V]\n");
-    printf("[-D <DBCS range or country>] [-P <code page>] [-L <language id,sub id>]\n");
+    msgprintf(log, "\nMKMSGF infile[.ext] | - outfile[.ext] | - [-V]\n");
+    msgprintf(log, "[-D <DBCS range or country>] [-P <code page>] [-L <language id,sub id>]\n");
+    msgprintf(log, "[-W <16 or 32>] [-K <cache directory>] [-T] [-U <MSG file>]\n");
+    msgprintf(log, "[-X <file,language id,sub id[,code page...]>] ...\n");
+    msgprintf(log, "\nMKMSGF @controlfile [-J <jobs>] [-K <cache directory>]\n");
 }
 
-void helplong(void)
+void helplong(OUTBUF *log)
 {
-    printf("\nUse MKMSGF as follows:\n");
-    printf("        MKMSGF <inputfile> <outputfile> [/V]\n");
-    printf("                [/D <DBCS range or country>] [/P <code page>]\n");
-    printf("                [/L <language family id,sub id>]\n");
-    printf("        where the default values are:\n");
-    printf("           code page  -  none\n");
-    printf("           DBCS range -  none\n");
-    printf("        A valid DBCS range is: n10,n11,n20,n21,...,nn0,nn1\n");
-    printf("        A single number is taken as a DBCS country code.\n");
-    printf("        The valid OS/2 language/sublanguage ID values are:\n\n");
-    printf("\tLanguage ID:\n");
-    printf("\tCode\tFamily\tSub\tLanguage\tPrincipal country\n");
-    printf("\t----\t------\t---\t--------\t-----------------\n");
+    msgprintf(log, "\nUse MKMSGF as follows:\n");
+    msgprintf(log, "        MKMSGF <inputfile> <outputfile> [/V]\n");
+    msgprintf(log, "                inputfile - reads stdin, outputfile - (the\n");
+    msgprintf(log, "                default with stdin) writes to stdout\n");
+    msgprintf(log, "                [/D <DBCS range or country>] [/P <code page>]\n");
+    msgprintf(log, "                [/L <language family id,sub id>]\n");
+    msgprintf(log, "                [/W <16 or 32 bit index, default smallest>]\n");
+    msgprintf(log, "                [/K <cache directory, reuse output of unchanged input>]\n");
+    msgprintf(log, "                [/T verify: compile, decompile and compile again in\n");
+    msgprintf(log, "                    memory, report the first message that differs]\n");
+    msgprintf(log, "                [/U <MSG file, replace or add the input messages>]\n");
+    msgprintf(log, "                [/X <file,language id,sub id[,code page...]>] ...\n");
+    msgprintf(log, "                    add file compiled as another language of\n");
+    msgprintf(log, "                    the output, up to %d times\n", MAX_LANG_VARIANTS);
+    msgprintf(log, "        MKMSGF @<controlfile> [/J <jobs>] [/K <cache directory>]\n");
+    msgprintf(log, "                one MKMSGF command line per control file line,\n");
+    msgprintf(log, "                /J compiles that many lines at the same time\n");
+    msgprintf(log, "        where the default values are:\n");
+    msgprintf(log, "           code page  -  none\n");
+    msgprintf(log, "           DBCS range -  none\n");
+    msgprintf(log, "        A valid DBCS range is: n10,n11,n20,n21,...,nn0,nn1\n");
+    msgprintf(log, "        A single number is taken as a DBCS country code.\n");
+    msgprintf(log, "        The valid OS/2 language/sublanguage ID values are:\n\n");
+    msgprintf(log, "\tLanguage ID:\n");
+    msgprintf(log, "\tCode\tFamily\tSub\tLanguage\tPrincipal country\n");
+    msgprintf(log, "\t----\t------\t---\t--------\t-----------------\n");
     for (int i = 0; langinfo[i].langfam != 0; i++)
-        printf("\t%s\t%d\t%d\t%-20s\t%s\n", langinfo[i].langcode,
+        msgprintf(log, "\t%s\t%d\t%d\t%-20s\t%s\n", langinfo[i].langcode,
                langinfo[i].langfam, langinfo[i].langsub, langinfo[i].lang, langinfo[i].country);
 }
 
-void prgheading(void)
+void prgheading(OUTBUF *log)
 {
-    printf("\nOperating System/2 Make Message File Utility (MKMSGF) Clone\n");
-    printf("Version %s  Michael Greene <mikeos2@gmail.com>\n", SYSLVERSION);
-    printf("Compiled with Open Watcom %d.%d  %s\n", OWMAJOR, OWMINOR, __DATE__);
+    msgprintf(log, "\nOperating System/2 Make Message File Utility (MKMSGF) Clone\n");
+    msgprintf(log, "Version %s  Michael Greene <mikeos2@gmail.com>\n", SYSLVERSION);
+    msgprintf(log, "Compiled with %s %d.%d  %s\n", CCNAME, CCMAJOR, CCMINOR, __DATE__);
 }
 
 /*************************************************************************
@@ -1501,47 +2564,47 @@ void prgheading(void)
 
 void displayinfo(MESSAGEINFO *messageinfo)
 {
-    printf("\n*********** Header Info ***********\n\n");
+    msgprintf(messageinfo->log, "\n*********** Header Info ***********\n\n");
 
-    printf("Input filename         %s\n", messageinfo->infile);
-    printf("Component Identifier:  %c%c%c\n", messageinfo->identifier[0],
+    msgprintf(messageinfo->log, "Input filename         %s\n", messageinfo->infile);
+    msgprintf(messageinfo->log, "Component Identifier:  %c%c%c\n", messageinfo->identifier[0],
            messageinfo->identifier[1], messageinfo->identifier[2]);
-    printf("Number of messages:    %d\n", messageinfo->numbermsg);
-    printf("First message number:  %d\n", messageinfo->firstmsg);
-    printf("OffsetID:              %d  (Offset %s)\n", messageinfo->offsetid,
+    msgprintf(messageinfo->log, "Number of messages:    %d\n", messageinfo->numbermsg);
+    msgprintf(messageinfo->log, "First message number:  %d\n", messageinfo->firstmsg);
+    msgprintf(messageinfo->log, "OffsetID:              %d  (Offset %s)\n", messageinfo->offsetid,
            (messageinfo->offsetid ? "uint16_t" : "uint32_t"));
-    printf("MSG File Version:      %d\n", messageinfo->version);
-    printf("Header offset:         0x%02X (%d)\n",
+    msgprintf(messageinfo->log, "MSG File Version:      %d\n", messageinfo->version);
+    msgprintf(messageinfo->log, "Header offset:         0x%02X (%d)\n",
            messageinfo->hdroffset, messageinfo->hdroffset);
-    printf("Country Info:          0x%02X (%d)\n",
+    msgprintf(messageinfo->log, "Country Info:          0x%02X (%d)\n",
            messageinfo->countryinfo, messageinfo->countryinfo);
-    printf("Extended Header:       0x%02X (%lu)\n",
+    msgprintf(messageinfo->log, "Extended Header:       0x%02X (%lu)\n",
            messageinfo->extenblock, messageinfo->extenblock);
-    printf("Reserved area:         ");
+    msgprintf(messageinfo->log, "Reserved area:         ");
     for (int x = 0; x < 5; x++)
-        printf("%02X ", messageinfo->reserved[x]);
-    printf("\n");
+        msgprintf(messageinfo->log, "%02X ", messageinfo->reserved[x]);
+    msgprintf(messageinfo->log, "\n");
 
     if (messageinfo->version == 2)
     {
-        printf("\n*********** Country Info  ***********\n\n");
-        printf("Bytes per character:       %d\n", messageinfo->bytesperchar);
-        printf("Country Code:              %d\n", messageinfo->country);
-        printf("Language family ID:        %d\n", messageinfo->langfamilyID);
-        printf("Language version ID:       %d\n", messageinfo->langversionID);
-        printf("Number of codepages:       %d\n", messageinfo->codepagesnumber);
+        msgprintf(messageinfo->log, "\n*********** Country Info  ***********\n\n");
+        msgprintf(messageinfo->log, "Bytes per character:       %d\n", messageinfo->bytesperchar);
+        msgprintf(messageinfo->log, "Country Code:              %d\n", messageinfo->country);
+        msgprintf(messageinfo->log, "Language family ID:        %d\n", messageinfo->langfamilyID);
+        msgprintf(messageinfo->log, "Language version ID:       %d\n", messageinfo->langversionID);
+        msgprintf(messageinfo->log, "Number of codepages:       %d\n", messageinfo->codepagesnumber);
         for (int x = 0; x < messageinfo->codepagesnumber; x++)
-            printf("0x%02X (%d)  ", messageinfo->codepages[x], messageinfo->codepages[x]);
-        printf("\n");
-        printf("File name:                 %s\n\n", messageinfo->filename);
+            msgprintf(messageinfo->log, "0x%02X (%d)  ", messageinfo->codepages[x], messageinfo->codepages[x]);
+        msgprintf(messageinfo->log, "\n");
+        msgprintf(messageinfo->log, "File name:                 %s\n\n", messageinfo->filename);
         if (messageinfo->extenblock)
         {
-            printf("** Has an extended header **\n");
-            printf("Ext header length:        %d\n", messageinfo->extlength);
-            printf("Number ext blocks:        %d\n\n", messageinfo->extnumblocks);
+            msgprintf(messageinfo->log, "** Has an extended header **\n");
+            msgprintf(messageinfo->log, "Ext header length:        %d\n", messageinfo->extlength);
+            msgprintf(messageinfo->log, "Number ext blocks:        %d\n\n", messageinfo->extnumblocks);
         }
         else
-            printf("** No an extended header **\n\n");
+            msgprintf(messageinfo->log, "** No an extended header **\n\n");
     }
     return;
 }
@@ -1552,25 +2615,45 @@ void displayinfo(MESSAGEINFO *messageinfo)
  *
  * if exnum < 0 then print heading (if not yet displayed) and
  * return.
- * else do the above and exit
+ * else also print the short help. Nothing exits here any more, the
+ * error is returned so a control file job can fail on its own.
  *
+ * Return:    exnum
  */
 
-void ProgError(int exnum, char *dispmsg)
+int ProgError(OUTBUF *log, int exnum, char *dispmsg)
 {
-    char buffer[80] = {0};
+    if (exnum >= 0)
+        helpshort(log);
 
-    sprintf(buffer, "\n%s (%d)\n", dispmsg, exnum);
+    msgprintf(log, "\n%s (%d)\n", dispmsg, exnum);
 
-    if (exnum < 0)
-    {
-        printf("%s", buffer);
-        return;
-    }
+    return (exnum);
+}
+
+/*
+ * isfilearg( ) - 1 if arg is a file name, not an option: it does not
+ * start with - or /, or it is - alone (stdin / stdout)
+ */
+int isfilearg(char *arg)
+{
+    return ((*arg != '-' && *arg != '/') || !strcmp(arg, "-"));
+}
+
+/*
+ * msgprintf( )
+ *
+ * all display goes through here - to the job log if there is one,
+ * else straight to the screen
+ */
+void msgprintf(OUTBUF *log, const char *format, ...)
+{
+    va_list args;
+
+    va_start(args, format);
+    if (log == NULL)
+        vfprintf(screen, format, args);
     else
-    {
-        helpshort();
-        printf("%s", buffer);
-        exit(exnum);
-    }
+        OutBufVPrintf(log, format, args);
+    va_end(args);
 }
@@ -40,10 +40,15 @@
 
 #include <stdint.h>
 #include <dlist.h>
+#include "linebuf.h"
+#include "outbuf.h"
 
 /* Basic msg file layout:
 
                ^
+               |  Language variants: EXTHDR, numblocks EXTBLOCK entries
+               |  and a complete MSG image for each (mkmsgf -X)
+               |
                |  Messages
                |  FILECOUNTRYINFO
                |
@@ -60,7 +65,7 @@
 typedef struct _MSGHEADER
 {
     uint8_t magic_sig[8];  // Magic word signature
-    uint8_t identifier[4]; // Identifier (SYS, DOS, NET, etc.)
+    uint8_t identifier[3]; // Identifier (SYS, DOS, NET, etc.)
     uint16_t numbermsg;    // Number of messages
     uint16_t firstmsg;     // Number of the first message
     int8_t offset16bit;    // Index table index uint16 == 1 or uint32 == 0
@@ -87,11 +92,21 @@ typedef struct _FILECOUNTRYINFO
 // extended header block
 typedef struct _EXTHDR
 {
-    uint16_t hdrlen;    // length of FILECOUNTRYINFO block
-    uint16_t numblocks; // number of additional FILECOUNTRYINFO blocks
+    uint16_t hdrlen;    // length of one block, sizeof(EXTBLOCK) for -X
+    uint16_t numblocks; // number of blocks following the header
 } EXTHDR, *PEXTHDR;
 
-typedef struct suppinfo
+// additional language block, the entries follow the EXTHDR. offset is
+// from the start of the EXTHDR to the MSG image of this language, its
+// own offsets are from the start of that image
+typedef struct _EXTBLOCK
+{
+    FILECOUNTRYINFO country; // language and codepages of the image
+    uint32_t offset;         // MSG image offset from the EXTHDR
+    uint32_t size;           // MSG image size in bytes
+} EXTBLOCK, *PEXTBLOCK;
+
+struct suppinfo
 {
     char langcode[4];
     int langfam;
@@ -100,58 +115,22 @@ typedef struct suppinfo
     char country[15];
 };
 
-struct suppinfo langinfo[] = {
-    {"ARA", 1, 2, "Arabic", "Arab Countries"},
-    {"BGR", 2, 1, "Bulgarian", "Bulgaria"},
-    {"CAT", 3, 1, "Catalan", "Spain"},
-    {"CHT", 4, 1, "Traditional Chinese", "R.O.C."},
-    {"CHS", 4, 2, "Simplified Chinese", "P.R.C."},
-    {"CSY", 5, 1, "Czech", "Czechoslovakia"},
-    {"DAN", 6, 1, "Danish", "Denmark"},
-    {"DEU", 7, 1, "German", "Germany"},
-    {"DES", 7, 2, "Swiss German", "Switzerland"},
-    {"EEL", 8, 1, "Greek", "Greece"},
-    {"ENU", 9, 1, "US English", "United States"},
-    {"ENG", 9, 2, "UK English", "United Kingdom"},
-    {"ESP", 10, 1, "Castilian Spanish", "Spain"},
-    {"ESM", 10, 2, "Mexican Spanish", "Mexico"},
-    {"FIN", 11, 1, "Finnish", "Finland"},
-    {"FRA", 12, 1, "French", "France"},
-    {"FRB", 12, 2, "Belgian French", "Belgium"},
-    {"FRC", 12, 3, "Canadian French", "Canada"},
-    {"FRS", 12, 4, "Swiss French", "Switzerland"},
-    {"HEB", 13, 1, "Hebrew", "Israel"},
-    {"HUN", 14, 1, "Hungarian", "Hungary"},
-    {"ISL", 15, 1, "Icelandic", "Iceland"},
-    {"ITA", 16, 1, "Italian", "Italy"},
-    {"ITS", 16, 2, "Swiss Italian", "Switzerland"},
-    {"JPN", 17, 1, "Japanese", "Japan"},
-    {"KOR", 18, 1, "Korean", "Korea"},
-    {"NLD", 19, 1, "Dutch", "Netherlands"},
-    {"NLB", 19, 2, "Belgian Dutch", "Belgium"},
-    {"NOR", 20, 1, "Norwegian - Bokmal", "Norway"},
-    {"NON", 20, 2, "Norwegian - Nynorsk", "Norway"},
-    {"PLK", 21, 1, "Polish", "Poland"},
-    {"PTB", 22, 1, "Brazilian Portugues", "Brazil"},
-    {"PTG", 22, 2, "Portuguese", "Portugal"},
-    {"RMS", 23, 1, "Rhaeto-Romanic", "Switzerland"},
-    {"ROM", 24, 1, "Romanian", "Romania"},
-    {"RUS", 25, 1, "Russian", "Russia"},
-    {"SHL", 26, 1, "Croato-Serbian", "Yugoslavia"},
-    {"SHC", 26, 2, "Serbo-Croatian", "Yugoslavia"},
-    {"SKY", 27, 1, "Slovakian", "Czechoslovakia"},
-    {"SQI", 28, 1, "Albanian", "Albania"},
-    {"SVE", 29, 1, "Swedish", "Sweden"},
-    {"THA", 30, 1, "Thai", "Thailand"},
-    {"TRK", 31, 1, "Turkish", "Turkey"},
-    {"URD", 32, 1, "Urdu", "Pakistan"},
-    {"BAH", 33, 1, "Bahasa", "Indonesia"},
-    {"SLO", 34, 1, "Slovene", "Slovenia"},
-    {"MAX", 0, 0, "NONE", "NONE"},
-};
+// language codes for -d and the /L check, defined in mkmsgf.c
+extern struct suppinfo langinfo[];
 
 #pragma pack(pop)
 
+// One message of the compile input - start/end span the source lines
+// of the message in the input buffer (comment lines included)
+typedef struct _MSGENTRY
+{
+    char *start;     // first line, the one with the message ID
+    char *end;       // one past the last line of the message
+    uint32_t length; // compiled length, type byte included
+    uint16_t number; // message number from the ID
+    char type;       // message type E, H, I, P, W or ?
+} MSGENTRY;
+
 // Header of message file
 typedef struct _MESSAGEINFO
 {
@@ -163,12 +142,13 @@ typedef struct _MESSAGEINFO
     char inext[_MAX_EXT];
     char outfile[_MAX_PATH]; // output filename
     char *include;				// include paths
+    char *cachedir;              // -k compile cache directory, NULL = none
     uint8_t asm_format_output; // 1= include is ASM INC
     uint8_t c_format_output; // 1= include is C H
 
     uint8_t verbose; // how much to see?
     // compile/decompile info
-    uint8_t identifier[3];       // Identifier (SYS, DOS, NET, etc.)
+    uint8_t identifier[4];       // Identifier (SYS, DOS, NET, etc.) + 0x00
     uint16_t numbermsg;          // Number of messages
     uint16_t firstmsg;           // Number of the first message
     int8_t offsetid;             // Index table index uint16 == 1 or uint32 == 0
@@ -186,23 +166,30 @@ typedef struct _MESSAGEINFO
     uint8_t filename[_MAX_PATH]; // Name of file
     uint16_t extlength;          // length of FILECOUNTRYINFO block
     uint16_t extnumblocks;       // number of additional sub FILECOUNTRYINFO blocks
-    fpos_t indexoffset;          // okay dup of hdroffset
-    uint16_t indexsize;          // size in bytes of index
-    fpos_t msgoffset;            // offset to start of messages
+    uint32_t indexoffset;        // okay dup of hdroffset
+    uint32_t indexsize;          // size in bytes of index
+    uint32_t msgoffset;          // offset to start of messages
     uint32_t msgfinalindex;      // offset to end of messages
-    fpos_t msgstartline;         // start position for compile
+    LINEBUF source;              // compile input file in memory
+    MSGENTRY *msgtable;          // compile message table, numbermsg entries
     uint8_t langfamilyIDcode;    // Save array position for easy lookup
     uint8_t fakeextend;          // Append a fake extended header
     uint8_t fixlastline;         // Try and fix last line issues
+    uint8_t indexwidth;          // -w option: 16, 32 or 0 for smallest
 	DLIST msgids;				// Message IDs constants from include files
+    OUTBUF *log;                 // display output, NULL = screen
 } MESSAGEINFO;
 
 // mkmsgf header signature - a valid MSG file alway starts with
-// these 8 bytes 0xFF MKMSGF 0x00
-char signature[] = {0xFF, 0x4D, 0x4B, 0x4D, 0x53, 0x47, 0x46, 0x00};
+// these 8 bytes 0xFF MKMSGF 0x00, defined in msgapi.c
+extern uint8_t signature[8];
 
-char extfake[] = {0x2E, 0x01, 0x00, 0x00};
+// fake extended header appended by -F, defined in mkmsgf.c
+extern uint8_t extfake[4];
 
 #define ASM_MSG_SIZE 16
 
+// most /X language variants in one MSG file
+#define MAX_LANG_VARIANTS 32
+
 #endif
@@ -0,0 +1,440 @@
+/****************************************************************************
+ *
+ *  msgapi.c -- Make Message File Utilities
+ *
+ *  ========================================================================
+ *
+ *  Description: Runtime message lookup over compiled MSG files.
+ *
+ *  ========================================================================
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include "msgapi.h"
+#include "mkmsgerr.h"
+
+// MSG file signature, see mkmsgf.h
+uint8_t signature[8] = {0xFF, 0x4D, 0x4B, 0x4D, 0x53, 0x47, 0x46, 0x00};
+
+/*
+ * indexentry( ) - file offset of index entry x, the index starts at an
+ * odd offset so read it byte by byte
+ */
+static uint32_t indexentry(MSGFILE *mf, uint32_t x)
+{
+    uint8_t *p;
+
+    if (mf->header->offset16bit)
+    {
+        p = mf->index + x * 2;
+        return (p[0] | (uint32_t)p[1] << 8);
+    }
+
+    p = mf->index + x * 4;
+    return (p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24);
+}
+
+/*************************************************************************
+ * Function:  msgfilecheck( )
+ *
+ * Set up the header, country info and index views of mf->file
+ *
+ * 1 Check the signature
+ * 2 Check the index fits in the file, old files may have no header
+ *   offset (same fix as mkmsgd)
+ * 3 Version 2 files have the country info block, the message area ends
+ *   at the extended header if there is one, else at the end of file
+ * 4 Language variant blocks are used when the extended header has a
+ *   complete table of them, anything else (the /E stub) has none
+ *
+ * Return:    returns error code or 0 for all good
+ *************************************************************************/
+
+static int msgfilecheck(MSGFILE *mf)
+{
+    uint32_t hdroffset;
+    uint32_t indexsize;
+
+    if (mf->file.size < sizeof(MSGHEADER) ||
+        memcmp(mf->file.data, signature, sizeof(signature)) != 0)
+        return (MKMSG_HEADER_ERROR);
+
+    mf->header = (MSGHEADER *)mf->file.data;
+
+    hdroffset = mf->header->hdroffset ? mf->header->hdroffset : sizeof(MSGHEADER);
+    indexsize = mf->header->numbermsg * (mf->header->offset16bit ? 2 : 4);
+
+    if (hdroffset + indexsize > mf->file.size)
+        return (MKMSG_INDEX_ERROR);
+
+    mf->index = (uint8_t *)mf->file.data + hdroffset;
+    mf->msgend = mf->file.size;
+
+    if (mf->header->version == 2)
+    {
+        if (mf->header->countryinfo + sizeof(FILECOUNTRYINFO) > mf->file.size)
+            return (MKMSG_READHDR_ERR);
+
+        mf->country = (FILECOUNTRYINFO *)(mf->file.data + mf->header->countryinfo);
+
+        if (mf->header->extenblock && mf->header->extenblock < mf->file.size)
+            mf->msgend = mf->header->extenblock;
+    }
+
+    if (mf->msgend + sizeof(EXTHDR) <= mf->file.size)
+    {
+        EXTHDR *ext = (EXTHDR *)(mf->file.data + mf->msgend);
+
+        if (ext->hdrlen == sizeof(EXTBLOCK) && ext->numblocks &&
+            mf->msgend + sizeof(EXTHDR) + ext->numblocks * sizeof(EXTBLOCK) <= mf->file.size)
+        {
+            mf->blocks = (EXTBLOCK *)(ext + 1);
+            mf->numblocks = ext->numblocks;
+        }
+    }
+
+    return (MKMSG_NOERROR);
+}
+
+/*
+ * MsgFileOpen( )
+ *
+ * map a MSG file and check it
+ */
+int MsgFileOpen(MSGFILE *mf, const char *filename)
+{
+    int rc;
+
+    memset(mf, 0, sizeof(MSGFILE));
+
+    rc = LineBufOpen(&mf->file, filename);
+    if (rc == MKMSG_NOERROR)
+        rc = msgfilecheck(mf);
+    if (rc != MKMSG_NOERROR)
+        MsgFileClose(mf);
+
+    return (rc);
+}
+
+/*
+ * MsgFileMem( )
+ *
+ * check a MSG image in memory, mf only borrows data
+ */
+int MsgFileMem(MSGFILE *mf, char *data, uint32_t size)
+{
+    int rc;
+
+    memset(mf, 0, sizeof(MSGFILE));
+
+    mf->file.data = data;
+    mf->file.pos = data;
+    mf->file.size = size;
+    mf->borrowed = 1;
+
+    rc = msgfilecheck(mf);
+    if (rc != MKMSG_NOERROR)
+        MsgFileClose(mf);
+
+    return (rc);
+}
+
+/*
+ * MsgFileBlock( )
+ *
+ * open a language variant image, it has to be inside the file
+ */
+int MsgFileBlock(MSGFILE *mf, uint32_t block, MSGFILE *sub)
+{
+    uint32_t room;
+    EXTBLOCK *eb;
+
+    memset(sub, 0, sizeof(MSGFILE));
+
+    if (block >= mf->numblocks)
+        return (MKMSG_MSG_NOT_FOUND);
+
+    eb = &mf->blocks[block];
+    room = mf->file.size - mf->msgend;
+
+    if (eb->offset > room || eb->size > room - eb->offset)
+        return (MKMSG_INDEX_ERROR);
+
+    return (MsgFileMem(sub, mf->file.data + mf->msgend + eb->offset, eb->size));
+}
+
+/*
+ * langmatch( ) - 1 if country is language langfamily/langversion with
+ * codepage, 0 values match anything
+ */
+static int langmatch(FILECOUNTRYINFO *country, uint16_t langfamily,
+                     uint16_t langversion, uint16_t codepage)
+{
+    if (country->langfamilyID != langfamily)
+        return (0);
+    if (langversion && country->langversionID != langversion)
+        return (0);
+    if (!codepage || !country->codepagesnumber)
+        return (1);
+
+    for (int x = 0; x < country->codepagesnumber && x < 16; x++)
+        if (country->codepages[x] == codepage)
+            return (1);
+
+    return (0);
+}
+
+/*************************************************************************
+ * Function:  MsgFileSelect( )
+ *
+ * 1 The main language of the file, sub is a second view of the file
+ * 2 Else the first variant block that matches
+ *
+ * Return:    returns error code or 0 for all good
+ *************************************************************************/
+
+int MsgFileSelect(MSGFILE *mf, uint16_t langfamily, uint16_t langversion,
+                  uint16_t codepage, MSGFILE *sub)
+{
+    memset(sub, 0, sizeof(MSGFILE));
+
+    if (mf->country != NULL &&
+        langmatch(mf->country, langfamily, langversion, codepage))
+        return (MsgFileMem(sub, mf->file.data, mf->file.size));
+
+    for (uint32_t x = 0; x < mf->numblocks; x++)
+        if (langmatch(&mf->blocks[x].country, langfamily, langversion, codepage))
+            return (MsgFileBlock(mf, x, sub));
+
+    return (MKMSG_MSG_NOT_FOUND);
+}
+
+/*************************************************************************
+ * Function:  MsgFileScan( )
+ *
+ * Same checks as MsgFileOpen, but only the header and the country info
+ * block are read, the index and messages are not touched
+ *
+ * 1 Read the header, check the signature
+ * 2 Check the index fits in the file
+ * 3 Version 2 files: read the country info block
+ *
+ * Return:    returns error code or 0 for all good
+ *************************************************************************/
+
+int MsgFileScan(const char *filename, MSGSCAN *scan)
+{
+    struct stat st;
+    uint32_t hdroffset;
+    uint32_t indexsize;
+    int fd;
+    int rc = MKMSG_NOERROR;
+
+    memset(scan, 0, sizeof(MSGSCAN));
+
+    fd = open(filename, O_RDONLY | O_BINARY);
+    if (fd == -1)
+        return (MKMSG_OPEN_ERROR);
+
+    if (fstat(fd, &st) != 0 || st.st_size < 0 || st.st_size > 0x7FFFFFFFL)
+    {
+        close(fd);
+        return (MKMSG_READ_ERROR);
+    }
+    scan->size = (uint32_t)st.st_size;
+
+    if (read(fd, &scan->header, sizeof(MSGHEADER)) != sizeof(MSGHEADER) ||
+        memcmp(scan->header.magic_sig, signature, sizeof(signature)) != 0)
+    {
+        close(fd);
+        return (MKMSG_HEADER_ERROR);
+    }
+
+    hdroffset = scan->header.hdroffset ? scan->header.hdroffset : sizeof(MSGHEADER);
+    indexsize = scan->header.numbermsg * (scan->header.offset16bit ? 2 : 4);
+
+    if (hdroffset + indexsize > scan->size)
+        rc = MKMSG_INDEX_ERROR;
+    else if (scan->header.version == 2 &&
+             (scan->header.countryinfo + sizeof(FILECOUNTRYINFO) > scan->size ||
+              lseek(fd, scan->header.countryinfo, SEEK_SET) == -1 ||
+              read(fd, &scan->country, sizeof(FILECOUNTRYINFO)) != sizeof(FILECOUNTRYINFO)))
+        rc = MKMSG_READHDR_ERR;
+
+    close(fd);
+
+    return (rc);
+}
+
+/*
+ * MsgFileClose( )
+ *
+ * unmap the file, a borrowed image is left alone
+ */
+void MsgFileClose(MSGFILE *mf)
+{
+    if (!mf->borrowed)
+        LineBufClose(&mf->file);
+    memset(mf, 0, sizeof(MSGFILE));
+}
+
+/*************************************************************************
+ * Function:  MsgFileGet( )
+ *
+ * Message number x is index entry x - firstmsg, it ends where the next
+ * message starts (or at the end of the message area for the last one)
+ *
+ * Return:    returns error code or 0 for all good
+ *************************************************************************/
+
+int MsgFileGet(MSGFILE *mf, uint32_t number, MSGTEXT *msg)
+{
+    uint32_t x;
+    uint32_t start;
+    uint32_t end;
+
+    if (number < mf->header->firstmsg)
+        return (MKMSG_MSG_NOT_FOUND);
+
+    x = number - mf->header->firstmsg;
+    if (x >= mf->header->numbermsg)
+        return (MKMSG_MSG_NOT_FOUND);
+
+    start = indexentry(mf, x);
+    if (x + 1 < mf->header->numbermsg)
+        end = indexentry(mf, x + 1);
+    else
+        end = mf->msgend;
+
+    // at least the type byte, inside the file
+    if (start >= end || end > mf->file.size)
+        return (MKMSG_INDEX_ERROR);
+
+    msg->type = mf->file.data[start];
+    msg->text = mf->file.data + start + 1;
+    msg->length = end - start - 1;
+    msg->number = (uint16_t)number;
+
+    return (MKMSG_NOERROR);
+}
+
+/*
+ * MsgTextHash( )
+ *
+ * FNV-1a over the type byte and the text
+ */
+uint32_t MsgTextHash(MSGTEXT *msg)
+{
+    uint32_t h = 0x811C9DC5;
+
+    h = (h ^ (uint8_t)msg->type) * 0x01000193;
+    for (uint32_t x = 0; x < msg->length; x++)
+        h = (h ^ (uint8_t)msg->text[x]) * 0x01000193;
+
+    return (h);
+}
+
+/*************************************************************************
+ * Function:  MsgFileSourceEnd( )
+ *
+ * 1 Cut the message at a 0x00, had a couple questionable messages
+ * 2 Any message can use the <CR> option! If the original message ended
+ *   with %0, it is compiled without a <CR>, so if there is no 0x0D 0x0A
+ *   at the end the source needs %0 and 0x0D 0x0A
+ *
+ * Return:    line end that goes after the message text
+ *************************************************************************/
+
+const char *MsgFileSourceEnd(MSGTEXT *msg)
+{
+    char *nul = memchr(msg->text, 0x00, msg->length);
+
+    if (nul != NULL)
+        msg->length = nul - msg->text;
+
+    if ((msg->length < 1 || msg->text[msg->length - 1] != 0x0A) &&
+        (msg->length < 2 || msg->text[msg->length - 2] != 0x0D))
+        return ("%0\r\n");
+
+    return ("");
+}
+
+/*
+ * formatput( ) - append len bytes to buf as far as they fit, pos counts
+ * the full length
+ */
+static void formatput(char *buf, uint32_t size, uint32_t *pos,
+                      const char *data, uint32_t len)
+{
+    if (*pos + 1 < size)
+    {
+        uint32_t room = size - 1 - *pos;
+        memcpy(buf + *pos, data, len < room ? len : room);
+    }
+    *pos += len;
+}
+
+/*************************************************************************
+ * Function:  MsgFileFormat( )
+ *
+ * 1 E and W messages start with the component ID and number
+ * 2 Copy the text, %1 - %9 with a table entry are replaced
+ * 3 Terminate buf at the end or where it is full
+ *
+ * Return:    length of the complete formatted message
+ *************************************************************************/
+
+uint32_t MsgFileFormat(MSGFILE *mf, MSGTEXT *msg, char **table,
+                       uint32_t count, char *buf, uint32_t size)
+{
+    char prefix[16];
+    uint32_t pos = 0;
+    uint32_t from = 0;
+    uint32_t x;
+
+    if (msg->type == 'E' || msg->type == 'W')
+    {
+        int len = sprintf(prefix, "%.3s%04u: ", (char *)mf->header->identifier,
+                          (unsigned int)msg->number);
+        formatput(buf, size, &pos, prefix, (uint32_t)len);
+    }
+
+    for (x = 0; x + 1 < msg->length; x++)
+    {
+        uint32_t parm = msg->text[x + 1] - '1';
+
+        if (msg->text[x] != '%' || parm > 8 || parm >= count)
+            continue;
+
+        // text up to the %, then the insert
+        formatput(buf, size, &pos, msg->text + from, x - from);
+        if (table[parm] != NULL)
+            formatput(buf, size, &pos, table[parm], strlen(table[parm]));
+
+        x++;
+        from = x + 1;
+    }
+
+    formatput(buf, size, &pos, msg->text + from, msg->length - from);
+
+    if (size)
+        buf[pos < size ? pos : size - 1] = 0x00;
+
+    return (pos);
+}
@@ -0,0 +1,119 @@
+/****************************************************************************
+ *
+ *  msgapi.h -- Make Message File Utilities
+ *
+ *  ========================================================================
+ *
+ *  Description: Runtime message lookup over compiled MSG files. The file
+ *               is mapped into memory once, a message is found with one
+ *               index lookup and handed out as a view into the mapping.
+ *               MsgFileFormat does the DosGetMessage style %1 - %9
+ *               substitution.
+ *
+ *  ========================================================================
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ ***************************************************************************/
+
+#ifndef MSGAPI_H
+#define MSGAPI_H
+
+#include <stdint.h>
+#include "compat.h"
+#include "mkmsgf.h"
+
+// An open MSG file, all pointers are into the file mapping
+typedef struct _MSGFILE
+{
+    LINEBUF file;              // mapped MSG file
+    MSGHEADER *header;         // file header
+    FILECOUNTRYINFO *country;  // country info, NULL for version 0 files
+    uint8_t *index;            // message index, uint16 or uint32 entries
+    uint32_t msgend;           // offset one past the last message
+    EXTBLOCK *blocks;          // language variant blocks, NULL if none
+    uint16_t numblocks;        // number of language variant blocks
+    uint8_t borrowed;          // 1= file.data belongs to the caller
+} MSGFILE;
+
+// One message of a MSG file. text is NOT 0x00 terminated, it ends with
+// 0x0D 0x0A unless the source line ended in %0.
+typedef struct _MSGTEXT
+{
+    char *text;       // message text, type byte not included
+    uint32_t length;  // length of text in bytes
+    uint16_t number;  // message number
+    char type;        // message type E, H, I, P, W or ? (placeholder)
+} MSGTEXT;
+
+// Header of a MSG file read without the messages, see MsgFileScan
+typedef struct _MSGSCAN
+{
+    MSGHEADER header;          // file header
+    FILECOUNTRYINFO country;   // country info, zero for version 0 files
+    uint32_t size;             // file size
+} MSGSCAN;
+
+// Map filename and check signature, header and index. Returns MKMSG
+// error code or 0.
+int MsgFileOpen(MSGFILE *mf, const char *filename);
+
+// Same as MsgFileOpen for a MSG image of size bytes in memory. data
+// stays the caller's, it must outlive mf. Returns MKMSG error code or 0.
+int MsgFileMem(MSGFILE *mf, char *data, uint32_t size);
+
+// Read only the header and country block of filename, with the same
+// checks as MsgFileOpen. Meant for scanning many files. Returns MKMSG
+// error code or 0.
+int MsgFileScan(const char *filename, MSGSCAN *scan);
+
+// Unmap the file, safe to call on a zeroed or closed MSGFILE.
+void MsgFileClose(MSGFILE *mf);
+
+// Open language variant block (0 to numblocks - 1) of mf as sub. sub
+// borrows the mapping of mf, close it before mf. Returns MKMSG error
+// code or 0.
+int MsgFileBlock(MSGFILE *mf, uint32_t block, MSGFILE *sub);
+
+// Open the first language of mf, its own country info first and then
+// the variant blocks, with langfamily and langversion (0 = any) that
+// lists codepage (0 = any, a block without codepages takes any) as sub,
+// same rules as MsgFileBlock. Returns MKMSG_MSG_NOT_FOUND if no
+// language matches, else MKMSG error code or 0.
+int MsgFileSelect(MSGFILE *mf, uint16_t langfamily, uint16_t langversion,
+                  uint16_t codepage, MSGFILE *sub);
+
+// Find message number. Returns MKMSG_MSG_NOT_FOUND if the file does not
+// have it, MKMSG_INDEX_ERROR if its index entry is bad, else 0.
+int MsgFileGet(MSGFILE *mf, uint32_t number, MSGTEXT *msg);
+
+// 32 bit FNV-1a hash of msg, type byte and text, to compare messages.
+uint32_t MsgTextHash(MSGTEXT *msg);
+
+// Prepare msg for its source form, the way mkmsgd writes it: the text
+// is cut at a 0x00 and the returned string goes after it, "%0\r\n" if
+// the text does not end with 0x0D 0x0A (compiled from a %0 line), else
+// "".
+const char *MsgFileSourceEnd(MSGTEXT *msg);
+
+// Format msg the way DosGetMessage does: E and W messages get the
+// "IDnnnn: " prefix, %1 - %9 are replaced by table[0] - table[8] (left
+// as is past count). At most size - 1 bytes go to buf, always 0x00
+// terminated if size > 0. Returns the length of the complete message,
+// so a return >= size means buf was too small.
+uint32_t MsgFileFormat(MSGFILE *mf, MSGTEXT *msg, char **table,
+                       uint32_t count, char *buf, uint32_t size);
+
+#endif
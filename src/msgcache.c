@@ -0,0 +1,149 @@
+/****************************************************************************
+ *
+ *  msgcache.c -- Make Message File Utilities
+ *
+ *  ========================================================================
+ *
+ *  Description: Content addressed compile cache. Cache entries are
+ *               <cachedir>/<16 hex digit key>.<ext>. Entries are copied
+ *               into and out of the cache, never linked, so a later
+ *               write to an output file cannot change the entry.
+ *               Every file goes in with a temp file + rename (outbuf),
+ *               so readers never see a half written entry.
+ *
+ *  ========================================================================
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "msgcache.h"
+#include "linebuf.h"
+#include "outbuf.h"
+#include "mkmsgerr.h"
+
+#define FNV_OFFSET 0xCBF29CE484222325ULL
+#define FNV_PRIME  0x00000100000001B3ULL
+
+#define CACHE_NAMELEN 16
+
+void CacheKeyInit(CACHEKEY *key)
+{
+    *key = FNV_OFFSET;
+}
+
+void CacheKeyAdd(CACHEKEY *key, const void *data, uint32_t len)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    CACHEKEY h = *key;
+
+    while (len--)
+    {
+        h ^= *p++;
+        h *= FNV_PRIME;
+    }
+
+    *key = h;
+}
+
+/*
+ * CacheName( )
+ *
+ * build the cache entry file name, caller frees
+ */
+static char *CacheName(const char *cachedir, CACHEKEY key, const char *ext)
+{
+    size_t dirlen = strlen(cachedir);
+    char *name = (char *)malloc(dirlen + 1 + CACHE_NAMELEN + 1 + strlen(ext) + 1);
+
+    if (name == NULL)
+        return (NULL);
+
+    strcpy(name, cachedir);
+    if (dirlen && cachedir[dirlen - 1] != '\\' && cachedir[dirlen - 1] != '/')
+#if defined(__unix__) || defined(__APPLE__)
+        strcat(name, "/");
+#else
+        strcat(name, "\\");
+#endif
+
+    // two halves so it does not depend on printf long long support
+    sprintf(name + strlen(name), "%08lX%08lX.%s",
+            (unsigned long)(key >> 32), (unsigned long)(key & 0xFFFFFFFFUL), ext);
+
+    return (name);
+}
+
+/*
+ * CacheCopy( )
+ *
+ * copy from to to, to is replaced in one go
+ */
+static int CacheCopy(const char *from, const char *to)
+{
+    LINEBUF src;
+    OUTBUF image;
+    int rc = 0;
+
+    rc = LineBufOpen(&src, from);
+    if (rc != MKMSG_NOERROR)
+        return (rc);
+
+    // the mapped file is the image, OutBufCommit only reads it
+    image.data = src.data;
+    image.size = src.size;
+    image.alloc = src.size;
+
+    rc = OutBufCommit(&image, to);
+
+    LineBufClose(&src);
+
+    return (rc);
+}
+
+int CacheFetch(const char *cachedir, CACHEKEY key, const char *ext,
+               const char *outfile)
+{
+    char *name = CacheName(cachedir, key, ext);
+    int rc = 0;
+
+    if (name == NULL)
+        return (MKMSG_MEM_ERROR1);
+
+    rc = CacheCopy(name, outfile);
+
+    free(name);
+
+    return (rc);
+}
+
+int CacheStore(const char *cachedir, CACHEKEY key, const char *ext,
+               const char *outfile)
+{
+    char *name = CacheName(cachedir, key, ext);
+    int rc = 0;
+
+    if (name == NULL)
+        return (MKMSG_MEM_ERROR1);
+
+    rc = CacheCopy(outfile, name);
+
+    free(name);
+
+    return (rc);
+}
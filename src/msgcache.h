@@ -0,0 +1,52 @@
+/****************************************************************************
+ *
+ *  msgcache.h -- Make Message File Utilities
+ *
+ *  ========================================================================
+ *
+ *  Description: Content addressed compile cache. A compile is keyed by
+ *               a hash of everything that goes into its output, the
+ *               output is kept in the cache directory under that key.
+ *
+ *  ========================================================================
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ ***************************************************************************/
+
+#ifndef MSGCACHE_H
+#define MSGCACHE_H
+
+#include <stdint.h>
+
+// 64 bit FNV-1a hash
+typedef uint64_t CACHEKEY;
+
+// Start a key
+void CacheKeyInit(CACHEKEY *key);
+
+// Add len bytes of data to key
+void CacheKeyAdd(CACHEKEY *key, const void *data, uint32_t len);
+
+// Cache hit: copy the cached output for key to outfile.
+// Returns 0 on a hit, MKMSG error code on a miss.
+int CacheFetch(const char *cachedir, CACHEKEY key, const char *ext,
+               const char *outfile);
+
+// Save outfile in the cache under key. Returns MKMSG error code or 0.
+int CacheStore(const char *cachedir, CACHEKEY key, const char *ext,
+               const char *outfile);
+
+#endif
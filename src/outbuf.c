@@ -0,0 +1,374 @@
+/****************************************************************************
+ *
+ *  outbuf.c -- Make Message File Utilities
+ *
+ *  ========================================================================
+ *
+ *  Description: Growable output buffer, used to build a whole output
+ *               file image before anything goes to disk. A reader of
+ *               the target file never sees a partly written file: the
+ *               image goes to a unique MKxxxxxx.$$$ in the same
+ *               directory and is renamed when complete.
+ *
+ *  ========================================================================
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#else
+#include <io.h>
+#include <process.h>
+#endif
+#include "outbuf.h"
+#include "mkmsgerr.h"
+
+#ifndef O_BINARY
+#define O_BINARY 0
+#endif
+
+#define OUTBUF_MIN 4096
+#define OUTBUF_TMPNAME "MK%06X.$$$"
+#define OUTBUF_TMPLEN 12
+#define OUTBUF_TMPTRY 1000
+
+// bumped for every temp name, threads racing on it only cost a retry
+static unsigned int tmpcount = 0;
+
+/*
+ * OutBufGrow( )
+ *
+ * make sure there is room for len more bytes, the buffer doubles so
+ * appending stays linear
+ */
+static int OutBufGrow(OUTBUF *ob, uint32_t len)
+{
+    uint32_t need = ob->size + len;
+    uint32_t newalloc = ob->alloc ? ob->alloc : OUTBUF_MIN;
+    char *newdata = NULL;
+
+    if (need < ob->size)
+        return (MKMSG_MEM_ERROR1);
+
+    if (need <= ob->alloc)
+        return (MKMSG_NOERROR);
+
+    while (newalloc < need)
+    {
+        if (newalloc > 0x7FFFFFFFUL)
+        {
+            newalloc = need;
+            break;
+        }
+        newalloc *= 2;
+    }
+
+    newdata = (char *)realloc(ob->data, newalloc);
+    if (newdata == NULL)
+        return (MKMSG_MEM_ERROR1);
+
+    ob->data = newdata;
+    ob->alloc = newalloc;
+
+    return (MKMSG_NOERROR);
+}
+
+/*
+ * OutBufWrite( ) - write len bytes to fd, retrying short writes
+ */
+static int OutBufWrite(int fd, const char *data, uint32_t len)
+{
+    uint32_t done = 0;
+
+    while (done < len)
+    {
+        long wr = write(fd, data + done, len - done);
+        if (wr <= 0)
+            return (MKMSG_ERRFILEWRITE);
+        done += wr;
+    }
+
+    return (MKMSG_NOERROR);
+}
+
+/*
+ * OutBufReserve( )
+ *
+ * make room for len more bytes, a stream buffer that would pass its
+ * flush size is written out first
+ */
+static int OutBufReserve(OUTBUF *ob, uint32_t len)
+{
+    if (ob->flushat && ob->size && ob->size + len > ob->flushat)
+    {
+        int rc = OutBufFlush(ob);
+        if (rc != MKMSG_NOERROR)
+            return (rc);
+    }
+
+    return (OutBufGrow(ob, len));
+}
+
+int OutBufInit(OUTBUF *ob, uint32_t hint)
+{
+    memset(ob, 0, sizeof(OUTBUF));
+
+    if (hint)
+        return (OutBufGrow(ob, hint));
+
+    return (MKMSG_NOERROR);
+}
+
+void OutBufFree(OUTBUF *ob)
+{
+    free(ob->data);
+    memset(ob, 0, sizeof(OUTBUF));
+}
+
+char *OutBufAlloc(OUTBUF *ob, uint32_t len)
+{
+    char *dest = NULL;
+
+    if (OutBufReserve(ob, len) != MKMSG_NOERROR)
+        return (NULL);
+
+    dest = ob->data + ob->size;
+    memset(dest, 0x00, len);
+    ob->size += len;
+
+    return (dest);
+}
+
+int OutBufAppend(OUTBUF *ob, const void *data, uint32_t len)
+{
+    int rc = OutBufReserve(ob, len);
+
+    if (rc != MKMSG_NOERROR)
+        return (rc);
+
+    memcpy(ob->data + ob->size, data, len);
+    ob->size += len;
+
+    return (MKMSG_NOERROR);
+}
+
+/*
+ * OutBufVPrintf( )
+ *
+ * format once to get the length, then straight into the buffer
+ */
+int OutBufVPrintf(OUTBUF *ob, const char *format, va_list args)
+{
+    va_list again;
+    int len = 0;
+    int rc = 0;
+
+    va_copy(again, args);
+    len = vsnprintf(NULL, 0, format, again);
+    va_end(again);
+
+    if (len < 0)
+        return (MKMSG_ERRFILEWRITE);
+
+    // +1 for the 0x00 vsnprintf adds, not counted as used
+    rc = OutBufReserve(ob, len + 1);
+    if (rc != MKMSG_NOERROR)
+        return (rc);
+
+    vsnprintf(ob->data + ob->size, len + 1, format, args);
+    ob->size += len;
+
+    return (MKMSG_NOERROR);
+}
+
+int OutBufPrintf(OUTBUF *ob, const char *format, ...)
+{
+    va_list args;
+    int rc = 0;
+
+    va_start(args, format);
+    rc = OutBufVPrintf(ob, format, args);
+    va_end(args);
+
+    return (rc);
+}
+
+/*************************************************************************
+ * Function:  OutBufCommit( )
+ *
+ * Writes the buffer to filename
+ *
+ * 0 "-" is stdout, the buffer is written as is
+ * 1 Temp name is MKxxxxxx.$$$ in the directory of filename (rename
+ *   stays on one drive), xxxxxx is made from the pid and a counter
+ *   and the file is created exclusively, so compiles running at the
+ *   same time never share a temp file. It is still a valid 8.3 name
+ * 2 Write the whole buffer to the temp file
+ * 3 Rename temp file to filename, rename will not replace an
+ *   existing file on OS/2 so the old one is removed first
+ *
+ * Return:    returns error code or 0 for all good
+ *************************************************************************/
+
+int OutBufCommit(OUTBUF *ob, const char *filename)
+{
+    size_t namelen = strlen(filename);
+    char *tmpname = NULL;
+    char *base = NULL;
+    int fd = -1;
+
+    if (strcmp(filename, "-") == 0)
+    {
+#if !defined(__unix__) && !defined(__APPLE__)
+        setmode(1, O_BINARY);
+#endif
+        return (OutBufWrite(1, ob->data, ob->size));
+    }
+
+    tmpname = (char *)malloc(namelen + OUTBUF_TMPLEN + 1);
+    if (tmpname == NULL)
+        return (MKMSG_MEM_ERROR1);
+
+    strcpy(tmpname, filename);
+
+    // keep the directory part only
+    base = tmpname;
+    for (char *p = tmpname; *p; p++)
+        if (*p == '\\' || *p == '/' || *p == ':')
+            base = p + 1;
+
+    for (int i = 0; i < OUTBUF_TMPTRY; i++)
+    {
+        unsigned int id = ((unsigned int)getpid() << 8) + tmpcount++;
+
+        sprintf(base, OUTBUF_TMPNAME, id & 0xFFFFFF);
+        fd = open(tmpname, O_WRONLY | O_CREAT | O_EXCL | O_BINARY,
+                  S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH);
+        if (fd != -1 || errno != EEXIST)
+            break;
+    }
+    if (fd == -1)
+    {
+        free(tmpname);
+        return (MKMSG_OPEN_ERROR);
+    }
+
+    if (OutBufWrite(fd, ob->data, ob->size) != MKMSG_NOERROR)
+    {
+        close(fd);
+        remove(tmpname);
+        free(tmpname);
+        return (MKMSG_ERRFILEWRITE);
+    }
+
+    if (close(fd) != 0)
+    {
+        remove(tmpname);
+        free(tmpname);
+        return (MKMSG_ERRFILEWRITE);
+    }
+
+#if !defined(__unix__) && !defined(__APPLE__)
+    remove(filename);
+#endif
+
+    if (rename(tmpname, filename) != 0)
+    {
+        remove(tmpname);
+        free(tmpname);
+        return (MKMSG_ERRFILEWRITE);
+    }
+
+    free(tmpname);
+
+    return (MKMSG_NOERROR);
+}
+
+/*************************************************************************
+ * Function:  OutBufOpen( )
+ *
+ * Set up ob as a stream to filename: output collects in a buffer of
+ * about bufsize bytes that is written out whenever it is full
+ *
+ * 1 "-" is stdout, switched to binary so 0x0D 0x0A stays as is
+ * 2 Anything else is created / truncated
+ *
+ * Return:    returns error code or 0 for all good
+ *************************************************************************/
+
+int OutBufOpen(OUTBUF *ob, const char *filename, uint32_t bufsize)
+{
+    int rc = OutBufInit(ob, bufsize);
+
+    if (rc != MKMSG_NOERROR)
+        return (rc);
+
+    if (strcmp(filename, "-") == 0)
+    {
+        ob->fd = 1;
+#if !defined(__unix__) && !defined(__APPLE__)
+        setmode(ob->fd, O_BINARY);
+#endif
+    }
+    else
+    {
+        ob->fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC | O_BINARY,
+                      S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH);
+        if (ob->fd == -1)
+        {
+            OutBufFree(ob);
+            return (MKMSG_OPEN_ERROR);
+        }
+    }
+
+    ob->flushat = bufsize ? bufsize : OUTBUF_MIN;
+
+    return (MKMSG_NOERROR);
+}
+
+int OutBufFlush(OUTBUF *ob)
+{
+    int rc = OutBufWrite(ob->fd, ob->data, ob->size);
+
+    ob->size = 0;
+
+    return (rc);
+}
+
+/*
+ * OutBufClose( )
+ *
+ * write out what is left, close the file (never stdout) and free the
+ * buffer
+ */
+int OutBufClose(OUTBUF *ob)
+{
+    int rc = OutBufFlush(ob);
+
+    if (ob->fd != 1 && close(ob->fd) != 0 && rc == MKMSG_NOERROR)
+        rc = MKMSG_ERRFILEWRITE;
+
+    OutBufFree(ob);
+
+    return (rc);
+}
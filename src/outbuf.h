@@ -0,0 +1,78 @@
+/****************************************************************************
+ *
+ *  outbuf.h -- Make Message File Utilities
+ *
+ *  ========================================================================
+ *
+ *  Description: Growable output buffer. An output file is assembled
+ *               in memory and written with one write to a temporary
+ *               file which is then renamed over the target.
+ *
+ *  ========================================================================
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ ***************************************************************************/
+
+#ifndef OUTBUF_H
+#define OUTBUF_H
+
+#include <stdint.h>
+#include <stdarg.h>
+
+typedef struct _OUTBUF
+{
+    char *data;        // buffer
+    uint32_t size;     // bytes used
+    uint32_t alloc;    // bytes allocated
+    uint32_t flushat;  // stream: write out past this size, 0 = memory only
+    int fd;            // stream: output file
+} OUTBUF;
+
+// Set up an empty buffer, reserving hint bytes (0 is fine).
+// Returns MKMSG error code or 0.
+int OutBufInit(OUTBUF *ob, uint32_t hint);
+
+// Release the buffer memory.
+void OutBufFree(OUTBUF *ob);
+
+// Make room for len more bytes and return a pointer to them, the bytes
+// count as used (and are zeroed). NULL if out of memory. For a stream
+// the pointer is good until the next call on ob.
+char *OutBufAlloc(OUTBUF *ob, uint32_t len);
+
+// Append len bytes from data. Returns MKMSG error code or 0.
+int OutBufAppend(OUTBUF *ob, const void *data, uint32_t len);
+
+// printf into the buffer. Returns MKMSG error code or 0.
+int OutBufPrintf(OUTBUF *ob, const char *format, ...);
+int OutBufVPrintf(OUTBUF *ob, const char *format, va_list args);
+
+// Write the buffer to filename: one write to a unique temporary file in
+// the same directory, then rename over filename. "-" writes to stdout.
+// Returns MKMSG error or 0.
+int OutBufCommit(OUTBUF *ob, const char *filename);
+
+// Set up ob as a stream to filename ("-" = stdout) with a bufsize
+// buffer, written out whenever it fills. Returns MKMSG error code or 0.
+int OutBufOpen(OUTBUF *ob, const char *filename, uint32_t bufsize);
+
+// Write out the buffered bytes of a stream. Returns MKMSG error or 0.
+int OutBufFlush(OUTBUF *ob);
+
+// Flush and close a stream, stdout stays open. Returns MKMSG error or 0.
+int OutBufClose(OUTBUF *ob);
+
+#endif
@@ -0,0 +1,484 @@
+/*
+*
+*   This program is free software;  you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 2 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY;  without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+*   the GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program;  if not, write to the Free Software
+*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+*/
+
+/*
+* Functions: POOL        CreatePool
+*            ADDRESS     AllocateFromPool
+*            void        DeallocateToPool
+*            void        DestroyPool
+*            CARDINAL32  PoolObjectsInUse
+*            void        ReleasePool
+*            ARENA       CreateArena
+*            ADDRESS     AllocateFromArena
+*            void        DestroyArena
+*
+* Description:  Slab pool manager for the USE_POOLMAN build of dlist and
+*               the chunk arena of arena lists.
+*
+* Notes:  SEE THE INITIAL COMMENT IN POOLMAN.H!
+*
+*/
+
+#include <stdlib.h>   /* malloc, free */
+#include "poolman.h"  /* Import poolman.h so that the compiler can check the
+                         consistency of the declarations in poolman.h against
+                         those in this module.                              */
+
+
+/*--------------------------------------------------
+ * Private Type definitions
+ --------------------------------------------------*/
+
+
+/* A pool has the following structure:
+
+     PoolControl --> Slabs --> SlabHeader --> SlabHeader --> NULL
+          |                    object 1       object 1
+          |                    object 2       ...
+          |                    ...
+          |
+          +--> FreeList --> returned object --> returned object --> NULL
+
+   Slabs are kept newest first.  Objects of the newest slab that were never
+   handed out are not on the free list, NextUnused/UnusedCount track them,
+   so a new slab costs one malloc and nothing else.  A returned object
+   holds the free list link in its first bytes.                            */
+
+typedef union SlabHeaderRecord
+{
+  union SlabHeaderRecord * NextSlab;   /* The slab allocated before this one. */
+  double                   Alignment;  /* Objects after the header are aligned for any type. */
+} SlabHeader;
+
+typedef struct FreeObjectRecord
+{
+  struct FreeObjectRecord * NextFree;  /* The object returned before this one. */
+} FreeObject;
+
+typedef struct PoolRecord
+{
+  CARDINAL32   ObjectSize;        /* Object size, rounded up so objects stay aligned. */
+  CARDINAL32   InitialPoolSize;   /* Objects in the first slab. */
+  CARDINAL32   MaximumPoolSize;   /* Objects the pool keeps once nothing is in use, 0 = any. */
+  CARDINAL32   PoolIncrement;     /* Objects in each further slab. */
+  CARDINAL32   SlabObjects;       /* Objects in all slabs. */
+  CARDINAL32   InUse;             /* Objects handed out and not returned. */
+  FreeObject * FreeList;          /* Returned objects, most recent first. */
+  SlabHeader * Slabs;             /* All slabs, newest first. */
+  char *       NextUnused;        /* Next never used object of the newest slab. */
+  CARDINAL32   UnusedCount;       /* Never used objects left in the newest slab. */
+  BOOLEAN      Destroyed;         /* DestroyPool was called, free on last return. */
+} PoolControl;
+
+/* An arena has the following structure:
+
+     ArenaControl --> Chunks --> SlabHeader --> SlabHeader --> NULL
+                                 used bytes     used bytes
+                                 Next -->       ...
+                                 free bytes
+
+   Memory is taken from the front chunk by moving Next, a chunk that is
+   too small for a request is left as it is and a new one goes in front.
+   A large request gets a chunk of its own behind the front chunk.         */
+
+typedef struct ArenaRecord
+{
+  CARDINAL32   ChunkSize;         /* Bytes per chunk, without the header. */
+  SlabHeader * Chunks;            /* All chunks, the one allocated from first. */
+  char *       Next;              /* Next free byte of the front chunk. */
+  CARDINAL32   Left;              /* Free bytes left in the front chunk. */
+} ArenaControl;
+
+
+/*--------------------------------------------------
+ * Private Functions
+ --------------------------------------------------*/
+
+/*
+ * ReleaseSlabs( ) - free all slabs, the pool is empty afterwards
+ */
+static void ReleaseSlabs(PoolControl * PoolData)
+{
+  SlabHeader * Slab;
+
+  while (PoolData->Slabs != NULL)
+  {
+    Slab = PoolData->Slabs;
+    PoolData->Slabs = Slab->NextSlab;
+    free(Slab);
+  }
+
+  PoolData->FreeList = NULL;
+  PoolData->NextUnused = NULL;
+  PoolData->UnusedCount = 0;
+  PoolData->SlabObjects = 0;
+}
+
+/*
+ * AddSlab( ) - allocate a slab of Count objects, they become the unused
+ * objects of the pool. Returns FALSE if out of memory.
+ */
+static BOOLEAN AddSlab(PoolControl * PoolData, CARDINAL32 Count)
+{
+  SlabHeader * Slab;
+
+  if (Count > (0xFFFFFFFFUL - sizeof(SlabHeader)) / PoolData->ObjectSize)
+    return FALSE;
+
+  Slab = (SlabHeader *) malloc(sizeof(SlabHeader) + Count * PoolData->ObjectSize);
+  if (Slab == NULL)
+    return FALSE;
+
+  Slab->NextSlab = PoolData->Slabs;
+  PoolData->Slabs = Slab;
+
+  PoolData->NextUnused = (char *) (Slab + 1);
+  PoolData->UnusedCount = Count;
+  PoolData->SlabObjects += Count;
+
+  return TRUE;
+}
+
+
+/*--------------------------------------------------
+ * Public Functions Available
+ --------------------------------------------------*/
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  CreatePool                                      */
+/*                                                                   */
+/*   Descriptive Name: Creates a pool of objects of ObjectSize bytes.*/
+/*                                                                   */
+/*   Notes:  See poolman.h for the parameters.                       */
+/*                                                                   */
+/*********************************************************************/
+POOL _System CreatePool(CARDINAL32 ObjectSize,
+                        CARDINAL32 InitialPoolSize,
+                        CARDINAL32 MaximumPoolSize,
+                        CARDINAL32 PoolIncrement,
+                        BOOLEAN    Threaded)
+{
+  PoolControl * PoolData;
+
+  (void) Threaded;
+
+  if (ObjectSize == 0)
+    return NULL;
+
+  PoolData = (PoolControl *) malloc(sizeof(PoolControl));
+  if (PoolData == NULL)
+    return NULL;
+
+  /* Every object must be able to hold the free list link and the next
+     object in the slab must be aligned as well as the first one.       */
+  if (ObjectSize < sizeof(FreeObject))
+    ObjectSize = sizeof(FreeObject);
+  ObjectSize = (ObjectSize + sizeof(SlabHeader) - 1) / sizeof(SlabHeader) * sizeof(SlabHeader);
+
+  PoolData->ObjectSize = ObjectSize;
+  PoolData->InitialPoolSize = InitialPoolSize;
+  PoolData->MaximumPoolSize = MaximumPoolSize;
+  PoolData->PoolIncrement = PoolIncrement ? PoolIncrement : 1;
+  PoolData->SlabObjects = 0;
+  PoolData->InUse = 0;
+  PoolData->FreeList = NULL;
+  PoolData->Slabs = NULL;
+  PoolData->NextUnused = NULL;
+  PoolData->UnusedCount = 0;
+  PoolData->Destroyed = FALSE;
+
+  if ( InitialPoolSize && !AddSlab(PoolData, InitialPoolSize) )
+  {
+    free(PoolData);
+    return NULL;
+  }
+
+  return (POOL) PoolData;
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  AllocateFromPool                                */
+/*                                                                   */
+/*   Descriptive Name: Gets an object from the pool.                 */
+/*                                                                   */
+/*   Notes:  The free list first, so recently used memory is reused */
+/*           while it is still in the cache, then the unused objects */
+/*           of the newest slab, then a new slab.  The first slab    */
+/*           after an empty pool has InitialPoolSize objects.        */
+/*                                                                   */
+/*********************************************************************/
+ADDRESS _System AllocateFromPool(POOL Pool)
+{
+  PoolControl * PoolData = (PoolControl *) Pool;
+  ADDRESS       Object;
+
+  if (PoolData->FreeList != NULL)
+  {
+    Object = (ADDRESS) PoolData->FreeList;
+    PoolData->FreeList = PoolData->FreeList->NextFree;
+  }
+  else
+  {
+    if (PoolData->UnusedCount == 0)
+    {
+      CARDINAL32 Count = PoolData->PoolIncrement;
+
+      if ( (PoolData->SlabObjects == 0) && (PoolData->InitialPoolSize != 0) )
+        Count = PoolData->InitialPoolSize;
+
+      if ( !AddSlab(PoolData, Count) )
+        return NULL;
+    }
+
+    Object = (ADDRESS) PoolData->NextUnused;
+    PoolData->NextUnused += PoolData->ObjectSize;
+    PoolData->UnusedCount--;
+  }
+
+  PoolData->InUse++;
+
+  return Object;
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  DeallocateToPool                                */
+/*                                                                   */
+/*   Descriptive Name: Returns an object to the pool it came from.   */
+/*                                                                   */
+/*   Notes:  The last object returned to a destroyed pool frees the */
+/*           pool, see DestroyPool.                                  */
+/*                                                                   */
+/*********************************************************************/
+void _System DeallocateToPool(POOL Pool, ADDRESS Object)
+{
+  PoolControl * PoolData = (PoolControl *) Pool;
+  FreeObject *  Returned = (FreeObject *) Object;
+
+  Returned->NextFree = PoolData->FreeList;
+  PoolData->FreeList = Returned;
+  PoolData->InUse--;
+
+  if (PoolData->InUse != 0)
+    return;
+
+  if (PoolData->Destroyed)
+  {
+    ReleaseSlabs(PoolData);
+    free(PoolData);
+  }
+  else if ( PoolData->MaximumPoolSize && (PoolData->SlabObjects > PoolData->MaximumPoolSize) )
+    ReleaseSlabs(PoolData);
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  DestroyPool                                     */
+/*                                                                   */
+/*   Descriptive Name: Releases the pool and all of its slabs.       */
+/*                                                                   */
+/*   Notes:  Objects moved to another list by AppendList or          */
+/*           TransferItem are still in use, the pool stays until     */
+/*           they are returned.                                      */
+/*                                                                   */
+/*********************************************************************/
+void _System DestroyPool(POOL Pool)
+{
+  PoolControl * PoolData = (PoolControl *) Pool;
+
+  if (PoolData == NULL)
+    return;
+
+  if (PoolData->InUse != 0)
+  {
+    PoolData->Destroyed = TRUE;
+    return;
+  }
+
+  ReleaseSlabs(PoolData);
+  free(PoolData);
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  PoolObjectsInUse                                */
+/*                                                                   */
+/*   Descriptive Name: Returns the number of objects handed out and  */
+/*                     not returned yet.                             */
+/*                                                                   */
+/*   Notes:  See poolman.h for the parameters.                       */
+/*                                                                   */
+/*********************************************************************/
+CARDINAL32 _System PoolObjectsInUse(POOL Pool)
+{
+  return ((PoolControl *) Pool)->InUse;
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  ReleasePool                                     */
+/*                                                                   */
+/*   Descriptive Name: Releases the pool and all of its slabs now.   */
+/*                                                                   */
+/*   Notes:  One free per slab, the objects in use are not returned  */
+/*           one by one.                                             */
+/*                                                                   */
+/*********************************************************************/
+void _System ReleasePool(POOL Pool)
+{
+  PoolControl * PoolData = (PoolControl *) Pool;
+
+  if (PoolData == NULL)
+    return;
+
+  ReleaseSlabs(PoolData);
+  free(PoolData);
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  CreateArena                                     */
+/*                                                                   */
+/*   Descriptive Name: Creates an arena that allocates from chunks   */
+/*                     of ChunkSize bytes.                           */
+/*                                                                   */
+/*   Notes:  See poolman.h for the parameters.                       */
+/*                                                                   */
+/*********************************************************************/
+ARENA _System CreateArena(CARDINAL32 ChunkSize)
+{
+  ArenaControl * ArenaData;
+
+  ArenaData = (ArenaControl *) malloc(sizeof(ArenaControl));
+  if (ArenaData == NULL)
+    return NULL;
+
+  if (ChunkSize == 0)
+    ChunkSize = ARENA_CHUNK_SIZE;
+
+  ArenaData->ChunkSize = (ChunkSize + sizeof(SlabHeader) - 1) / sizeof(SlabHeader) * sizeof(SlabHeader);
+  ArenaData->Chunks = NULL;
+  ArenaData->Next = NULL;
+  ArenaData->Left = 0;
+
+  return (ARENA) ArenaData;
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  AllocateFromArena                               */
+/*                                                                   */
+/*   Descriptive Name: Gets Size bytes from the arena.               */
+/*                                                                   */
+/*   Notes:  Sizes are rounded up to keep the next allocation        */
+/*           aligned.  Up to a quarter chunk may be left unused at   */
+/*           the end of a chunk.                                     */
+/*                                                                   */
+/*********************************************************************/
+ADDRESS _System AllocateFromArena(ARENA Arena, CARDINAL32 Size)
+{
+  ArenaControl * ArenaData = (ArenaControl *) Arena;
+  SlabHeader *   Chunk;
+  ADDRESS        Memory;
+
+  if ( (Size == 0) || (Size > 0xFFFFFFFFUL - 2 * sizeof(SlabHeader)) )
+    return NULL;
+
+  Size = (Size + sizeof(SlabHeader) - 1) / sizeof(SlabHeader) * sizeof(SlabHeader);
+
+  if (Size <= ArenaData->Left)
+  {
+    Memory = (ADDRESS) ArenaData->Next;
+    ArenaData->Next += Size;
+    ArenaData->Left -= Size;
+    return Memory;
+  }
+
+  if (Size > ArenaData->ChunkSize / 4)
+  {
+    /* A chunk of its own, behind the front chunk so what is left there
+       is still used.                                                    */
+    Chunk = (SlabHeader *) malloc(sizeof(SlabHeader) + Size);
+    if (Chunk == NULL)
+      return NULL;
+
+    if (ArenaData->Chunks != NULL)
+    {
+      Chunk->NextSlab = ArenaData->Chunks->NextSlab;
+      ArenaData->Chunks->NextSlab = Chunk;
+    }
+    else
+    {
+      Chunk->NextSlab = NULL;
+      ArenaData->Chunks = Chunk;
+    }
+
+    return (ADDRESS) (Chunk + 1);
+  }
+
+  Chunk = (SlabHeader *) malloc(sizeof(SlabHeader) + ArenaData->ChunkSize);
+  if (Chunk == NULL)
+    return NULL;
+
+  Chunk->NextSlab = ArenaData->Chunks;
+  ArenaData->Chunks = Chunk;
+
+  Memory = (ADDRESS) (Chunk + 1);
+  ArenaData->Next = (char *) (Chunk + 1) + Size;
+  ArenaData->Left = ArenaData->ChunkSize - Size;
+
+  return Memory;
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  DestroyArena                                    */
+/*                                                                   */
+/*   Descriptive Name: Releases the arena and all memory allocated   */
+/*                     from it.                                      */
+/*                                                                   */
+/*   Notes:  None.                                                   */
+/*                                                                   */
+/*********************************************************************/
+void _System DestroyArena(ARENA Arena)
+{
+  ArenaControl * ArenaData = (ArenaControl *) Arena;
+  SlabHeader *   Chunk;
+
+  if (ArenaData == NULL)
+    return;
+
+  while (ArenaData->Chunks != NULL)
+  {
+    Chunk = ArenaData->Chunks;
+    ArenaData->Chunks = Chunk->NextSlab;
+    free(Chunk);
+  }
+
+  free(ArenaData);
+}
@@ -0,0 +1,292 @@
+/*
+*
+*   This program is free software;  you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 2 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY;  without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+*   the GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program;  if not, write to the Free Software
+*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+*/
+
+/*
+* Functions: POOL        CreatePool
+*            ADDRESS     AllocateFromPool
+*            void        DeallocateToPool
+*            void        DestroyPool
+*            CARDINAL32  PoolObjectsInUse
+*            void        ReleasePool
+*            ARENA       CreateArena
+*            ADDRESS     AllocateFromArena
+*            void        DestroyArena
+*            ADDRESS     SmartMalloc
+*            void        SmartFree
+*
+* Description:  Pool manager for the USE_POOLMAN build of dlist.  A pool
+*               hands out objects of one size, the LinkNodes of a DLIST.
+*               Objects are carved out of slabs of PoolIncrement objects,
+*               a returned object goes on the free list of the pool and is
+*               handed out again before the slab is touched.  DestroyPool
+*               releases all slabs of the pool at once, so a list with N
+*               items costs N / PoolIncrement calls to malloc and free
+*               instead of N each.
+*
+* Notes:  A pool is single threaded like the DLIST that owns it.
+*
+*         An object may outlive the list that allocated it: AppendList and
+*         TransferItem move LinkNodes from one list to another.  An object
+*         is therefore always returned to the pool it came from (dlist
+*         keeps the pool in the LinkNode), and DestroyPool keeps the slabs
+*         until the last object still in use is returned.
+*
+*         An arena hands out memory of any size from chunks and takes
+*         nothing back, DestroyArena frees all chunks at once.  It holds
+*         the LinkNodes and item copies of a list made by CreateArenaList,
+*         in every build of dlist, not just USE_POOLMAN.
+*
+*         SmartMalloc and SmartFree are the plain heap.  Item memory is
+*         handed to and taken from the user (InsertObject, ExtractObject),
+*         who uses malloc and free on it.
+*
+*/
+
+#ifndef POOLMAN_H_INCLUDED
+
+#define POOLMAN_H_INCLUDED  1
+
+#include <stdlib.h>
+#include "globals.h"
+
+typedef ADDRESS POOL;
+
+typedef ADDRESS ARENA;
+
+#define ARENA_CHUNK_SIZE      16384  /* Default bytes per arena chunk. */
+
+#define SmartMalloc(Size)     malloc(Size)
+#define SmartFree(Memory)     free(Memory)
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  CreatePool                                      */
+/*                                                                   */
+/*   Descriptive Name: Creates a pool of objects of ObjectSize bytes.*/
+/*                                                                   */
+/*   Input: CARDINAL32 ObjectSize - The size of each object.         */
+/*          CARDINAL32 InitialPoolSize - Objects in the first slab,  */
+/*                                     allocated right away.  0 means*/
+/*                                     the first allocation gets a   */
+/*                                     slab of PoolIncrement objects.*/
+/*          CARDINAL32 MaximumPoolSize - When the last object in use */
+/*                                     is returned and the slabs hold*/
+/*                                     more objects than this, all   */
+/*                                     slabs are released.  0 means  */
+/*                                     no limit, the memory is kept  */
+/*                                     until DestroyPool.            */
+/*          CARDINAL32 PoolIncrement - Objects per slab after the    */
+/*                                   first one, at least 1.          */
+/*          BOOLEAN Threaded - Accepted for compatibility, pools are */
+/*                             not locked.                           */
+/*                                                                   */
+/*   Output: If Success : The function return value will be non-NULL */
+/*                                                                   */
+/*           If Failure : The function return value will be NULL.    */
+/*                                                                   */
+/*   Error Handling:  Fails only if memory can not be allocated.     */
+/*                                                                   */
+/*   Side Effects:  None.                                            */
+/*                                                                   */
+/*   Notes:  None.                                                   */
+/*                                                                   */
+/*********************************************************************/
+POOL _System CreatePool(CARDINAL32 ObjectSize,
+                        CARDINAL32 InitialPoolSize,
+                        CARDINAL32 MaximumPoolSize,
+                        CARDINAL32 PoolIncrement,
+                        BOOLEAN    Threaded);
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  AllocateFromPool                                */
+/*                                                                   */
+/*   Descriptive Name: Gets an object from the pool: the last one    */
+/*                     returned, else the next unused one of the     */
+/*                     newest slab, else a new slab is allocated.    */
+/*                                                                   */
+/*   Input: POOL Pool - The pool to allocate from.                   */
+/*                                                                   */
+/*   Output: If Success : The address of the object, its contents    */
+/*                        are undefined.                             */
+/*                                                                   */
+/*           If Failure : NULL.                                      */
+/*                                                                   */
+/*   Error Handling:  Fails only if a new slab can not be allocated. */
+/*                                                                   */
+/*   Side Effects:  None.                                            */
+/*                                                                   */
+/*   Notes:  None.                                                   */
+/*                                                                   */
+/*********************************************************************/
+ADDRESS _System AllocateFromPool(POOL Pool);
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  DeallocateToPool                                */
+/*                                                                   */
+/*   Descriptive Name: Returns an object to the pool it came from.   */
+/*                                                                   */
+/*   Input: POOL Pool - The pool the object was allocated from.      */
+/*          ADDRESS Object - The object being returned.              */
+/*                                                                   */
+/*   Output: None.                                                   */
+/*                                                                   */
+/*   Error Handling:  None.                                          */
+/*                                                                   */
+/*   Side Effects:  Releases the slabs of the pool if this was the   */
+/*                  last object in use and the pool was destroyed or */
+/*                  is over MaximumPoolSize.                         */
+/*                                                                   */
+/*   Notes:  None.                                                   */
+/*                                                                   */
+/*********************************************************************/
+void _System DeallocateToPool(POOL Pool, ADDRESS Object);
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  DestroyPool                                     */
+/*                                                                   */
+/*   Descriptive Name: Releases the pool and all of its slabs.       */
+/*                                                                   */
+/*   Input: POOL Pool - The pool to destroy.                         */
+/*                                                                   */
+/*   Output: None.                                                   */
+/*                                                                   */
+/*   Error Handling:  None.                                          */
+/*                                                                   */
+/*   Side Effects:  If objects of the pool are still in use, the     */
+/*                  release happens when the last one is returned.   */
+/*                                                                   */
+/*   Notes:  None.                                                   */
+/*                                                                   */
+/*********************************************************************/
+void _System DestroyPool(POOL Pool);
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  PoolObjectsInUse                                */
+/*                                                                   */
+/*   Descriptive Name: Returns the number of objects handed out and  */
+/*                     not returned yet.                             */
+/*                                                                   */
+/*   Input: POOL Pool - The pool to check.                           */
+/*                                                                   */
+/*   Output: The number of objects in use.                           */
+/*                                                                   */
+/*   Error Handling:  None.                                          */
+/*                                                                   */
+/*   Side Effects:  None.                                            */
+/*                                                                   */
+/*   Notes:  None.                                                   */
+/*                                                                   */
+/*********************************************************************/
+CARDINAL32 _System PoolObjectsInUse(POOL Pool);
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  ReleasePool                                     */
+/*                                                                   */
+/*   Descriptive Name: Releases the pool and all of its slabs now,   */
+/*                     also the objects still in use.                */
+/*                                                                   */
+/*   Input: POOL Pool - The pool to release, may be NULL.            */
+/*                                                                   */
+/*   Output: None.                                                   */
+/*                                                                   */
+/*   Error Handling:  None.                                          */
+/*                                                                   */
+/*   Side Effects:  Every object of the pool is invalid afterwards.  */
+/*                                                                   */
+/*   Notes:  For the owner of all objects in use, DestroyList of a   */
+/*           list that holds every LinkNode of its pool.  One free   */
+/*           per slab instead of one DeallocateToPool per object.    */
+/*                                                                   */
+/*********************************************************************/
+void _System ReleasePool(POOL Pool);
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  CreateArena                                     */
+/*                                                                   */
+/*   Descriptive Name: Creates an arena that allocates from chunks   */
+/*                     of ChunkSize bytes.                           */
+/*                                                                   */
+/*   Input: CARDINAL32 ChunkSize - Bytes per chunk, 0 for the        */
+/*                               default of ARENA_CHUNK_SIZE.  The   */
+/*                               first chunk is allocated with the   */
+/*                               first request.                      */
+/*                                                                   */
+/*   Output: If Success : The function return value will be non-NULL */
+/*                                                                   */
+/*           If Failure : The function return value will be NULL.    */
+/*                                                                   */
+/*   Error Handling:  Fails only if memory can not be allocated.     */
+/*                                                                   */
+/*   Side Effects:  None.                                            */
+/*                                                                   */
+/*   Notes:  None.                                                   */
+/*                                                                   */
+/*********************************************************************/
+ARENA _System CreateArena(CARDINAL32 ChunkSize);
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  AllocateFromArena                               */
+/*                                                                   */
+/*   Descriptive Name: Gets Size bytes from the arena.               */
+/*                                                                   */
+/*   Input: ARENA Arena - The arena to allocate from.                */
+/*          CARDINAL32 Size - The number of bytes, not 0.            */
+/*                                                                   */
+/*   Output: If Success : The address of the memory, aligned for any */
+/*                        type, its contents are undefined.          */
+/*                                                                   */
+/*           If Failure : NULL.                                      */
+/*                                                                   */
+/*   Error Handling:  Fails only if a new chunk can not be allocated.*/
+/*                                                                   */
+/*   Side Effects:  None.                                            */
+/*                                                                   */
+/*   Notes:  A request larger than a quarter chunk gets a chunk of   */
+/*           its own, so the current chunk is not wasted.            */
+/*                                                                   */
+/*********************************************************************/
+ADDRESS _System AllocateFromArena(ARENA Arena, CARDINAL32 Size);
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  DestroyArena                                    */
+/*                                                                   */
+/*   Descriptive Name: Releases the arena and all memory allocated   */
+/*                     from it.                                      */
+/*                                                                   */
+/*   Input: ARENA Arena - The arena to destroy, may be NULL.         */
+/*                                                                   */
+/*   Output: None.                                                   */
+/*                                                                   */
+/*   Error Handling:  None.                                          */
+/*                                                                   */
+/*   Side Effects:  None.                                            */
+/*                                                                   */
+/*   Notes:  One free per chunk, nothing per allocation.             */
+/*                                                                   */
+/*********************************************************************/
+void _System DestroyArena(ARENA Arena);
+
+#endif
@@ -36,8 +36,24 @@
 
 #define SYSLVERSION     "1.10"
 
-#define OWMAJOR         (__WATCOMC__/100) - 11
-#define OWMINOR         (__WATCOMC__ % 100) / 10
+// compiler shown in the program heading
+#if defined(__WATCOMC__)
+#define CCNAME          "Open Watcom"
+#define CCMAJOR         (__WATCOMC__/100) - 11
+#define CCMINOR         (__WATCOMC__ % 100) / 10
+#elif defined(__clang__)
+#define CCNAME          "Clang"
+#define CCMAJOR         __clang_major__
+#define CCMINOR         __clang_minor__
+#elif defined(__GNUC__)
+#define CCNAME          "GCC"
+#define CCMAJOR         __GNUC__
+#define CCMINOR         __GNUC_MINOR__
+#else
+#define CCNAME          "unknown compiler"
+#define CCMAJOR         0
+#define CCMINOR         0
+#endif
 
 #endif
 
@@ -0,0 +1,195 @@
+/****************************************************************************
+ *
+ *  workpool.c -- Make Message File Utilities
+ *
+ *  ========================================================================
+ *
+ *  Description: Minimal worker thread pool. Every thread takes the
+ *               next job number under a mutex until all jobs are
+ *               taken. OS/2 uses _beginthread and the Dos mutex
+ *               semaphores, unix uses pthreads.
+ *
+ *  ========================================================================
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ ***************************************************************************/
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <pthread.h>
+#define WORKPOOL_PTHREAD
+#else
+#define INCL_DOSSEMAPHORES
+#define INCL_DOSPROCESS
+#include <os2.h>
+#include <process.h>
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include "workpool.h"
+
+typedef struct _WORKPOOL
+{
+    int count;       // number of jobs
+    int next;        // next job to hand out
+    WORKFUNC work;
+    WORKFUNC done;
+    void *context;
+#ifdef WORKPOOL_PTHREAD
+    pthread_mutex_t lock;
+#else
+    HMTX lock;
+#endif
+} WORKPOOL;
+
+static void WorkPoolLock(WORKPOOL *pool)
+{
+#ifdef WORKPOOL_PTHREAD
+    pthread_mutex_lock(&pool->lock);
+#else
+    // no lock means no extra threads, nothing to serialize
+    if (pool->lock)
+        DosRequestMutexSem(pool->lock, SEM_INDEFINITE_WAIT);
+#endif
+}
+
+static void WorkPoolUnlock(WORKPOOL *pool)
+{
+#ifdef WORKPOOL_PTHREAD
+    pthread_mutex_unlock(&pool->lock);
+#else
+    if (pool->lock)
+        DosReleaseMutexSem(pool->lock);
+#endif
+}
+
+/*
+ * WorkPoolThread( )
+ *
+ * take jobs until there are none left
+ */
+#ifdef WORKPOOL_PTHREAD
+static void *WorkPoolThread(void *arg)
+#else
+static void WorkPoolThread(void *arg)
+#endif
+{
+    WORKPOOL *pool = (WORKPOOL *)arg;
+    int index = 0;
+
+    for (;;)
+    {
+        WorkPoolLock(pool);
+        index = pool->next;
+        if (index < pool->count)
+            pool->next++;
+        WorkPoolUnlock(pool);
+
+        if (index >= pool->count)
+            break;
+
+        pool->work(pool->context, index);
+
+        if (pool->done)
+        {
+            WorkPoolLock(pool);
+            pool->done(pool->context, index);
+            WorkPoolUnlock(pool);
+        }
+    }
+
+#ifdef WORKPOOL_PTHREAD
+    return (NULL);
+#endif
+}
+
+/*************************************************************************
+ * Function:  WorkPoolRun( )
+ *
+ * 1 Set up the pool and its lock
+ * 2 Start threads - 1 extra threads, if a thread can not be started
+ *   the pool just runs with fewer threads
+ * 3 Calling thread works too
+ * 4 Wait for the extra threads
+ *
+ *************************************************************************/
+
+void WorkPoolRun(int threads, int count, WORKFUNC work, WORKFUNC done,
+                 void *context)
+{
+    WORKPOOL pool;
+    int started = 0;
+#ifndef WORKPOOL_PTHREAD
+    int havelock = 1;
+#endif
+#ifdef WORKPOOL_PTHREAD
+    pthread_t tids[WORKPOOL_MAX];
+#else
+    TID tids[WORKPOOL_MAX];
+#endif
+
+    pool.count = count;
+    pool.next = 0;
+    pool.work = work;
+    pool.done = done;
+    pool.context = context;
+
+    if (threads > count)
+        threads = count;
+    if (threads > WORKPOOL_MAX)
+        threads = WORKPOOL_MAX;
+
+#ifdef WORKPOOL_PTHREAD
+    pthread_mutex_init(&pool.lock, NULL);
+#else
+    if (DosCreateMutexSem(NULL, &pool.lock, 0, FALSE) != 0)
+    {
+        pool.lock = 0;
+        havelock = 0;
+        threads = 1;
+    }
+#endif
+
+    for (started = 0; started < threads - 1; started++)
+    {
+#ifdef WORKPOOL_PTHREAD
+        if (pthread_create(&tids[started], NULL, WorkPoolThread, &pool) != 0)
+            break;
+#else
+        int tid = _beginthread(WorkPoolThread, NULL, WORKPOOL_STACK, &pool);
+        if (tid == -1)
+            break;
+        tids[started] = (TID)tid;
+#endif
+    }
+
+    WorkPoolThread(&pool);
+
+    for (int x = 0; x < started; x++)
+    {
+#ifdef WORKPOOL_PTHREAD
+        pthread_join(tids[x], NULL);
+#else
+        DosWaitThread(&tids[x], DCWW_WAIT);
+#endif
+    }
+
+#ifdef WORKPOOL_PTHREAD
+    pthread_mutex_destroy(&pool.lock);
+#else
+    if (havelock)
+        DosCloseMutexSem(pool.lock);
+#endif
+}
@@ -0,0 +1,44 @@
+/****************************************************************************
+ *
+ *  workpool.h -- Make Message File Utilities
+ *
+ *  ========================================================================
+ *
+ *  Description: Minimal worker thread pool. Runs a numbered set of
+ *               independent jobs on N threads.
+ *
+ *  ========================================================================
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ ***************************************************************************/
+
+#ifndef WORKPOOL_H
+#define WORKPOOL_H
+
+// job callback, index is 0 .. count-1
+typedef void (*WORKFUNC)(void *context, int index);
+
+#define WORKPOOL_MAX 64    // max threads
+#define WORKPOOL_STACK 0x40000
+
+// Run work(context, 0 .. count-1) on up to threads threads (the calling
+// thread is one of them). done(context, index) is called after each
+// job with the pool lock held, so done callbacks never overlap; done
+// may be NULL. Returns when all jobs are finished.
+void WorkPoolRun(int threads, int count, WORKFUNC work, WORKFUNC done,
+                 void *context);
+
+#endif